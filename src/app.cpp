@@ -7,8 +7,14 @@
 #include "camera/flying_camera.hpp"
 #include "camera/following_camera.hpp"
 #include "controls.hpp"
+#include "gl_wrappers/texture.hpp"
+#include "gl_wrappers/texture_manager.hpp"
+#include "gl_wrappers/texture_streamer.hpp"
+#include "hot_reloader.hpp"
 #include "renderer.hpp"
+#include "scene/geometry_arena.hpp"
 #include "scene/scene.hpp"
+#include "utils/profiler.hpp"
 #include "utils/string_utils.hpp"
 
 #include "app.hpp"
@@ -77,6 +83,10 @@ bool App::createWindow(const std::string& windowTitle,
     return false;
   }
 
+  // Query supported texture formats, before textures get decoded in the
+  // background
+  Texture::isCompressionSupported();
+
   return true;
 }
 
@@ -90,21 +100,46 @@ GLFWwindow* App::getWindow() const {
 }
 
 void App::_updateWindowTitle(const std::string& baseTitle,
-                             const glm::vec3& cameraPos) {
+                             const glm::vec3& cameraPos,
+                             const RenderQueue::Statistics& renderStatistics,
+                             const FrustumCuller::Statistics&
+                                 cullingStatistics,
+                             const OcclusionCuller::Statistics&
+                                 occlusionStatistics,
+                             const ShaderProgram::UniformStatistics&
+                                 uniformStatistics,
+                             double gpuFrameMs) {
   // Camera position
   const auto cameraPosStr = string_utils::vecToString(cameraPos);
 
   // Set the window's title
   const auto newWindowTitle =
-      string_utils::formatString("{} | FPS: {} | Position: {} | Speed: {}",
-                                 baseTitle, _FPS, cameraPosStr, _movementSpeed);
+      string_utils::formatString(
+          "{} | FPS: {} (GPU: {} ms) | Position: {} | Speed: {} | Draws: {} "
+          "({} meshes, {} instances, state changes skipped: {}) | Culled: "
+          "{}/{} (occluded: {} in {} ms) | Uniforms: {} (skipped: {})",
+          baseTitle, _FPS, gpuFrameMs, cameraPosStr, _movementSpeed,
+          renderStatistics.drawCount, renderStatistics.meshCount,
+          renderStatistics.instanceCount,
+          renderStatistics.getSkippedCount(), cullingStatistics.culledCount,
+          cullingStatistics.culledCount + cullingStatistics.visibleCount,
+          occlusionStatistics.occludedCount,
+          occlusionStatistics.rasterizationTime +
+              occlusionStatistics.testTime,
+          uniformStatistics.uploads, uniformStatistics.uploadsSkipped);
   glfwSetWindowTitle(_window, newWindowTitle.c_str());
 }
 
 void App::run() {
+  // Start profiling the startup (from the main thread, which comes first in the
+  // report)
+  auto& profiler = Profiler::getInstance();
+  auto phaseStart = Profiler::Clock::now();
+
   // Open window
   const std::string baseWindowTitle = "Projet OpenGL Evan & Vincent";
   createWindow(baseWindowTitle.c_str(), 3, 3, false);
+  profiler.addPhase("app", "createWindow", phaseStart, Profiler::Clock::now());
 
   // Init
   setVerticalSync(true);
@@ -114,28 +149,59 @@ void App::run() {
   _lastFrameTime = _lastFrameTimeFPS = glfwGetTime();
 
   // Objects used during main loop
+  phaseStart = Profiler::Clock::now();
   Scene scene(true);
+  profiler.addPhase("app", "scene", phaseStart, Profiler::Clock::now());
+  TextureManager::getInstance().logStatistics();
   FlyingCamera flyingCamera(glm::vec3(8, 20, 10), glm::vec3(0, 20, -35),
                             glm::vec3(0, 1, 0));
   auto& cart = scene.objects.front();
   FollowingCamera followingCamera(cart, glm::vec3(0, 1, 0), glm::vec3(0),
                                   glm::vec3(0, 1, 0));
   Controls controls;
+  HotReloader hotReloader;
+  phaseStart = Profiler::Clock::now();
   Renderer renderer(*this, scene);
+  profiler.addPhase("app", "renderer", phaseStart, Profiler::Clock::now());
+  Profiler::GpuTimer frameTimer("app", "gpuFrame");
+  phaseStart = Profiler::Clock::now();
+  bool startupProfiled = false;
 
   while (glfwWindowShouldClose(_window) == 0) {
     // Get the right camera based from the controls
     Camera& camera = controls.getCurrentCamera(flyingCamera, followingCamera);
 
-    // Render
+    // Reload the assets whose files changed
+    hotReloader.update();
+
+    // Upload the textures decoded in the background (within the frame budget)
+    TextureStreamer::getInstance().update();
+
+    // Render (timing the GPU side)
+    frameTimer.begin();
     renderer.update(camera);
+    frameTimer.end();
+
+    // Startup is over once a frame is drawn with all the textures streamed in
+    if (!startupProfiled &&
+        TextureStreamer::getInstance().getPendingCount() == 0) {
+      profiler.addPhase("app", "firstFrames", phaseStart,
+                        Profiler::Clock::now());
+      profiler.writeReport("startup_profile.json");
+      startupProfiled = true;
+    }
 
     // Draw to screen + poll events
     glfwSwapBuffers(_window);
     glfwPollEvents();
 
     // Show information in window title
-    _updateWindowTitle(baseWindowTitle, camera.getPosition());
+    _updateWindowTitle(baseWindowTitle, camera.getPosition(),
+                       renderer.getRenderStatistics(),
+                       renderer.getCullingStatistics(),
+                       renderer.getOcclusionStatistics(),
+                       ShaderProgram::getUniformStatistics(),
+                       frameTimer.getLastMs());
 
     // Delta time, FPS and movement speed
     _updateDeltaTimeAndFPS();
@@ -163,6 +229,8 @@ void App::run() {
                            setCursorPosFunc);
   }
 
+  TextureStreamer::getInstance().clear();
+  GeometryArena::getInstance().clear();
   destroyWindow();
 }
 
@@ -10,6 +10,9 @@
 #include <glm/glm.hpp>
 
 #include "camera/camera.hpp"
+#include "frustum_culler.hpp"
+#include "occlusion_culler.hpp"
+#include "render_queue.hpp"
 
 class App {
  public:
@@ -156,9 +159,23 @@ class App {
    * @param baseTitle Start of the window title
    * @param cameraPos Positon of the camera
    * @param separator Separator between informations
-   */
-  void _updateWindowTitle(const std::string& baseTitle,
-                          const glm::vec3& cameraPos);
+   * @param renderStatistics Statistics of the draws of the last frame
+   * @param cullingStatistics Statistics of the frustum culling of the last
+   * frame
+   * @param occlusionStatistics Statistics of the occlusion culling of the
+   * last frame
+   * @param uniformStatistics Statistics of the uniform uploads of the last
+   * frame
+   * @param gpuFrameMs GPU time of the last timed frame, in milliseconds
+   */
+  void _updateWindowTitle(
+      const std::string& baseTitle,
+      const glm::vec3& cameraPos,
+      const RenderQueue::Statistics& renderStatistics,
+      const FrustumCuller::Statistics& cullingStatistics,
+      const OcclusionCuller::Statistics& occlusionStatistics,
+      const ShaderProgram::UniformStatistics& uniformStatistics,
+      double gpuFrameMs);
 
   /**
    * Recalculates the app's projection matrix
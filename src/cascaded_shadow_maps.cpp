@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "cascaded_shadow_maps.hpp"
+
+CascadedShadowMaps::CascadedShadowMaps(const Settings& settings) {
+  setSettings(settings);
+}
+
+void CascadedShadowMaps::setSettings(const Settings& settings) {
+  if (settings.resolution <= 0 || settings.cascadeCount == 0 ||
+      settings.cascadeCount > MAX_CASCADES || settings.maxDistance <= 0.0f ||
+      settings.splitLambda < 0.0f || settings.splitLambda > 1.0f) {
+    throw std::runtime_error("Invalid cascaded shadow maps settings");
+  }
+  _settings = settings;
+}
+
+const CascadedShadowMaps::Settings& CascadedShadowMaps::getSettings() const {
+  return _settings;
+}
+
+void CascadedShadowMaps::fit(const glm::mat4& cameraViewMatrix,
+                             const glm::mat4& cameraProjectionMatrix,
+                             const glm::vec3& lightDirection) {
+  // Near and far planes of the camera (from a glm::perspective matrix)
+  const auto& projection = cameraProjectionMatrix;
+  const float near = projection[3][2] / (projection[2][2] - 1.0f);
+  const float far = projection[3][2] / (projection[2][2] + 1.0f);
+  const auto splitDistances = computeSplitDistances(
+      near, std::min(far, _settings.maxDistance), _settings.cascadeCount,
+      _settings.splitLambda);
+
+  // Corners of the near plane in view space, whose rays scale to any depth
+  const auto inverseProjection = glm::inverse(cameraProjectionMatrix);
+  glm::vec3 nearCorners[4];
+  for (int i = 0; i < 4; i++) {
+    const auto corner = inverseProjection * glm::vec4(i & 1 ? 1.0f : -1.0f,
+                                                      i & 2 ? 1.0f : -1.0f,
+                                                      -1.0f, 1.0f);
+    nearCorners[i] = glm::vec3(corner) / corner.w;
+  }
+
+  // Light space (the light looking toward negative z)
+  const auto inverseView = glm::inverse(cameraViewMatrix);
+  const auto direction = glm::normalize(lightDirection);
+  const auto up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f)
+                                                : glm::vec3(0.0f, 1.0f, 0.0f);
+  const auto lightViewMatrix = glm::lookAt(glm::vec3(0.0f), direction, up);
+
+  _cascades.resize(_settings.cascadeCount);
+  _bounds.resize(_settings.cascadeCount);
+  _depthRanges.resize(_settings.cascadeCount);
+  for (size_t i = 0; i < _settings.cascadeCount; i++) {
+    // Bounding sphere of the slice, in world coordinates
+    const float sliceNear = i == 0 ? near : splitDistances[i - 1];
+    const float sliceFar = splitDistances[i];
+    glm::vec3 corners[8];
+    glm::vec3 center(0.0f);
+    for (int c = 0; c < 8; c++) {
+      const auto depth = c < 4 ? sliceNear : sliceFar;
+      corners[c] = glm::vec3(
+          inverseView * glm::vec4(nearCorners[c % 4] * (depth / near), 1.0f));
+      center += corners[c] / 8.0f;
+    }
+    float radius = 0.0f;
+    for (const auto& corner : corners) {
+      radius = std::max(radius, glm::distance(center, corner));
+    }
+    radius = std::ceil(radius / RADIUS_GRANULARITY) * RADIUS_GRANULARITY;
+
+    // Move the projection by whole texels
+    auto lightSpaceCenter =
+        glm::vec3(lightViewMatrix * glm::vec4(center, 1.0f));
+    const float texelSize = 2.0f * radius / _settings.resolution;
+    lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+    lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+
+    _bounds[i] = glm::vec4(
+        lightSpaceCenter.x - radius, lightSpaceCenter.x + radius,
+        lightSpaceCenter.y - radius, lightSpaceCenter.y + radius);
+    _depthRanges[i] = glm::vec2(-lightSpaceCenter.z - radius,
+                                -lightSpaceCenter.z + radius);
+    auto& cascade = _cascades[i];
+    cascade.viewMatrix = lightViewMatrix;
+    cascade.projectionMatrix =
+        glm::ortho(_bounds[i].x, _bounds[i].y, _bounds[i].z, _bounds[i].w,
+                   _depthRanges[i].x, _depthRanges[i].y);
+    cascade.splitDistance = sliceFar;
+  }
+}
+
+Frustum CascadedShadowMaps::getCasterFrustum(size_t cascadeIndex) const {
+  const auto& cascade = _cascades[cascadeIndex];
+  auto frustum =
+      Frustum::fromMatrix(cascade.projectionMatrix * cascade.viewMatrix);
+  frustum.planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);  // Always inside
+  return frustum;
+}
+
+void CascadedShadowMaps::includeCasters(size_t cascadeIndex, float casterMaxZ) {
+  auto& depthRange = _depthRanges[cascadeIndex];
+  if (-casterMaxZ >= depthRange.x) {
+    return;
+  }
+
+  depthRange.x = -casterMaxZ;
+  const auto& bounds = _bounds[cascadeIndex];
+  _cascades[cascadeIndex].projectionMatrix = glm::ortho(
+      bounds.x, bounds.y, bounds.z, bounds.w, depthRange.x, depthRange.y);
+}
+
+const std::vector<CascadedShadowMaps::Cascade>&
+CascadedShadowMaps::getCascades() const {
+  return _cascades;
+}
+
+std::vector<float> CascadedShadowMaps::computeSplitDistances(
+    float near,
+    float far,
+    size_t cascadeCount,
+    float lambda) {
+  std::vector<float> splitDistances(cascadeCount);
+  for (size_t i = 1; i <= cascadeCount; i++) {
+    const float ratio = static_cast<float>(i) / cascadeCount;
+    const float logarithmic = near * std::pow(far / near, ratio);
+    const float uniform = near + (far - near) * ratio;
+    splitDistances[i - 1] = lambda * logarithmic + (1.0f - lambda) * uniform;
+  }
+  return splitDistances;
+}
@@ -0,0 +1,121 @@
+#ifndef CASCADED_SHADOW_MAPS_HPP
+#define CASCADED_SHADOW_MAPS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "frustum_culler.hpp"
+
+/**
+ * Fits the cascades of a directional light's shadow map to the camera: the
+ * view frustum (up to a maximal distance) is split into slices, near ones
+ * being shorter (practical split scheme, blending logarithmic and uniform
+ * splits), and each slice gets an orthographic projection from the light.
+ *
+ * Projections are fitted to the bounding sphere of their slice, whose size
+ * doesn't change as the camera turns, and moved by whole texels only, so that
+ * shadow edges don't shimmer as the camera moves.
+ */
+class CascadedShadowMaps {
+ public:
+  /**
+   * Settings trading the quality of the shadows for frame time.
+   */
+  struct Settings {
+    int resolution = 2048;       // Of each cascade's shadow map, in texels
+    size_t cascadeCount = 4;     // Number of slices (up to MAX_CASCADES)
+    float maxDistance = 250.0f;  // From the camera, where shadows end
+    float splitLambda = 0.75f;   // Blend of the logarithmic (1) and uniform
+                                 // (0) split schemes
+  };
+
+  /**
+   * Shadow map projection of a slice of the view frustum.
+   */
+  struct Cascade {
+    glm::mat4 viewMatrix;        // From world to light space
+    glm::mat4 projectionMatrix;  // Orthographic, from light space
+    float splitDistance = 0.0f;  // Distance (view depth) the slice ends at
+  };
+
+  CascadedShadowMaps() = default;
+
+  /**
+   * Creates the cascades with the given settings.
+   * Throws std::runtime_error if the settings are invalid.
+   */
+  explicit CascadedShadowMaps(const Settings& settings);
+
+  /**
+   * Changes the settings of the cascades.
+   * Throws std::runtime_error if the settings are invalid.
+   */
+  void setSettings(const Settings& settings);
+
+  /**
+   * Gets the settings of the cascades.
+   */
+  const Settings& getSettings() const;
+
+  /**
+   * Fits the cascades of a light to the view frustum of the camera. The depth
+   * range of the projections only covers the slices, see includeCasters().
+   * @param cameraViewMatrix        View matrix of the camera
+   * @param cameraProjectionMatrix  Perspective projection of the camera
+   * @param lightDirection          Direction the light shines toward
+   */
+  void fit(const glm::mat4& cameraViewMatrix,
+           const glm::mat4& cameraProjectionMatrix,
+           const glm::vec3& lightDirection);
+
+  /**
+   * Gets the frustum a cascade's shadow casters are in: its projection's,
+   * without near plane (casters between the light and the slice cast shadows
+   * on it).
+   */
+  Frustum getCasterFrustum(size_t cascadeIndex) const;
+
+  /**
+   * Extends the depth range of a cascade's projection toward the light, so
+   * that it includes casters.
+   * @param cascadeIndex  Index of the cascade
+   * @param casterMaxZ    Largest z of the casters, in light space (the light
+   * looking toward negative z)
+   */
+  void includeCasters(size_t cascadeIndex, float casterMaxZ);
+
+  /**
+   * Gets the cascades fitted last, nearest first.
+   */
+  const std::vector<Cascade>& getCascades() const;
+
+  /**
+   * Computes the distances (view depths) the slices of the practical split
+   * scheme end at.
+   * @param near          Near plane of the camera
+   * @param far           Distance the last slice ends at
+   * @param cascadeCount  Number of slices
+   * @param lambda        Blend of the logarithmic (1) and uniform (0) schemes
+   */
+  static std::vector<float> computeSplitDistances(float near,
+                                                  float far,
+                                                  size_t cascadeCount,
+                                                  float lambda);
+
+  // Maximal number of cascades (same as in shaders)
+  static constexpr size_t MAX_CASCADES = 8;
+  // Granularity the slices' bounding sphere radii are rounded up to, so that
+  // rounding errors don't resize the projections
+  static constexpr float RADIUS_GRANULARITY = 1.0f / 16.0f;
+
+ private:
+  Settings _settings;                   // Current settings
+  std::vector<Cascade> _cascades;       // Fitted last, nearest first
+  std::vector<glm::vec4> _bounds;       // Left, right, bottom and top of each
+                                        // projection
+  std::vector<glm::vec2> _depthRanges;  // Near and far of each projection
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "frustum_culler.hpp"
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjectionMatrix) {
+  // Rows of the matrix (glm matrices are column major)
+  const auto row = [&viewProjectionMatrix](int i) {
+    return glm::vec4(viewProjectionMatrix[0][i], viewProjectionMatrix[1][i],
+                     viewProjectionMatrix[2][i], viewProjectionMatrix[3][i]);
+  };
+
+  // A point is inside when -w <= x, y, z <= w in clip space
+  Frustum frustum;
+  frustum.planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                    row(3) - row(1), row(3) + row(2), row(3) - row(2)};
+  for (auto& plane : frustum.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return frustum;
+}
+
+void FrustumCuller::clear() {
+  _centersX.clear();
+  _centersY.clear();
+  _centersZ.clear();
+  _extentsX.clear();
+  _extentsY.clear();
+  _extentsZ.clear();
+}
+
+void FrustumCuller::addBox(const glm::vec3& aabbMin, const glm::vec3& aabbMax) {
+  const auto center = (aabbMin + aabbMax) * 0.5f;
+  const auto extents = (aabbMax - aabbMin) * 0.5f;
+  _centersX.push_back(center.x);
+  _centersY.push_back(center.y);
+  _centersZ.push_back(center.z);
+  _extentsX.push_back(extents.x);
+  _extentsY.push_back(extents.y);
+  _extentsZ.push_back(extents.z);
+}
+
+void FrustumCuller::cull(const Frustum& frustum,
+                         std::vector<uint8_t>& visibilities) {
+  const auto boxCount = _centersX.size();
+  visibilities.resize(boxCount);
+
+  // A box is outside when it's entirely behind a plane: the distance of its
+  // center is below the projection of its extents on the plane's normal
+  size_t i = 0;
+#if defined(__AVX__)
+  constexpr size_t LANE_COUNT = 8;
+  const auto zero = _mm256_setzero_ps();
+  for (; i + LANE_COUNT <= boxCount; i += LANE_COUNT) {
+    const auto centerX = _mm256_loadu_ps(&_centersX[i]);
+    const auto centerY = _mm256_loadu_ps(&_centersY[i]);
+    const auto centerZ = _mm256_loadu_ps(&_centersZ[i]);
+    const auto extentX = _mm256_loadu_ps(&_extentsX[i]);
+    const auto extentY = _mm256_loadu_ps(&_extentsY[i]);
+    const auto extentZ = _mm256_loadu_ps(&_extentsZ[i]);
+    auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const auto& plane : frustum.planes) {
+      const auto distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), centerX),
+                        _mm256_mul_ps(_mm256_set1_ps(plane.y), centerY)),
+          _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), centerZ),
+                        _mm256_set1_ps(plane.w)));
+      const auto radius = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.x)), extentX),
+              _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.y)), extentY)),
+          _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.z)), extentZ));
+      inside = _mm256_and_ps(
+          inside,
+          _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+    }
+    const int mask = _mm256_movemask_ps(inside);
+    for (size_t lane = 0; lane < LANE_COUNT; lane++) {
+      visibilities[i + lane] = (mask >> lane) & 1;
+    }
+  }
+#elif defined(__SSE2__)
+  constexpr size_t LANE_COUNT = 4;
+  const auto zero = _mm_setzero_ps();
+  for (; i + LANE_COUNT <= boxCount; i += LANE_COUNT) {
+    const auto centerX = _mm_loadu_ps(&_centersX[i]);
+    const auto centerY = _mm_loadu_ps(&_centersY[i]);
+    const auto centerZ = _mm_loadu_ps(&_centersZ[i]);
+    const auto extentX = _mm_loadu_ps(&_extentsX[i]);
+    const auto extentY = _mm_loadu_ps(&_extentsY[i]);
+    const auto extentZ = _mm_loadu_ps(&_extentsZ[i]);
+    auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (const auto& plane : frustum.planes) {
+      const auto distance =
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), centerX),
+                                _mm_mul_ps(_mm_set1_ps(plane.y), centerY)),
+                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), centerZ),
+                                _mm_set1_ps(plane.w)));
+      const auto radius = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(plane.x)), extentX),
+                     _mm_mul_ps(_mm_set1_ps(std::fabs(plane.y)), extentY)),
+          _mm_mul_ps(_mm_set1_ps(std::fabs(plane.z)), extentZ));
+      inside = _mm_and_ps(inside,
+                          _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+    }
+    const int mask = _mm_movemask_ps(inside);
+    for (size_t lane = 0; lane < LANE_COUNT; lane++) {
+      visibilities[i + lane] = (mask >> lane) & 1;
+    }
+  }
+#endif
+
+  // Remaining boxes (all of them without SIMD)
+  for (; i < boxCount; i++) {
+    bool isInside = true;
+    for (const auto& plane : frustum.planes) {
+      const float distance = plane.x * _centersX[i] + plane.y * _centersY[i] +
+                             plane.z * _centersZ[i] + plane.w;
+      const float radius = std::fabs(plane.x) * _extentsX[i] +
+                           std::fabs(plane.y) * _extentsY[i] +
+                           std::fabs(plane.z) * _extentsZ[i];
+      isInside = isInside && distance + radius >= 0.0f;
+    }
+    visibilities[i] = isInside;
+  }
+
+  _statistics.visibleCount = 0;
+  for (const auto visibility : visibilities) {
+    _statistics.visibleCount += visibility;
+  }
+  _statistics.culledCount = boxCount - _statistics.visibleCount;
+}
+
+const FrustumCuller::Statistics& FrustumCuller::getStatistics() const {
+  return _statistics;
+}
@@ -0,0 +1,75 @@
+#ifndef FRUSTUM_CULLER_HPP
+#define FRUSTUM_CULLER_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * Planes of a view frustum.
+ */
+struct Frustum {
+  // Planes (normal pointing inside, and distance to the origin): left, right,
+  // bottom, top, near, far
+  std::array<glm::vec4, 6> planes;
+
+  /**
+   * Extracts the planes of the frustum of a view-projection matrix.
+   * @param viewProjectionMatrix Projection matrix times view matrix
+   */
+  static Frustum fromMatrix(const glm::mat4& viewProjectionMatrix);
+};
+
+/**
+ * Tests bounding boxes against a frustum, several at a time with SIMD (8 with
+ * AVX, 4 with SSE). Boxes are stored as centers and extents in a structure of
+ * arrays, so that each register holds one coordinate of several boxes.
+ */
+class FrustumCuller {
+ public:
+  /**
+   * Counts of the boxes tested by the last cull.
+   */
+  struct Statistics {
+    size_t visibleCount = 0;
+    size_t culledCount = 0;
+  };
+
+  /**
+   * Removes all the boxes (keeping their storage).
+   */
+  void clear();
+
+  /**
+   * Adds an axis-aligned bounding box to test.
+   * @param aabbMin  Minimal corner of the box
+   * @param aabbMax  Maximal corner of the box
+   */
+  void addBox(const glm::vec3& aabbMin, const glm::vec3& aabbMax);
+
+  /**
+   * Tests all the boxes against a frustum.
+   * @param frustum       Frustum to test against
+   * @param visibilities  Set to 1 for each box intersecting the frustum, 0
+   * otherwise (in the order boxes were added)
+   */
+  void cull(const Frustum& frustum, std::vector<uint8_t>& visibilities);
+
+  /**
+   * Gets the statistics of the last cull.
+   */
+  const Statistics& getStatistics() const;
+
+ private:
+  std::vector<float> _centersX;  // Coordinates of the centers of the boxes
+  std::vector<float> _centersY;
+  std::vector<float> _centersZ;
+  std::vector<float> _extentsX;  // Half sizes of the boxes
+  std::vector<float> _extentsY;
+  std::vector<float> _extentsZ;
+  Statistics _statistics;  // Statistics of the last cull
+};
+
+#endif
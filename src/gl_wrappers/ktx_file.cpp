@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "ktx_file.hpp"
+
+constexpr uint8_t KtxFile::IDENTIFIER[12];
+
+// Rows are stored bottom first, as decoded for OpenGL
+static const char ORIENTATION_KEY[] = "KTXorientation";
+static const char ORIENTATION_VALUE[] = "S=r,T=u";
+
+static uint32_t alignTo4(uint32_t size) {
+  return (size + 3) / 4 * 4;
+}
+
+bool KtxFile::open(const std::string& filePath) {
+  close();
+
+  if (!_file.open(filePath)) {
+    return false;
+  }
+
+  const auto data = _file.getData();
+  const auto size = _file.getSize();
+
+  // Check header (only compressed 2D textures are supported)
+  if (size < sizeof(Header)) {
+    close();
+    return false;
+  }
+  Header header;
+  memcpy(&header, data, sizeof(Header));
+  if (memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0 ||
+      header.endianness != ENDIANNESS || header.glType != 0 ||
+      header.pixelDepth != 0 || header.numberOfArrayElements != 0 ||
+      header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0) {
+    std::cerr << "Unsupported KTX file: " << filePath << "\n";
+    close();
+    return false;
+  }
+  _internalFormat = header.glInternalFormat;
+
+  // Read levels (each one prefixed with its size)
+  uint64_t offset = uint64_t(sizeof(Header)) + header.bytesOfKeyValueData;
+  GLsizei width = header.pixelWidth;
+  GLsizei height = header.pixelHeight;
+  for (uint32_t i = 0; i < header.numberOfMipmapLevels; i++) {
+    uint32_t levelSize;
+    if (offset + sizeof(levelSize) > size) {
+      std::cerr << "KTX file is corrupted: " << filePath << "\n";
+      close();
+      return false;
+    }
+    memcpy(&levelSize, data + offset, sizeof(levelSize));
+    offset += sizeof(levelSize);
+    if (offset + levelSize > size) {
+      std::cerr << "KTX file is corrupted: " << filePath << "\n";
+      close();
+      return false;
+    }
+
+    _levels.push_back({width, height, data + offset, levelSize});
+    offset += alignTo4(levelSize);
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+  }
+
+  return true;
+}
+
+void KtxFile::close() {
+  _levels.clear();
+  _internalFormat = 0;
+  _file.close();
+}
+
+GLenum KtxFile::getInternalFormat() const {
+  return _internalFormat;
+}
+
+const std::vector<KtxFile::Level>& KtxFile::getLevels() const {
+  return _levels;
+}
+
+bool KtxFile::write(const std::string& filePath,
+                    GLenum internalFormat,
+                    GLenum baseFormat,
+                    const std::vector<Level>& levels) {
+  if (levels.empty()) {
+    return false;
+  }
+
+  // Orientation key/value pair (size, key and value, padded to 4 bytes)
+  const uint32_t keyValueSize =
+      sizeof(ORIENTATION_KEY) + sizeof(ORIENTATION_VALUE);
+  const uint32_t keyValueDataSize =
+      sizeof(keyValueSize) + alignTo4(keyValueSize);
+
+  Header header;
+  memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+  header.endianness = ENDIANNESS;
+  header.glType = 0;  // Compressed
+  header.glTypeSize = 1;
+  header.glFormat = 0;  // Compressed
+  header.glInternalFormat = internalFormat;
+  header.glBaseInternalFormat = baseFormat;
+  header.pixelWidth = levels.front().width;
+  header.pixelHeight = levels.front().height;
+  header.pixelDepth = 0;
+  header.numberOfArrayElements = 0;
+  header.numberOfFaces = 1;
+  header.numberOfMipmapLevels = static_cast<uint32_t>(levels.size());
+  header.bytesOfKeyValueData = keyValueDataSize;
+
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file.good()) {
+    std::cerr << "Unable to write KTX file: " << filePath << "\n";
+    return false;
+  }
+
+  const char padding[4] = {};
+  file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char*>(&keyValueSize),
+             sizeof(keyValueSize));
+  file.write(ORIENTATION_KEY, sizeof(ORIENTATION_KEY));
+  file.write(ORIENTATION_VALUE, sizeof(ORIENTATION_VALUE));
+  file.write(padding, alignTo4(keyValueSize) - keyValueSize);
+  for (const auto& level : levels) {
+    const auto levelSize = static_cast<uint32_t>(level.size);
+    file.write(reinterpret_cast<const char*>(&levelSize), sizeof(levelSize));
+    file.write(reinterpret_cast<const char*>(level.data), levelSize);
+    file.write(padding, alignTo4(levelSize) - levelSize);
+  }
+  file.close();
+
+  if (!file.good()) {
+    std::cerr << "Unable to write KTX file: " << filePath << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+std::string KtxFile::getCompressedFilePath(const std::string& imageFilePath) {
+  return imageFilePath + ".ktx";
+}
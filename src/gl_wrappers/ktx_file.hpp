@@ -0,0 +1,112 @@
+#ifndef KTX_FILE_HPP
+#define KTX_FILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "../utils/mapped_file.hpp"
+
+// S3TC formats (GL_EXT_texture_compression_s3tc, not part of the core profile)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+/**
+ * KTX (version 1) file holding a block-compressed 2D texture with its mip
+ * chain, as written by the texture baker. The file is memory-mapped, so that
+ * loading it is a single read and its levels can be uploaded straight away.
+ *
+ * Levels are stored bottom row first (as OpenGL expects them), which is
+ * recorded with the KTXorientation key.
+ */
+class KtxFile {
+ public:
+  /**
+   * Mip level of the texture.
+   * When read from a file, data points to the memory-mapped file and is only
+   * valid while the file is open.
+   */
+  struct Level {
+    GLsizei width;
+    GLsizei height;
+    const unsigned char* data;
+    size_t size;
+  };
+
+  /**
+   * Opens a KTX file, if it holds a compressed 2D texture.
+   * @param filePath Path to the KTX file
+   * @return True if the file has been opened, false if it's missing or
+   * unsupported
+   */
+  bool open(const std::string& filePath);
+
+  /**
+   * Closes the file (invalidating all the levels it handed out).
+   */
+  void close();
+
+  /**
+   * Gets the compressed format of the texture (e.g.
+   * GL_COMPRESSED_RGB_S3TC_DXT1_EXT).
+   */
+  GLenum getInternalFormat() const;
+
+  /**
+   * Gets the mip levels of the texture, from the biggest to the smallest.
+   */
+  const std::vector<Level>& getLevels() const;
+
+  /**
+   * Writes a KTX file holding a compressed 2D texture.
+   * @param filePath        Path to the KTX file
+   * @param internalFormat  Compressed format of the texture
+   * @param baseFormat      Base format of the texture (GL_RGB or GL_RGBA)
+   * @param levels          Mip levels, from the biggest to the smallest
+   * @return True if the file has been written, false otherwise
+   */
+  static bool write(const std::string& filePath,
+                    GLenum internalFormat,
+                    GLenum baseFormat,
+                    const std::vector<Level>& levels);
+
+  /**
+   * Gets path of the baked (compressed) version of an image file.
+   */
+  static std::string getCompressedFilePath(const std::string& imageFilePath);
+
+ private:
+  MappedFile _file;
+  GLenum _internalFormat = 0;
+  std::vector<Level> _levels;
+
+  struct Header {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+  };
+
+  static constexpr uint8_t IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58,
+                                             0x20, 0x31, 0x31, 0xBB,
+                                             0x0D, 0x0A, 0x1A, 0x0A};
+  static constexpr uint32_t ENDIANNESS = 0x04030201;
+};
+
+#endif
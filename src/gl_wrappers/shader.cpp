@@ -1,10 +1,20 @@
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
+#include "../utils/profiler.hpp"
 #include "../utils/string_utils.hpp"
 #include "shader.hpp"
 
+/**
+ * Gets the normalized form of a path, to compare paths to the same file.
+ */
+static std::string normalizePath(const std::string& filePath) {
+  return std::filesystem::path(filePath).lexically_normal().generic_string();
+}
+
 Shader::~Shader() {
   deleteShader();
 }
@@ -12,6 +22,8 @@ Shader::~Shader() {
 bool Shader::loadShaderFromFile(const std::string& fileName,
                                 GLenum shaderType) {
   std::cout << "Loading shader: " << fileName << "\n";
+  Profiler::ScopedPhase phase(Profiler::getAssetName("shader", fileName),
+                              "compile");
 
   std::vector<std::string> fileLines;
   std::set<std::string> filesIncludedAlready;
@@ -54,9 +66,39 @@ bool Shader::loadShaderFromFile(const std::string& fileName,
 
   _shaderType = shaderType;
   _isCompiled = true;
+  _fileName = fileName;
+  _dependencies.clear();
+  _dependencies.insert(normalizePath(fileName));
+  for (const auto& includedFileName : filesIncludedAlready) {
+    _dependencies.insert(normalizePath(includedFileName));
+  }
+  return true;
+}
+
+bool Shader::reload() {
+  if (!_isCompiled) {
+    return false;
+  }
+
+  // Compile the new version aside, then take its place
+  Shader reloadedShader;
+  if (!reloadedShader.loadShaderFromFile(_fileName, _shaderType)) {
+    return false;
+  }
+
+  deleteShader();
+  _shaderID = reloadedShader._shaderID;
+  _isCompiled = true;
+  _dependencies = std::move(reloadedShader._dependencies);
+  reloadedShader._shaderID = 0;
+  reloadedShader._isCompiled = false;
   return true;
 }
 
+bool Shader::dependsOnFile(const std::string& filePath) const {
+  return _dependencies.count(normalizePath(filePath)) > 0;
+}
+
 bool Shader::isCompiled() const {
   return _isCompiled;
 }
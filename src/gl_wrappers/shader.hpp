@@ -19,10 +19,8 @@
 class ShaderConstants {
  public:
   // Matrices
-  DEFINE_SHADER_CONSTANT(modelMatrix, "matrices.model");
   DEFINE_SHADER_CONSTANT(projectionMatrix, "matrices.projection");
   DEFINE_SHADER_CONSTANT(viewMatrix, "matrices.view");
-  DEFINE_SHADER_CONSTANT(normalMatrix, "matrices.normal");
 
   // Color and textures
   DEFINE_SHADER_CONSTANT(color, "color");
@@ -62,6 +60,20 @@ class Shader {
    */
   bool loadShaderFromFile(const std::string& fileName, GLenum shaderType);
 
+  /**
+   * Loads and compiles the shader again from its files (e.g. after they
+   * changed). The shader is kept as is if the new version doesn't compile.
+   * @return True if the shader has been successfully reloaded, false otherwise
+   */
+  bool reload();
+
+  /**
+   * Checks if the shader is compiled from the given file (its own file or an
+   * included one).
+   * @param filePath Path to the file
+   */
+  bool dependsOnFile(const std::string& filePath) const;
+
   /**
    * Checks if shader has been loaded and compiled successfully.
    * @return True if the shader has been successfully loaded and compiled,
@@ -100,6 +112,10 @@ class Shader {
 
   GLuint _shaderID = 0;      // OpenGL-assigned shader ID
   GLenum _shaderType = 0;    // Type of shader
+  std::string _fileName;     // Path to the shader file
+  std::set<std::string>
+      _dependencies;  // Normalized paths to the shader file and the files it
+                      // includes
   bool _isCompiled = false;  // Flag telling, whether shader has been loaded
                              // and compiled successfully
 };
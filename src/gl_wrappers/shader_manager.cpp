@@ -1,3 +1,4 @@
+#include <iostream>
 #include <stdexcept>
 
 #include "shader_manager.hpp"
@@ -96,6 +97,29 @@ const Shader& ShaderManager::getGeometryShader(const std::string& key) const {
   return *_geometryShaderCache.at(key);
 }
 
+std::vector<const Shader*> ShaderManager::reloadShaders(
+    const std::string& filePath) {
+  std::vector<const Shader*> reloadedShaders;
+  for (const auto shaderCache :
+       {&_vertexShaderCache, &_fragmentShaderCache, &_geometryShaderCache}) {
+    for (const auto& keyShader : *shaderCache) {
+      auto& shader = *keyShader.second;
+      if (!shader.dependsOnFile(filePath)) {
+        continue;
+      }
+
+      if (shader.reload()) {
+        reloadedShaders.push_back(&shader);
+      } else {
+        std::cerr << "Keeping the previous version of shader '"
+                  << keyShader.first << "'\n";
+      }
+    }
+  }
+
+  return reloadedShaders;
+}
+
 void ShaderManager::clearShaderCache() {
   _vertexShaderCache.clear();
   _fragmentShaderCache.clear();
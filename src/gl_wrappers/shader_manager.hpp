@@ -4,6 +4,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -108,6 +109,17 @@ class ShaderManager {
    */
   bool containsGeometryShader(const std::string& key) const;
 
+  /**
+   * Reloads the shaders compiled from the given file (their own file or an
+   * included one), e.g. after it changed. Shaders that don't compile anymore
+   * are kept as they were.
+   *
+   * @param filePath  Path to the changed file
+   *
+   * @return The successfully reloaded shaders.
+   */
+  std::vector<const Shader*> reloadShaders(const std::string& filePath);
+
   /**
    * Deletes all the loaded shaders from OpenGL and clears the shaders cache.
    */
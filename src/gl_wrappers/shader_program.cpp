@@ -1,7 +1,32 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include "shader_program.hpp"
 
+/**
+ * Prints why a program couldn't be linked.
+ */
+static void logLinkError(GLuint shaderProgramID) {
+  std::cerr << "Unable to link shader program. ";
+
+  // Get length of the error log first
+  GLint logLength;
+  glGetProgramiv(shaderProgramID, GL_INFO_LOG_LENGTH, &logLength);
+
+  // If there is some log, then retrieve it and output extra information
+  if (logLength > 0) {
+    GLchar* logMessage = new GLchar[logLength];
+    glGetProgramInfoLog(shaderProgramID, logLength, nullptr, logMessage);
+    std::cerr << "The linker returned: \n" << logMessage;
+    delete[] logMessage;
+  }
+
+  std::cerr << "\n";
+}
+
+ShaderProgram::UniformStatistics ShaderProgram::_uniformStatistics;
+
 ShaderProgram::~ShaderProgram() {
   deleteProgram();
 }
@@ -10,11 +35,12 @@ void ShaderProgram::createProgram() {
   _shaderProgramID = glCreateProgram();
 }
 
-bool ShaderProgram::addShaderToProgram(const Shader& shader) const {
+bool ShaderProgram::addShaderToProgram(const Shader& shader) {
   if (!shader.isCompiled())
     return false;
 
   glAttachShader(_shaderProgramID, shader.getShaderID());
+  _shaders.push_back(&shader);
   return true;
 }
 
@@ -30,27 +56,50 @@ bool ShaderProgram::linkProgram() {
   _isLinked = linkStatus == GL_TRUE;
 
   if (!_isLinked) {
-    std::cerr << "Unable to link shader program. ";
-
-    // Get length of the error log first
-    GLint logLength;
-    glGetProgramiv(_shaderProgramID, GL_INFO_LOG_LENGTH, &logLength);
-
-    // If there is some log, then retrieve it and output extra information
-    if (logLength > 0) {
-      GLchar* logMessage = new GLchar[logLength];
-      glGetProgramInfoLog(_shaderProgramID, logLength, nullptr, logMessage);
-      std::cerr << "The linker returned: \n" << logMessage;
-      delete[] logMessage;
-    }
-
-    std::cerr << "\n";
+    logLinkError(_shaderProgramID);
     return false;
   }
 
+  _resolveUniformShadowSlots();
+  _resolveUniformHandles();
   return _isLinked;
 }
 
+bool ShaderProgram::relinkProgram() {
+  // Link the current version of the shaders aside
+  const auto shaderProgramID = glCreateProgram();
+  for (const auto shader : _shaders) {
+    glAttachShader(shaderProgramID, shader->getShaderID());
+  }
+  glLinkProgram(shaderProgramID);
+  GLint linkStatus;
+  glGetProgramiv(shaderProgramID, GL_LINK_STATUS, &linkStatus);
+  if (linkStatus != GL_TRUE) {
+    logLinkError(shaderProgramID);
+    glDeleteProgram(shaderProgramID);
+    return false;
+  }
+
+  // Take its place, the uniform locations may have changed
+  deleteProgram();
+  _shaderProgramID = shaderProgramID;
+  _isLinked = true;
+  _uniforms.clear();
+  _resolveUniformShadowSlots();
+  _resolveUniformHandles();
+  for (const auto& blockBinding : _uniformBlockBindings) {
+    bindUniformBlockToBindingPoint(blockBinding.first, blockBinding.second);
+  }
+
+  std::cout << "Relinked shader program (ID: " << _shaderProgramID << ")\n";
+  return true;
+}
+
+bool ShaderProgram::hasShader(const Shader& shader) const {
+  return std::find(_shaders.begin(), _shaders.end(), &shader) !=
+         _shaders.end();
+}
+
 void ShaderProgram::useProgram() const {
   if (_isLinked) {
     glUseProgram(_shaderProgramID);
@@ -65,6 +114,14 @@ void ShaderProgram::deleteProgram() {
   std::cout << "Deleting shader program (ID: " << _shaderProgramID << ")\n";
   glDeleteProgram(_shaderProgramID);
   _isLinked = false;
+
+  // Its uniforms are gone with it
+  _uniforms.clear();
+  _uniformShadowSlots.clear();
+  _uniformSlotSpans.clear();
+  _uniformShadows.clear();
+  std::fill(_uniformHandleSlots.begin(), _uniformHandleSlots.end(),
+            NO_SHADOW_SLOT);
 }
 
 GLuint ShaderProgram::getShaderProgramID() const {
@@ -79,15 +136,6 @@ Uniform& ShaderProgram::operator[](const std::string& varName) {
   return _uniforms[varName];
 }
 
-// Model and normal matrix setting is pretty common, that's why this convenience
-// function
-
-void ShaderProgram::setModelAndNormalMatrix(const glm::mat4& modelMatrix) {
-  (*this)[ShaderConstants::modelMatrix()] = modelMatrix;
-  (*this)[ShaderConstants::normalMatrix()] =
-      glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
-}
-
 GLuint ShaderProgram::getUniformBlockIndex(
     const std::string& uniformBlockName) const {
   if (!_isLinked) {
@@ -108,11 +156,120 @@ GLuint ShaderProgram::getUniformBlockIndex(
 
 void ShaderProgram::bindUniformBlockToBindingPoint(
     const std::string& uniformBlockName,
-    const GLuint bindingPoint) const {
+    const GLuint bindingPoint) {
   const auto blockIndex = getUniformBlockIndex(uniformBlockName);
   if (blockIndex != GL_INVALID_INDEX) {
     glUniformBlockBinding(_shaderProgramID, blockIndex, bindingPoint);
   }
+
+  // Bindings are lost when the program is relinked
+  _uniformBlockBindings[uniformBlockName] = bindingPoint;
+}
+
+size_t ShaderProgram::getUniformShadowSlot(GLint location) const {
+  const auto slot = _uniformShadowSlots.find(location);
+  return slot != _uniformShadowSlots.end() ? slot->second : NO_SHADOW_SLOT;
+}
+
+bool ShaderProgram::updateUniformShadow(size_t slot,
+                                        const void* data,
+                                        size_t elementSize,
+                                        GLsizei count) const {
+  if (slot == NO_SHADOW_SLOT || count <= 0) {
+    return false;  // Setting it would do nothing anyway
+  }
+
+  // Elements past the end of the array are ignored by OpenGL
+  const auto elementCount =
+      std::min(static_cast<size_t>(count), _uniformSlotSpans[slot]);
+  const auto bytes = static_cast<const uint8_t*>(data);
+  bool hasChanged = false;
+  for (size_t i = 0; i < elementCount; i++) {
+    auto& shadow = _uniformShadows[slot + i];
+    const auto element = bytes + i * elementSize;
+    if (shadow.size() != elementSize ||
+        memcmp(shadow.data(), element, elementSize) != 0) {
+      shadow.assign(element, element + elementSize);
+      hasChanged = true;
+    }
+  }
+
+  if (!hasChanged) {
+    _uniformStatistics.uploadsSkipped++;
+    return false;
+  }
+  _uniformStatistics.uploads++;
+  return true;
+}
+
+const ShaderProgram::UniformStatistics& ShaderProgram::getUniformStatistics() {
+  return _uniformStatistics;
+}
+
+void ShaderProgram::resetUniformStatistics() {
+  _uniformStatistics = UniformStatistics();
+}
+
+void ShaderProgram::_setUniformHandleNames(const char* const* names,
+                                           size_t count) {
+  _uniformHandleNames = names;
+  _uniformLocations.assign(count, -1);
+  if (_isLinked) {
+    _resolveUniformHandles();
+  }
+}
+
+void ShaderProgram::_resolveUniformHandles() {
+  _uniformHandleSlots.resize(_uniformLocations.size());
+  for (size_t i = 0; i < _uniformLocations.size(); i++) {
+    _uniformLocations[i] =
+        glGetUniformLocation(_shaderProgramID, _uniformHandleNames[i]);
+    _uniformHandleSlots[i] = getUniformShadowSlot(_uniformLocations[i]);
+    if (_uniformLocations[i] == -1) {
+      std::cout << "WARNING: uniform with name " << _uniformHandleNames[i]
+                << " does not exist, setting it will fail.\n";
+    }
+  }
+}
+
+void ShaderProgram::_resolveUniformShadowSlots() {
+  _uniformShadowSlots.clear();
+  _uniformSlotSpans.clear();
+  _uniformShadows.clear();
+
+  GLint uniformCount = 0, maxNameLength = 0;
+  glGetProgramiv(_shaderProgramID, GL_ACTIVE_UNIFORMS, &uniformCount);
+  glGetProgramiv(_shaderProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH,
+                 &maxNameLength);
+  std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+  for (GLint u = 0; u < uniformCount; u++) {
+    GLint size = 0;
+    GLenum type = GL_NONE;
+    glGetActiveUniform(_shaderProgramID, static_cast<GLuint>(u),
+                       static_cast<GLsizei>(nameBuffer.size()), nullptr,
+                       &size, &type, nameBuffer.data());
+
+    // Array elements are looked up one by one, their locations not being
+    // required to follow each other ("name[0]" for the first)
+    std::string name = nameBuffer.data();
+    const bool isArray = name.size() > 3 &&
+                         name.compare(name.size() - 3, 3, "[0]") == 0;
+    if (isArray) {
+      name.resize(name.size() - 3);
+    }
+    for (GLint i = 0; i < size; i++) {
+      const auto elementName =
+          isArray ? name + "[" + std::to_string(i) + "]" : name;
+      const auto location =
+          glGetUniformLocation(_shaderProgramID, elementName.c_str());
+      if (location < 0) {
+        continue;  // In a uniform block
+      }
+      _uniformShadowSlots[location] = _uniformSlotSpans.size();
+      _uniformSlotSpans.push_back(static_cast<size_t>(size - i));
+    }
+  }
+  _uniformShadows.resize(_uniformSlotSpans.size());
 }
 
 void ShaderProgram::setTransformFeedbackRecordedVariables(
@@ -1,8 +1,12 @@
 #ifndef SHADER_PROGRAM_HPP
 #define SHADER_PROGRAM_HPP
 
+#include <cstdint>
 #include <map>
+#include <unordered_map>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -10,12 +14,22 @@
 
 #include "shader.hpp"
 #include "uniform.hpp"
+#include "uniform_handle.hpp"
 
 /**
  * Wraps OpenGL shader program (creation, adding shaders, linking)
  */
 class ShaderProgram {
  public:
+  /**
+   * Counts of the uniform uploads issued, and of those skipped because the
+   * uniform already had the value (over all the programs).
+   */
+  struct UniformStatistics {
+    size_t uploads = 0;
+    size_t uploadsSkipped = 0;
+  };
+
   ~ShaderProgram();
 
   /**
@@ -28,7 +42,7 @@ class ShaderProgram {
    * The given shader must already be loaded and compiled.
    * @return True, if the shader has been added or false otherwise.
    */
-  bool addShaderToProgram(const Shader& shader) const;
+  bool addShaderToProgram(const Shader& shader);
 
   /**
    * Links the program.
@@ -37,6 +51,20 @@ class ShaderProgram {
    */
   bool linkProgram();
 
+  /**
+   * Links the program again from the current version of its shaders (e.g.
+   * after some were reloaded), into a new OpenGL program replacing this one
+   * only if it links. Uniform block bindings are restored, but other uniforms
+   * must be set again.
+   * @return True if the program has been relinked, or false otherwise.
+   */
+  bool relinkProgram();
+
+  /**
+   * Checks if the given shader has been added to this program.
+   */
+  bool hasShader(const Shader& shader) const;
+
   /**
    * Uses this shader program.
    */
@@ -61,11 +89,86 @@ class ShaderProgram {
   Uniform& operator[](const std::string& varName);
 
   /**
-   * Sets the model and normal matrix at once.
-   * @param modelMatrix  Model matrix to be set, used to calculate the normal
-   * matrix
+   * Sets the table of uniforms set through typed handles, generated from the
+   * shaders of this program (e.g. shader_uniforms::MainUniforms). Their
+   * locations are resolved now if the program is linked, and every time it's
+   * (re)linked.
    */
-  void setModelAndNormalMatrix(const glm::mat4& modelMatrix);
+  template <typename Uniforms>
+  void setUniformHandles() {
+    _setUniformHandleNames(Uniforms::NAMES, Uniforms::COUNT);
+  }
+
+  /**
+   * Sets the uniform of a handle of this program's table (the program must be
+   * in use). Unlike operator[], no name is looked up.
+   * Throws std::runtime_error if the handle is of another table.
+   * @param handle  Handle of the uniform
+   * @param value   Value to be set
+   */
+  template <typename Table, typename T>
+  void set(UniformHandle<Table, T> handle, const T& value) const {
+    const auto location = _getUniformLocation(Table::NAMES, handle.index);
+    if (updateUniformShadow(_uniformHandleSlots[handle.index], &value,
+                            sizeof(T))) {
+      uniform_handle::setUniform(location, value);
+    }
+  }
+
+  /**
+   * Sets the array uniform of a handle of this program's table.
+   * Throws std::runtime_error if the handle is of another table.
+   * @param handle  Handle of the uniform
+   * @param values  Values to be set
+   * @param count   Number of values
+   */
+  template <typename Table, typename T>
+  void set(UniformHandle<Table, T> handle,
+           const T* values,
+           GLsizei count) const {
+    const auto location = _getUniformLocation(Table::NAMES, handle.index);
+    if (updateUniformShadow(_uniformHandleSlots[handle.index], values,
+                            sizeof(T), count)) {
+      uniform_handle::setUniform(location, values, count);
+    }
+  }
+
+  /**
+   * Gets the slot of the shadow copy of a uniform's value (each element of an
+   * array having its own, following the first one's).
+   * @param location  Location of the uniform (or of an array element)
+   * @return The slot, or NO_SHADOW_SLOT if the uniform doesn't exist
+   */
+  size_t getUniformShadowSlot(GLint location) const;
+
+  /**
+   * Compares the values about to be set to a uniform (or to consecutive
+   * elements of an array) with the shadow copies of the last values set, and
+   * records them.
+   * @param slot         Slot of the uniform (or first element) to be set
+   * @param data         Values to be set
+   * @param elementSize  Size of each value (in bytes)
+   * @param count        Number of values
+   * @return True if the values must be uploaded, or false if the uniform has
+   * them already (or doesn't exist).
+   */
+  bool updateUniformShadow(size_t slot,
+                           const void* data,
+                           size_t elementSize,
+                           GLsizei count = 1) const;
+
+  // Slot of uniforms without shadow copies (which don't exist)
+  static constexpr size_t NO_SHADOW_SLOT = SIZE_MAX;
+
+  /**
+   * Gets the uniform upload statistics since the last reset.
+   */
+  static const UniformStatistics& getUniformStatistics();
+
+  /**
+   * Resets the uniform upload statistics (e.g. each frame).
+   */
+  static void resetUniformStatistics();
 
   /**
    * Gets index of given uniform block in this shader program.
@@ -84,7 +187,7 @@ class ShaderProgram {
    * https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glUniformBlockBinding.xhtml
    */
   void bindUniformBlockToBindingPoint(const std::string& uniformBlockName,
-                                      GLuint bindingPoint) const;
+                                      GLuint bindingPoint);
 
   /**
    * Tells OpenGL, which output variables should be recorded during transform
@@ -101,11 +204,59 @@ class ShaderProgram {
       GLenum bufferMode = GL_INTERLEAVED_ATTRIBS) const;
 
  private:
+  /**
+   * Sets the names of the uniforms of the handle table, and resolves them.
+   */
+  void _setUniformHandleNames(const char* const* names, size_t count);
+
+  /**
+   * Gets the locations of the uniforms of the handle table.
+   */
+  void _resolveUniformHandles();
+
+  /**
+   * Gives a shadow slot to every element of the active uniforms, and clears
+   * the shadow copies (a newly linked program has its default values).
+   */
+  void _resolveUniformShadowSlots();
+
+  /**
+   * Gets the location of a uniform of the handle table, checking that the
+   * handle is of that table (tables are told apart by their names array).
+   * @param tableNames  Names of the handle's table
+   * @param index       Index of the handle in its table
+   */
+  GLint _getUniformLocation(const char* const* tableNames,
+                            size_t index) const {
+    if (tableNames != _uniformHandleNames) {
+      throw std::runtime_error(
+          "Uniform handle of another table than the program's");
+    }
+    return _uniformLocations[index];
+  }
+
   GLuint _shaderProgramID = 0;  // OpenGL-assigned shader program ID
   bool _isLinked = false;       // Flag telling whether shader program has been
                                 // successfully linked
   std::map<std::string, Uniform>
       _uniforms;  // Cache of uniform locations (to reduces OpenGL calls)
+  std::vector<const Shader*> _shaders;  // Shaders added to the program
+  std::map<std::string, GLuint>
+      _uniformBlockBindings;  // Binding point of each bound uniform block
+  const char* const* _uniformHandleNames =
+      nullptr;  // Names of the uniforms of the handle table
+  std::vector<GLint>
+      _uniformLocations;  // Locations of the handle table, by handle index
+  std::vector<size_t>
+      _uniformHandleSlots;  // Shadow slots of the handle table, by index
+  std::unordered_map<GLint, size_t>
+      _uniformShadowSlots;  // Shadow slot of each active uniform location
+  std::vector<size_t> _uniformSlotSpans;  // Elements of the array from each
+                                          // slot on (1 if not an array)
+  mutable std::vector<std::vector<uint8_t>>
+      _uniformShadows;  // Last values set, by slot (empty if unknown)
+
+  static UniformStatistics _uniformStatistics;  // Statistics since the reset
 };
 
 /**
@@ -115,6 +266,7 @@ class ShaderProgramKeys {
  public:
   DEFINE_SHADER_CONSTANT(main, "main");
   DEFINE_SHADER_CONSTANT(depth, "depth");
+  DEFINE_SHADER_CONSTANT(cascade, "cascade");
 };
 
 #endif
\ No newline at end of file
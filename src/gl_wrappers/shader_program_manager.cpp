@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <iostream>
 #include <stdexcept>
 
 #include "shader_program_manager.hpp"
@@ -42,6 +44,24 @@ void ShaderProgramManager::linkAllPrograms() {
   }
 }
 
+void ShaderProgramManager::relinkProgramsUsing(
+    const std::vector<const Shader*>& shaders) {
+  for (const auto& keyShaderProgramPair : _shaderProgramCache) {
+    auto& shaderProgram = *keyShaderProgramPair.second;
+    const auto usesShader = [&shaderProgram](const Shader* shader) {
+      return shaderProgram.hasShader(*shader);
+    };
+    if (std::none_of(shaders.begin(), shaders.end(), usesShader)) {
+      continue;
+    }
+
+    if (!shaderProgram.relinkProgram()) {
+      std::cerr << "Keeping the previous version of shader program '"
+                << keyShaderProgramPair.first << "'\n";
+    }
+  }
+}
+
 void ShaderProgramManager::clearShaderProgramCache() {
   _shaderProgramCache.clear();
 }
@@ -4,6 +4,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -43,6 +44,15 @@ class ShaderProgramManager {
    */
   void linkAllPrograms();
 
+  /**
+   * Relinks the shader programs using any of the given shaders (e.g. after
+   * they were reloaded). Programs that don't link anymore are kept as they
+   * were.
+   *
+   * @param shaders  Shaders that changed
+   */
+  void relinkProgramsUsing(const std::vector<const Shader*>& shaders);
+
   /**
    * Deletes all the shader programs loaded and clears the shader program cache.
    */
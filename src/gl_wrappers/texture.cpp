@@ -1,9 +1,15 @@
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <mutex>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "../utils/profiler.hpp"
+
 #include "texture.hpp"
 
 Texture::~Texture() {
@@ -69,31 +75,124 @@ bool Texture::create(GLsizei width, GLsizei height, GLenum format) {
 }
 
 bool Texture::loadTexture2D(const std::string& filePath, bool generateMipmaps) {
-  stbi_set_flip_vertically_on_load(1);
-  int bytesPerPixel;
-  const auto imageData = stbi_load(filePath.c_str(), &_width, &_height,
+  const auto image = decodeImage(filePath);
+  if (image == nullptr) {
+    return false;
+  }
+
+  return createFromImage(*image, generateMipmaps);
+}
+
+std::unique_ptr<Texture::Image> Texture::decodeImage(
+    const std::string& filePath) {
+  const auto asset = Profiler::getAssetName("texture", filePath);
+  Profiler::ScopedPhase phase(asset, "decode");
+
+  // Prefer the baked version, which only needs to be mapped, unless the source
+  // image was edited since it was baked
+  const auto compressedFilePath = KtxFile::getCompressedFilePath(filePath);
+  std::error_code sourceError, compressedError;
+  const auto sourceTime =
+      std::filesystem::last_write_time(filePath, sourceError);
+  const auto compressedTime =
+      std::filesystem::last_write_time(compressedFilePath, compressedError);
+  const bool isBakedUpToDate =
+      !compressedError && (sourceError || compressedTime >= sourceTime);
+  if (isCompressionSupported() && isBakedUpToDate) {
+    auto compressedFile = std::make_unique<KtxFile>();
+    if (compressedFile->open(compressedFilePath)) {
+      auto image = std::make_unique<Image>();
+      image->width = compressedFile->getLevels().front().width;
+      image->height = compressedFile->getLevels().front().height;
+      image->format = compressedFile->getInternalFormat();
+      image->filePath = filePath;
+      image->compressedFile = std::move(compressedFile);
+      Profiler::getInstance().addCount(asset, "bytes", image->getDataSize());
+      return image;
+    }
+  }
+
+  // Flip setting is per thread, as images may be decoded concurrently
+  stbi_set_flip_vertically_on_load_thread(1);
+  int width, height, bytesPerPixel;
+  const auto imageData = stbi_load(filePath.c_str(), &width, &height,
                                    &bytesPerPixel, STBI_default);
   if (imageData == nullptr) {
     std::cerr << "Unable to load texture image: " << filePath << "\n";
-    return false;
+    return nullptr;
   }
 
-  GLenum format = 0;
+  auto image = std::make_unique<Image>();
+  image->data.reset(imageData);
+  image->width = width;
+  image->height = height;
+  image->filePath = filePath;
   if (bytesPerPixel == 4) {
-    format = GL_RGBA;
+    image->format = GL_RGBA;
   } else if (bytesPerPixel == 3) {
-    format = GL_RGB;
+    image->format = GL_RGB;
   } else if (bytesPerPixel == 1) {
-    format = GL_DEPTH_COMPONENT;
+    image->format = GL_DEPTH_COMPONENT;
+  }
+  Profiler::getInstance().addCount(asset, "bytes", image->getDataSize());
+
+  return image;
+}
+
+bool Texture::createFromImage(const Image& image, bool generateMipmaps) {
+  const auto asset = Profiler::getAssetName("texture", image.filePath);
+  Profiler::ScopedPhase phase(asset, "upload");
+  Profiler::getInstance().addCount(asset, "uploadedBytes", image.getDataSize());
+
+  if (image.isCompressed()) {
+    return _createFromCompressedImage(image, false);
   }
 
-  const auto result =
-      createFromData(imageData, _width, _height, format, generateMipmaps);
-  stbi_image_free(imageData);
-  _filePath = filePath;
+  const auto result = createFromData(image.data.get(), image.width,
+                                     image.height, image.format,
+                                     generateMipmaps);
+  _filePath = image.filePath;
   return result;
 }
 
+bool Texture::createFromPixelBuffer(const Image& image, bool generateMipmaps) {
+  if (image.isCompressed()) {
+    return _createFromCompressedImage(image, true);
+  }
+
+  // With a pixel unpack buffer bound, null data means offset 0 in the buffer
+  const auto result = createFromData(nullptr, image.width, image.height,
+                                     image.format, generateMipmaps);
+  _filePath = image.filePath;
+  return result;
+}
+
+void Texture::Image::DataDeleter::operator()(unsigned char* data) const {
+  stbi_image_free(data);
+}
+
+bool Texture::Image::isCompressed() const {
+  return compressedFile != nullptr;
+}
+
+size_t Texture::Image::getDataSize() const {
+  if (isCompressed()) {
+    size_t size = 0;
+    for (const auto& level : compressedFile->getLevels()) {
+      size += level.size;
+    }
+    return size;
+  }
+
+  size_t bytesPerPixel = 1;
+  if (format == GL_RGBA) {
+    bytesPerPixel = 4;
+  } else if (format == GL_RGB) {
+    bytesPerPixel = 3;
+  }
+  return size_t(width) * size_t(height) * bytesPerPixel;
+}
+
 void Texture::bind(const GLenum textureUnit) const {
   if (!isLoadedLogged()) {
     return;
@@ -164,6 +263,70 @@ int Texture::getNumTextureImageUnits() {
   return maxTextureUnits;
 }
 
+bool Texture::isCompressionSupported() {
+  static std::once_flag queryOnceFlag;
+  static std::atomic<bool> isSupported(false);
+  std::call_once(queryOnceFlag, []() {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+      const auto extension =
+          reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+      if (extension != nullptr &&
+          strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0) {
+        isSupported = true;
+      }
+    }
+
+    if (!isSupported) {
+      std::cout << "Compressed textures not supported, decoding source "
+                   "images instead\n";
+    }
+  });
+
+  return isSupported;
+}
+
+bool Texture::_createFromCompressedImage(const Image& image,
+                                         bool fromPixelBuffer) {
+  if (isLoaded()) {
+    return false;
+  }
+
+  const auto& levels = image.compressedFile->getLevels();
+
+  // Update info
+  _width = image.width;
+  _height = image.height;
+  _format = image.format;
+  _filePath = image.filePath;
+
+  // Create the texture, with the baked mip chain
+  glGenTextures(1, &_textureID);
+  glBindTexture(GL_TEXTURE_2D, _textureID);
+  uintptr_t pixelBufferOffset = 0;
+  for (size_t i = 0; i < levels.size(); i++) {
+    const auto& level = levels[i];
+    // With a pixel unpack buffer bound, data is an offset in the buffer
+    const void* data = fromPixelBuffer
+                           ? reinterpret_cast<const void*>(pixelBufferOffset)
+                           : level.data;
+    glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), _format,
+                           level.width, level.height, 0,
+                           static_cast<GLsizei>(level.size), data);
+    pixelBufferOffset += level.size;
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                  static_cast<GLint>(levels.size() - 1));
+
+  // Set the texture's parameters
+  _setParameters();
+
+  std::cout << "Created compressed texture (ID: " << _textureID << ")\n";
+
+  return true;
+}
+
 bool Texture::isLoadedLogged() const {
   if (!isLoaded()) {
     std::cout << "Attempting to access non-loaded texture\n";
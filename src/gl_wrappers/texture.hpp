@@ -6,12 +6,44 @@
 #include <glad/glad.h>
 #include <memory>
 
+#include "ktx_file.hpp"
+
 /**
  *  Wraps OpenGL texture into convenient class.
  */
 class Texture
 {
 public:
+  /**
+   * Image decoded in CPU memory, ready to be uploaded as a texture.
+   */
+  struct Image
+  {
+    struct DataDeleter
+    {
+      void operator()(unsigned char *data) const;
+    };
+
+    std::unique_ptr<unsigned char, DataDeleter> data; // Decoded pixels
+    std::unique_ptr<KtxFile> compressedFile; // Baked mip chain (replaces the
+                                             // decoded pixels when loaded)
+    GLsizei width = 0;                       // Width in pixels
+    GLsizei height = 0;                      // Height in pixels
+    GLenum format = 0;    // Format of the pixels (e.g. GL_RGB, or compressed
+                          // format like GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+    std::string filePath; // Path to the file the image was decoded from
+
+    /**
+     * Checks, if the image is a block-compressed mip chain.
+     */
+    bool isCompressed() const;
+
+    /**
+     * Gets size of the pixels to upload (all levels when compressed), in bytes.
+     */
+    size_t getDataSize() const;
+  };
+
   ~Texture();
 
   /**
@@ -47,6 +79,33 @@ public:
    */
   bool loadTexture2D(const std::string &filePath, bool generateMipmaps = true);
 
+  /**
+   * Decodes an image file in CPU memory, without any OpenGL call (so it can be
+   * done on any thread). When compressed textures are supported and the image
+   * has been baked, its compressed version is mapped instead.
+   * @param filePath  Path to an image file
+   * @return The decoded image, or nullptr if it couldn't be decoded.
+   */
+  static std::unique_ptr<Image> decodeImage(const std::string &filePath);
+
+  /**
+   * Creates texture from an image decoded in CPU memory.
+   * @param image            The decoded image
+   * @param generateMipmaps  True if mipmaps should be generated automatically
+   * @return True if the texture has been loaded correctly, false otherwise.
+   */
+  bool createFromImage(const Image &image, bool generateMipmaps = true);
+
+  /**
+   * Creates texture from the pixels of an image (all levels, one after the
+   * other when compressed), already copied at the start of the bound
+   * GL_PIXEL_UNPACK_BUFFER (so the upload doesn't block).
+   * @param image            The image (only its size and format are used)
+   * @param generateMipmaps  True if mipmaps should be generated automatically
+   * @return True if the texture has been loaded correctly, false otherwise.
+   */
+  bool createFromPixelBuffer(const Image &image, bool generateMipmaps = true);
+
   /**
    * Binds texture to specified texture unit.
    * @param textureUnit  Texture unit index (default is 0)
@@ -98,6 +157,13 @@ public:
 
   static std::shared_ptr<Texture> getMissingTexture();
 
+  /**
+   * Checks, if the hardware supports the compressed formats the textures are
+   * baked to (S3TC). Must be called once from the OpenGL context's thread
+   * before images are decoded, then it can be called from any thread.
+   */
+  static bool isCompressionSupported();
+
 private:
   GLuint _textureID = 0; // OpenGL-assigned texture ID
   GLsizei _width = 0;    // Width of texture in pixels
@@ -114,6 +180,15 @@ private:
    */
   bool isLoadedLogged() const;
 
+  /**
+   * Creates texture from a block-compressed image, with its mip chain.
+   * @param image              The compressed image
+   * @param fromPixelBuffer    True if the levels have been copied to the bound
+   * GL_PIXEL_UNPACK_BUFFER
+   * @return True if the texture has been loaded correctly, false otherwise.
+   */
+  bool _createFromCompressedImage(const Image &image, bool fromPixelBuffer);
+
   /**
    * Sets the texture parmeters (filtering, wrapping, etc.)
    */
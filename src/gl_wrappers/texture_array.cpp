@@ -0,0 +1,112 @@
+#include <iostream>
+
+#include "texture_array.hpp"
+
+TextureArray::~TextureArray() {
+  deleteTexture();
+}
+
+bool TextureArray::create(GLsizei width,
+                          GLsizei height,
+                          GLsizei layerCount,
+                          GLenum internalFormat,
+                          GLenum format) {
+  if (isLoaded()) {
+    return false;
+  }
+
+  // Update info
+  _width = width;
+  _height = height;
+  _layerCount = layerCount;
+
+  // Create the texture
+  glGenTextures(1, &_textureID);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, _width, _height,
+               _layerCount, 0, format, GL_FLOAT, nullptr);
+
+  // Filtering (bilinear, which depth comparison turns into 2x2 PCF)
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+  // Wrapping
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  std::cout << "Created texture array (ID: " << _textureID
+            << ", dimensions: " << _width << " x " << _height << " x "
+            << _layerCount << ")\n";
+
+  return true;
+}
+
+void TextureArray::enableDepthComparison() const {
+  if (!_isLoadedLogged()) {
+    return;
+  }
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE,
+                  GL_COMPARE_REF_TO_TEXTURE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+}
+
+void TextureArray::bind(const GLenum textureUnit) const {
+  if (!_isLoadedLogged()) {
+    return;
+  }
+
+  glActiveTexture(GL_TEXTURE0 + textureUnit);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+}
+
+void TextureArray::unbind(const GLenum textureUnit) const {
+  if (!_isLoadedLogged()) {
+    return;
+  }
+
+  glActiveTexture(GL_TEXTURE0 + textureUnit);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::deleteTexture() {
+  if (!isLoaded()) {
+    return;
+  }
+
+  glDeleteTextures(1, &_textureID);
+  _textureID = 0;
+  _width = 0;
+  _height = 0;
+  _layerCount = 0;
+}
+
+GLuint TextureArray::getID() const {
+  return _textureID;
+}
+
+GLsizei TextureArray::getWidth() const {
+  return _width;
+}
+
+GLsizei TextureArray::getHeight() const {
+  return _height;
+}
+
+GLsizei TextureArray::getLayerCount() const {
+  return _layerCount;
+}
+
+bool TextureArray::isLoaded() const {
+  return _textureID != 0;
+}
+
+bool TextureArray::_isLoadedLogged() const {
+  if (!isLoaded()) {
+    std::cout << "Attempting to access non-created texture array\n";
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,91 @@
+#ifndef TEXTURE_ARRAY_HPP
+#define TEXTURE_ARRAY_HPP
+
+#include <glad/glad.h>
+
+/**
+ *  Wraps OpenGL 2D texture array into convenient class (e.g. for shadow maps,
+ *  one layer each).
+ */
+class TextureArray {
+ public:
+  ~TextureArray();
+
+  /**
+   * Creates an empty texture array with the given size and format.
+   * @param width           Width of the layers (in pixels)
+   * @param height          Height of the layers (in pixels)
+   * @param layerCount      Number of layers
+   * @param internalFormat  Format of the texels (e.g. GL_DEPTH_COMPONENT24)
+   * @param format          Format matching the internal one (e.g.
+   * GL_DEPTH_COMPONENT)
+   * @return True if the texture array was successfully created, false
+   * otherwise.
+   */
+  bool create(GLsizei width,
+              GLsizei height,
+              GLsizei layerCount,
+              GLenum internalFormat,
+              GLenum format);
+
+  /**
+   * Makes samplers of the texture compare a reference depth to the texels
+   * (sampler2DArrayShadow), rather than return them.
+   */
+  void enableDepthComparison() const;
+
+  /**
+   * Binds texture array to specified texture unit.
+   * @param textureUnit  Texture unit index (default is 0)
+   */
+  void bind(GLenum textureUnit = 0) const;
+
+  /**
+   * Unbinds texture array from specified texture unit.
+   * @param textureUnit  Texture unit index (default is 0)
+   */
+  void unbind(GLenum textureUnit = 0) const;
+
+  /**
+   * Deletes the texture from OpenGL. Does nothing if the texture has not been
+   * created.
+   */
+  void deleteTexture();
+
+  /**
+   * Gets OpenGL-assigned texture ID
+   */
+  GLuint getID() const;
+
+  /**
+   * Gets width of the layers (in pixels).
+   */
+  GLsizei getWidth() const;
+
+  /**
+   * Gets height of the layers (in pixels).
+   */
+  GLsizei getHeight() const;
+
+  /**
+   * Gets number of layers.
+   */
+  GLsizei getLayerCount() const;
+
+  bool isLoaded() const;
+
+ private:
+  GLuint _textureID = 0;    // OpenGL-assigned texture ID
+  GLsizei _width = 0;       // Width of the layers in pixels
+  GLsizei _height = 0;      // Height of the layers in pixels
+  GLsizei _layerCount = 0;  // Number of layers
+
+  /**
+   * Checks, if the texture has been created and if not, logs it into console.
+   *
+   * @return True, if texture has been created or false otherwise.
+   */
+  bool _isLoadedLogged() const;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+#include "texture_streamer.hpp"
+
+#include "texture_manager.hpp"
+
+TextureManager& TextureManager::getInstance() {
+  static TextureManager tm;
+  return tm;
+}
+
+std::shared_ptr<Texture> TextureManager::getTexture(
+    const std::string& filePath,
+    const Texture::Image* decodedImage) {
+  const auto canonicalPath = canonicalizePath(filePath);
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // Cache hit
+  const auto cachedTexture = _textureCache.find(canonicalPath);
+  if (cachedTexture != _textureCache.end()) {
+    _statistics.hits++;
+    return cachedTexture->second;
+  }
+
+  // Cache miss, decode the image if needed and upload it
+  _statistics.misses++;
+  std::unique_ptr<Texture::Image> image;
+  if (decodedImage == nullptr) {
+    image = Texture::decodeImage(filePath);
+    if (image == nullptr) {
+      return nullptr;
+    }
+    decodedImage = image.get();
+  }
+
+  auto texture = std::make_shared<Texture>();
+  if (!texture->createFromImage(*decodedImage)) {
+    return nullptr;
+  }
+
+  _textureCache[canonicalPath] = texture;
+  return texture;
+}
+
+std::shared_ptr<Texture> TextureManager::getTextureAsync(
+    const std::string& filePath,
+    std::shared_ptr<const Texture::Image> decodedImage) {
+  const auto canonicalPath = canonicalizePath(filePath);
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // Cache hit (the texture may still be streaming in)
+  const auto cachedTexture = _textureCache.find(canonicalPath);
+  if (cachedTexture != _textureCache.end()) {
+    _statistics.hits++;
+    return cachedTexture->second;
+  }
+
+  // Cache miss, stream the texture in
+  _statistics.misses++;
+  auto texture = std::make_shared<Texture>();
+  if (decodedImage != nullptr) {
+    TextureStreamer::getInstance().uploadImageAsync(texture,
+                                                    std::move(decodedImage));
+  } else {
+    TextureStreamer::getInstance().loadTextureAsync(texture, filePath);
+  }
+
+  _textureCache[canonicalPath] = texture;
+  return texture;
+}
+
+bool TextureManager::reloadTexture(const std::string& filePath) {
+  const auto canonicalPath = canonicalizePath(filePath);
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  const auto cachedTexture = _textureCache.find(canonicalPath);
+  if (cachedTexture == _textureCache.end()) {
+    return false;
+  }
+
+  std::cout << "Reloading texture: " << filePath << "\n";
+  TextureStreamer::getInstance().reloadTextureAsync(cachedTexture->second,
+                                                    filePath);
+  return true;
+}
+
+bool TextureManager::containsTexture(const std::string& filePath) const {
+  const auto canonicalPath = canonicalizePath(filePath);
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _textureCache.count(canonicalPath) > 0;
+}
+
+size_t TextureManager::evictUnusedTextures() {
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  size_t evictedCount = 0;
+  for (auto it = _textureCache.begin(); it != _textureCache.end();) {
+    // Only referenced by the cache
+    if (it->second.use_count() == 1) {
+      it = _textureCache.erase(it);
+      evictedCount++;
+    } else {
+      ++it;
+    }
+  }
+
+  _statistics.evictions += evictedCount;
+  return evictedCount;
+}
+
+TextureManager::Statistics TextureManager::getStatistics() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto statistics = _statistics;
+  statistics.textureCount = _textureCache.size();
+  return statistics;
+}
+
+void TextureManager::logStatistics() const {
+  const auto statistics = getStatistics();
+  std::cout << "Texture cache: " << statistics.textureCount << " textures, "
+            << statistics.hits << " hits, " << statistics.misses
+            << " misses, " << statistics.evictions << " evictions\n";
+}
+
+void TextureManager::clearTextureCache() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _textureCache.clear();
+}
+
+std::string TextureManager::canonicalizePath(const std::string& filePath) {
+  std::error_code errorCode;
+  auto path = std::filesystem::weakly_canonical(filePath, errorCode);
+  if (errorCode) {
+    path = std::filesystem::path(filePath);
+  }
+
+  return path.lexically_normal().generic_string();
+}
@@ -0,0 +1,134 @@
+#ifndef TEXTURE_MANAGER_HPP
+#define TEXTURE_MANAGER_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <glad/glad.h>
+
+#include "texture.hpp"
+
+/**
+ * Singleton class that manages and keeps track of all textures loaded from
+ * files, so that an image referenced several times is only decoded and
+ * uploaded once.
+ */
+class TextureManager {
+ public:
+  /**
+   * Statistics about the texture cache usage.
+   */
+  struct Statistics {
+    size_t hits = 0;       // Requests served from the cache
+    size_t misses = 0;     // Requests that needed to load a texture
+    size_t evictions = 0;  // Textures removed because they were unused
+    size_t textureCount = 0;  // Textures currently in the cache
+  };
+
+  /**
+   * Gets the one and only instance of the texture manager.
+   */
+  static TextureManager& getInstance();
+
+  /**
+   * Retrieves the texture loaded from the specified file, loading it if it
+   * isn't cached yet. Must be called from the OpenGL context's thread.
+   *
+   * @param filePath      Path to the image file
+   * @param decodedImage  Image already decoded from that file, used on cache
+   * misses (if nullptr, the file gets decoded on this thread)
+   *
+   * @return Shared texture, or nullptr if the file couldn't be loaded.
+   */
+  std::shared_ptr<Texture> getTexture(
+      const std::string& filePath,
+      const Texture::Image* decodedImage = nullptr);
+
+  /**
+   * Retrieves the texture loaded from the specified file, streaming it in with
+   * the TextureStreamer if it isn't cached yet. The returned texture stays
+   * unloaded until its data is uploaded. Must be called from the OpenGL
+   * context's thread.
+   *
+   * @param filePath      Path to the image file
+   * @param decodedImage  Image already decoded from that file, used on cache
+   * misses (if nullptr, the file gets decoded on the asset loading threads)
+   *
+   * @return Shared texture (possibly not loaded yet).
+   */
+  std::shared_ptr<Texture> getTextureAsync(
+      const std::string& filePath,
+      std::shared_ptr<const Texture::Image> decodedImage = nullptr);
+
+  /**
+   * Loads again the cached texture of the specified file (e.g. after the file
+   * changed), streaming the new data into the same texture, so that its users
+   * get it without noticing. Does nothing if the texture isn't cached. Must be
+   * called from the OpenGL context's thread.
+   *
+   * @param filePath  Path to the image file
+   *
+   * @return True if the texture is cached and being reloaded, false otherwise.
+   */
+  bool reloadTexture(const std::string& filePath);
+
+  /**
+   * Checks, if the texture loaded from the specified file is cached.
+   * Can be called from any thread (e.g. to skip decoding a cached image).
+   *
+   * @param filePath  Path to the image file
+   *
+   * @return True if the texture is cached or false otherwise.
+   */
+  bool containsTexture(const std::string& filePath) const;
+
+  /**
+   * Deletes the cached textures that aren't used anywhere else anymore.
+   *
+   * @return Number of evicted textures.
+   */
+  size_t evictUnusedTextures();
+
+  /**
+   * Gets statistics about the texture cache usage.
+   */
+  Statistics getStatistics() const;
+
+  /**
+   * Prints statistics about the texture cache usage.
+   */
+  void logStatistics() const;
+
+  /**
+   * Deletes all the cached textures (which are still alive while in use) and
+   * clears the texture cache.
+   */
+  void clearTextureCache();
+
+  /**
+   * Gets the canonical form of a path, so that different paths to the same
+   * file share the same cache entry.
+   *
+   * @param filePath  Path to canonicalize
+   *
+   * @return Canonical path (or normalized path if it can't be resolved).
+   */
+  static std::string canonicalizePath(const std::string& filePath);
+
+ private:
+  TextureManager() {}  // Private constructor to make class singleton
+  TextureManager(const TextureManager&) = delete;  // No copy constructor
+                                                   // allowed
+  void operator=(const TextureManager&) = delete;  // No copy assignment
+                                                   // allowed
+
+  std::map<std::string, std::shared_ptr<Texture>>
+      _textureCache;  // Texture cache - stores textures within their
+                      // canonical file paths in std::map
+  Statistics _statistics;     // Cache usage statistics
+  mutable std::mutex _mutex;  // Protects the cache and statistics
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "../utils/profiler.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include "texture_streamer.hpp"
+
+TextureStreamer& TextureStreamer::getInstance() {
+  static TextureStreamer ts;
+  return ts;
+}
+
+void TextureStreamer::loadTextureAsync(const std::shared_ptr<Texture>& texture,
+                                       const std::string& filePath) {
+  auto image = ThreadPool::getInstance().submit(
+      [filePath]() -> std::shared_ptr<const Texture::Image> {
+        return Texture::decodeImage(filePath);
+      });
+  _pendingTextures.push_back({texture, image.share()});
+}
+
+void TextureStreamer::reloadTextureAsync(
+    const std::shared_ptr<Texture>& texture,
+    const std::string& filePath) {
+  auto image = ThreadPool::getInstance().submit(
+      [filePath]() -> std::shared_ptr<const Texture::Image> {
+        return Texture::decodeImage(filePath);
+      });
+  _pendingTextures.push_back({texture, image.share(), true});
+}
+
+void TextureStreamer::uploadImageAsync(
+    const std::shared_ptr<Texture>& texture,
+    std::shared_ptr<const Texture::Image> image) {
+  std::promise<std::shared_ptr<const Texture::Image>> decodedImage;
+  decodedImage.set_value(std::move(image));
+  _pendingTextures.push_back({texture, decodedImage.get_future().share()});
+}
+
+void TextureStreamer::update() {
+  size_t uploadedBytes = 0;
+  size_t uploadedCount = 0;
+
+  while (!_pendingTextures.empty()) {
+    auto& pending = _pendingTextures.front();
+
+    // Textures are uploaded in request order, wait for the next one's decoding
+    if (pending.image.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      break;
+    }
+
+    // Drop textures freed in the meantime, and images that failed to decode
+    // (their material keeps the placeholder)
+    const auto texture = pending.texture.lock();
+    const auto image = pending.image.get();
+    if (texture == nullptr || image == nullptr ||
+        (texture->isLoaded() && !pending.isReload)) {
+      _pendingTextures.pop_front();
+      continue;
+    }
+
+    // Stop when out of budget (but always upload one image per frame) or when
+    // the GPU still reads every PBO
+    const auto imageSize = image->getDataSize();
+    if ((uploadedCount > 0 && uploadedBytes + imageSize > _uploadBudget) ||
+        !_isNextPixelBufferAvailable()) {
+      break;
+    }
+
+    // Reloaded textures keep their old data until now
+    if (pending.isReload) {
+      texture->deleteTexture();
+    }
+    _upload(*texture, *image);
+    uploadedBytes += imageSize;
+    uploadedCount++;
+    _pendingTextures.pop_front();
+  }
+}
+
+void TextureStreamer::setUploadBudget(size_t budgetBytes) {
+  _uploadBudget = budgetBytes;
+}
+
+size_t TextureStreamer::getPendingCount() const {
+  return _pendingTextures.size();
+}
+
+void TextureStreamer::clear() {
+  _pendingTextures.clear();
+
+  for (auto& pixelBuffer : _pixelBuffers) {
+    if (pixelBuffer.fence != nullptr) {
+      glDeleteSync(pixelBuffer.fence);
+      pixelBuffer.fence = nullptr;
+    }
+    if (pixelBuffer.bufferID != 0) {
+      glDeleteBuffers(1, &pixelBuffer.bufferID);
+      pixelBuffer.bufferID = 0;
+      pixelBuffer.bufferSize = 0;
+    }
+  }
+}
+
+bool TextureStreamer::_isNextPixelBufferAvailable() {
+  auto& pixelBuffer = _pixelBuffers[_nextPixelBuffer];
+  if (pixelBuffer.fence == nullptr) {
+    return true;
+  }
+
+  // Only poll the fence, never wait for the GPU
+  const auto status = glClientWaitSync(pixelBuffer.fence, 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    return false;
+  }
+
+  glDeleteSync(pixelBuffer.fence);
+  pixelBuffer.fence = nullptr;
+  return true;
+}
+
+bool TextureStreamer::_upload(Texture& texture, const Texture::Image& image) {
+  const auto asset = Profiler::getAssetName("texture", image.filePath);
+  Profiler::ScopedPhase phase(asset, "upload");
+  Profiler::getInstance().addCount(asset, "uploadedBytes", image.getDataSize());
+
+  auto& pixelBuffer = _pixelBuffers[_nextPixelBuffer];
+  _nextPixelBuffer = (_nextPixelBuffer + 1) % PIXEL_BUFFER_COUNT;
+
+  const auto imageSize = image.getDataSize();
+
+  if (pixelBuffer.bufferID == 0) {
+    glGenBuffers(1, &pixelBuffer.bufferID);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer.bufferID);
+
+  // Grow the PBO if needed (the GPU is done with it, so it can be reallocated)
+  if (pixelBuffer.bufferSize < imageSize) {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, imageSize, nullptr, GL_STREAM_DRAW);
+    pixelBuffer.bufferSize = imageSize;
+  }
+
+  // Copy the pixels into the PBO
+  const auto mappedData = glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, 0, imageSize,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT |
+          GL_MAP_UNSYNCHRONIZED_BIT);
+  if (mappedData == nullptr) {
+    std::cerr << "Unable to map pixel buffer for texture: " << image.filePath
+              << "\n";
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return false;
+  }
+  if (image.isCompressed()) {
+    // Levels one after the other
+    auto levelData = static_cast<unsigned char*>(mappedData);
+    for (const auto& level : image.compressedFile->getLevels()) {
+      memcpy(levelData, level.data, level.size);
+      levelData += level.size;
+    }
+  } else {
+    memcpy(mappedData, image.data.get(), imageSize);
+  }
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+  // Create the texture from the PBO (the copy happens asynchronously)
+  const auto result = texture.createFromPixelBuffer(image);
+
+  // Fence the PBO, so that it's not overwritten while the GPU reads it
+  pixelBuffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  return result;
+}
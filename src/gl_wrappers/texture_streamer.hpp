@@ -0,0 +1,133 @@
+#ifndef TEXTURE_STREAMER_HPP
+#define TEXTURE_STREAMER_HPP
+
+#include <array>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+
+#include <glad/glad.h>
+
+#include "texture.hpp"
+
+/**
+ * Singleton class that loads textures without stalling the render thread.
+ * Images are decoded on the asset loading threads, then uploaded a few per
+ * frame through a ring of pixel buffer objects (PBO), each PBO being reused
+ * only once the GPU signals (with a fence) it's done reading it.
+ *
+ * Streamed textures stay unloaded until their data is uploaded, so materials
+ * bind the missing texture placeholder in the meantime.
+ */
+class TextureStreamer {
+ public:
+  /**
+   * Gets the one and only instance of the texture streamer.
+   */
+  static TextureStreamer& getInstance();
+
+  /**
+   * Starts decoding an image file on the asset loading threads. The texture is
+   * filled by a later update(), once the image is decoded.
+   *
+   * @param texture   Texture to fill (not loaded yet)
+   * @param filePath  Path to the image file
+   */
+  void loadTextureAsync(const std::shared_ptr<Texture>& texture,
+                        const std::string& filePath);
+
+  /**
+   * Decodes an image file again on the asset loading threads, to replace the
+   * data of a loaded texture (e.g. after the file changed). The texture keeps
+   * its current data until the new one is uploaded, and for good if the file
+   * can't be decoded.
+   *
+   * @param texture   Texture to refill (loaded or not)
+   * @param filePath  Path to the image file
+   */
+  void reloadTextureAsync(const std::shared_ptr<Texture>& texture,
+                          const std::string& filePath);
+
+  /**
+   * Queues the upload of an already decoded image.
+   *
+   * @param texture  Texture to fill (not loaded yet)
+   * @param image    The decoded image
+   */
+  void uploadImageAsync(const std::shared_ptr<Texture>& texture,
+                        std::shared_ptr<const Texture::Image> image);
+
+  /**
+   * Recycles the PBOs the GPU is done with and uploads decoded images, within
+   * the upload budget. Must be called once per frame on the render thread.
+   */
+  void update();
+
+  /**
+   * Sets how many bytes may be uploaded each frame. At least one image is
+   * uploaded per frame, even if it's bigger than the budget.
+   *
+   * @param budgetBytes  Upload budget per frame, in bytes
+   */
+  void setUploadBudget(size_t budgetBytes);
+
+  /**
+   * Gets number of textures waiting to be decoded or uploaded.
+   */
+  size_t getPendingCount() const;
+
+  /**
+   * Deletes the PBOs and their fences, and drops the pending textures.
+   */
+  void clear();
+
+ private:
+  TextureStreamer() {}  // Private constructor to make class singleton
+  TextureStreamer(const TextureStreamer&) = delete;  // No copy constructor
+                                                     // allowed
+  void operator=(const TextureStreamer&) = delete;   // No copy assignment
+                                                     // allowed
+
+  /**
+   * Texture waiting for its image to be decoded and uploaded.
+   */
+  struct PendingTexture {
+    std::weak_ptr<Texture> texture;  // Texture to fill (skipped if freed)
+    std::shared_future<std::shared_ptr<const Texture::Image>>
+        image;  // Decoded image (nullptr if the file couldn't be decoded)
+    bool isReload = false;  // Replaces the data of an already loaded texture
+  };
+
+  /**
+   * Pixel buffer object of the ring, with the fence of its last upload.
+   */
+  struct PixelBuffer {
+    GLuint bufferID = 0;     // OpenGL-assigned buffer ID
+    size_t bufferSize = 0;   // Allocated size (in bytes)
+    GLsync fence = nullptr;  // Signaled when the GPU is done reading it
+  };
+
+  static constexpr size_t PIXEL_BUFFER_COUNT = 4;  // Size of the PBO ring
+
+  std::deque<PendingTexture> _pendingTextures;  // Textures to upload, in
+                                                // request order
+  std::array<PixelBuffer, PIXEL_BUFFER_COUNT> _pixelBuffers;  // PBO ring
+  size_t _nextPixelBuffer = 0;  // Next PBO of the ring to upload through
+  size_t _uploadBudget = 8 * 1024 * 1024;  // Bytes uploaded per frame
+
+  /**
+   * Checks, if the next PBO of the ring can be written (its last upload is
+   * complete), deleting its fence if so.
+   */
+  bool _isNextPixelBufferAvailable();
+
+  /**
+   * Uploads an image to a texture through the next PBO of the ring.
+   *
+   * @return True if the texture has been created, false otherwise.
+   */
+  bool _upload(Texture& texture, const Texture::Image& image);
+};
+
+#endif
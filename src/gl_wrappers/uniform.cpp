@@ -11,6 +11,15 @@ Uniform::Uniform(const std::string& name, ShaderProgram* shaderProgram)
     std::cout << "WARNING: uniform with name " << name
               << " does not exist, setting it will fail.\n";
   }
+  _shadowSlot = _shaderProgram->getUniformShadowSlot(_location);
+}
+
+bool Uniform::_shouldUpload(const void* data,
+                            size_t elementSize,
+                            GLsizei count) const {
+  return _shaderProgram == nullptr ||
+         _shaderProgram->updateUniformShadow(_shadowSlot, data, elementSize,
+                                             count);
 }
 
 Uniform& Uniform::operator=(const glm::vec2& vector2D) {
@@ -21,10 +30,16 @@ Uniform& Uniform::operator=(const glm::vec2& vector2D) {
 // Family of functions setting vec2 uniforms
 
 void Uniform::set(const glm::vec2& vector2D) const {
+  if (!_shouldUpload(&vector2D, sizeof(vector2D))) {
+    return;
+  }
   glUniform2fv(_location, 1, reinterpret_cast<const GLfloat*>(&vector2D));
 }
 
 void Uniform::set(const glm::vec2* vectors2D, GLsizei count) const {
+  if (!_shouldUpload(vectors2D, sizeof(glm::vec2), count)) {
+    return;
+  }
   glUniform2fv(_location, count, reinterpret_cast<const GLfloat*>(vectors2D));
 }
 
@@ -36,10 +51,16 @@ Uniform& Uniform::operator=(const glm::vec3& vector3D) {
 }
 
 void Uniform::set(const glm::vec3& vector3D) const {
+  if (!_shouldUpload(&vector3D, sizeof(vector3D))) {
+    return;
+  }
   glUniform3fv(_location, 1, reinterpret_cast<const GLfloat*>(&vector3D));
 }
 
 void Uniform::set(const glm::vec3* vectors3D, GLsizei count) const {
+  if (!_shouldUpload(vectors3D, sizeof(glm::vec3), count)) {
+    return;
+  }
   glUniform3fv(_location, count, reinterpret_cast<const GLfloat*>(vectors3D));
 }
 
@@ -51,10 +72,16 @@ Uniform& Uniform::operator=(const glm::vec4& vector4D) {
 }
 
 void Uniform::set(const glm::vec4& vector4D) const {
+  if (!_shouldUpload(&vector4D, sizeof(vector4D))) {
+    return;
+  }
   glUniform4fv(_location, 1, reinterpret_cast<const GLfloat*>(&vector4D));
 }
 
 void Uniform::set(const glm::vec4* vectors4D, GLsizei count) const {
+  if (!_shouldUpload(vectors4D, sizeof(glm::vec4), count)) {
+    return;
+  }
   glUniform4fv(_location, count, reinterpret_cast<const GLfloat*>(vectors4D));
 }
 
@@ -71,10 +98,16 @@ Uniform& Uniform::operator=(const std::vector<GLfloat>& floatValues) {
 }
 
 void Uniform::set(GLfloat floatValue) const {
+  if (!_shouldUpload(&floatValue, sizeof(floatValue))) {
+    return;
+  }
   glUniform1fv(_location, 1, static_cast<const GLfloat*>(&floatValue));
 }
 
 void Uniform::set(const GLfloat* floatValues, GLsizei count) const {
+  if (!_shouldUpload(floatValues, sizeof(GLfloat), count)) {
+    return;
+  }
   glUniform1fv(_location, count, floatValues);
 }
 
@@ -86,10 +119,16 @@ Uniform& Uniform::operator=(const GLint integerValue) {
 }
 
 void Uniform::set(GLint integerValue) const {
+  if (!_shouldUpload(&integerValue, sizeof(integerValue))) {
+    return;
+  }
   glUniform1iv(_location, 1, static_cast<const GLint*>(&integerValue));
 }
 
 void Uniform::set(const GLint* integerValues, GLsizei count) const {
+  if (!_shouldUpload(integerValues, sizeof(GLint), count)) {
+    return;
+  }
   glUniform1iv(_location, count, integerValues);
 }
 
@@ -101,11 +140,17 @@ Uniform& Uniform::operator=(const glm::mat3& matrix) {
 }
 
 void Uniform::set(const glm::mat3& matrix) const {
+  if (!_shouldUpload(&matrix, sizeof(matrix))) {
+    return;
+  }
   glUniformMatrix3fv(_location, 1, false,
                      reinterpret_cast<const GLfloat*>(&matrix));
 }
 
 void Uniform::set(const glm::mat3* matrices, GLsizei count) const {
+  if (!_shouldUpload(matrices, sizeof(glm::mat3), count)) {
+    return;
+  }
   glUniformMatrix3fv(_location, count, false,
                      reinterpret_cast<const GLfloat*>(matrices));
 }
@@ -118,11 +163,17 @@ Uniform& Uniform::operator=(const glm::mat4& matrix) {
 }
 
 void Uniform::set(const glm::mat4& matrix) const {
+  if (!_shouldUpload(&matrix, sizeof(matrix))) {
+    return;
+  }
   glUniformMatrix4fv(_location, 1, false,
                      reinterpret_cast<const GLfloat*>(&matrix));
 }
 
 void Uniform::set(const glm::mat4* matrices, GLsizei count) const {
+  if (!_shouldUpload(matrices, sizeof(glm::mat4), count)) {
+    return;
+  }
   glUniformMatrix4fv(_location, count, false,
                      reinterpret_cast<const GLfloat*>(matrices));
 }
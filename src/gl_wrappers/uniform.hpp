@@ -1,6 +1,7 @@
 #ifndef UNIFORM_HPP
 #define UNIFORM_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -56,11 +57,20 @@ class Uniform {
   void set(const glm::mat4* matrices, GLsizei count = 1) const;
 
  private:
+  /**
+   * Checks if a value must be uploaded, i.e. the uniform doesn't have it
+   * already (see ShaderProgram::updateUniformShadow()).
+   */
+  bool _shouldUpload(const void* data,
+                     size_t elementSize,
+                     GLsizei count = 1) const;
+
   std::string _name;  // Name of the uniform variable
   ShaderProgram* _shaderProgram =
       nullptr;  // Pointer to shader program this uniform belongs to
   GLint _location =
       -1;  // OpenGL assigned uniform location (cached in this variable)
+  size_t _shadowSlot = SIZE_MAX;  // Slot of the shadow copy of its value
 };
 
 #endif
@@ -68,6 +68,8 @@ class UniformBlockBindingPoints {
   static constexpr int AMBIENT_LIGHTS = 0;
   static constexpr int DIRECTIONAL_LIGHTS = 1;
   static constexpr int POINT_LIGHTS = 2;
+  static constexpr int CASCADED_SHADOWS = 3;
+  static constexpr int POINT_SHADOWS = 4;
 };
 
 #endif
\ No newline at end of file
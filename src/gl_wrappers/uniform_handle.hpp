@@ -0,0 +1,99 @@
+#ifndef UNIFORM_HANDLE_HPP
+#define UNIFORM_HANDLE_HPP
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+/**
+ * Typed handle of a uniform variable, generated from the shaders (see
+ * shader_uniforms.hpp). It's the index of the uniform in the table of its
+ * program (e.g. shader_uniforms::MainUniforms), whose locations are resolved
+ * once when the program is linked. The table is part of its type, so that
+ * programs reject the handles of other tables.
+ */
+template <typename Table, typename T>
+struct UniformHandle {
+  size_t index;  // Index of the uniform in the handle table of its program
+};
+
+namespace uniform_handle {
+
+// Functions setting a uniform at a location, by value type
+
+inline void setUniform(GLint location, bool value) {
+  glUniform1i(location, value);
+}
+
+inline void setUniform(GLint location, const GLint* values, GLsizei count) {
+  glUniform1iv(location, count, values);
+}
+
+inline void setUniform(GLint location, const GLuint* values, GLsizei count) {
+  glUniform1uiv(location, count, values);
+}
+
+inline void setUniform(GLint location, const GLfloat* values, GLsizei count) {
+  glUniform1fv(location, count, values);
+}
+
+inline void setUniform(GLint location,
+                       const glm::vec2* vectors2D,
+                       GLsizei count) {
+  glUniform2fv(location, count, reinterpret_cast<const GLfloat*>(vectors2D));
+}
+
+inline void setUniform(GLint location,
+                       const glm::vec3* vectors3D,
+                       GLsizei count) {
+  glUniform3fv(location, count, reinterpret_cast<const GLfloat*>(vectors3D));
+}
+
+inline void setUniform(GLint location,
+                       const glm::vec4* vectors4D,
+                       GLsizei count) {
+  glUniform4fv(location, count, reinterpret_cast<const GLfloat*>(vectors4D));
+}
+
+inline void setUniform(GLint location,
+                       const glm::ivec2* vectors2D,
+                       GLsizei count) {
+  glUniform2iv(location, count, reinterpret_cast<const GLint*>(vectors2D));
+}
+
+inline void setUniform(GLint location,
+                       const glm::ivec3* vectors3D,
+                       GLsizei count) {
+  glUniform3iv(location, count, reinterpret_cast<const GLint*>(vectors3D));
+}
+
+inline void setUniform(GLint location,
+                       const glm::ivec4* vectors4D,
+                       GLsizei count) {
+  glUniform4iv(location, count, reinterpret_cast<const GLint*>(vectors4D));
+}
+
+inline void setUniform(GLint location,
+                       const glm::mat3* matrices,
+                       GLsizei count) {
+  glUniformMatrix3fv(location, count, false,
+                     reinterpret_cast<const GLfloat*>(matrices));
+}
+
+inline void setUniform(GLint location,
+                       const glm::mat4* matrices,
+                       GLsizei count) {
+  glUniformMatrix4fv(location, count, false,
+                     reinterpret_cast<const GLfloat*>(matrices));
+}
+
+template <typename T>
+void setUniform(GLint location, const T& value) {
+  setUniform(location, &value, 1);
+}
+
+}  // namespace uniform_handle
+
+#endif
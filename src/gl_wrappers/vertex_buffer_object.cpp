@@ -84,6 +84,41 @@ void VertexBufferObject::uploadDataToGPU(GLenum usageHint) {
   _bytesAdded = 0;
 }
 
+void VertexBufferObject::uploadRawDataToGPU(const void* ptrData,
+                                            size_t dataSizeBytes,
+                                            GLenum usageHint) {
+  if (!isBufferCreated()) {
+    std::cerr << "Unable to upload vertex buffer object data to GPU because it "
+                 "isn't created.\n";
+    return;
+  }
+
+  glBufferData(_bufferType, dataSizeBytes, ptrData, usageHint);
+  _uploadedDataSize = dataSizeBytes;
+  _bytesAdded = 0;
+}
+
+GLenum VertexBufferObject::uploadIndicesToGPU(const GLuint* indices,
+                                              size_t indexCount,
+                                              size_t vertexCount,
+                                              GLenum usageHint) {
+  const auto indexType = getIndexType(vertexCount);
+  if (indexType == GL_UNSIGNED_INT) {
+    uploadRawDataToGPU(indices, indexCount * sizeof(GLuint), usageHint);
+    return indexType;
+  }
+
+  // Narrow indices to 16 bits
+  std::vector<GLushort> shortIndices(indices, indices + indexCount);
+  uploadRawDataToGPU(shortIndices.data(), indexCount * sizeof(GLushort),
+                     usageHint);
+  return indexType;
+}
+
+GLenum VertexBufferObject::getIndexType(size_t vertexCount) {
+  return vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
 void* VertexBufferObject::mapBufferToMemory(GLenum usageHint) const {
   if (!isDataUploaded()) {
     return nullptr;
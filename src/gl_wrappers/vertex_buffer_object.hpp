@@ -68,6 +68,43 @@ class VertexBufferObject {
    */
   void uploadDataToGPU(GLenum usageHint);
 
+  /**
+   * Uploads the given data directly to the GPU memory, without gathering it in
+   * the in-memory buffer first. Now the VBO is ready to be used.
+   *
+   * @param ptrData        Pointer to the raw data (arbitrary type)
+   * @param dataSizeBytes  Size of the data (in bytes)
+   * @param usageHint      Hint for OpenGL, how is the data intended to be used
+   * (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+   */
+  void uploadRawDataToGPU(const void* ptrData,
+                          size_t dataSizeBytes,
+                          GLenum usageHint);
+
+  /**
+   * Uploads triangle indices to the GPU memory. The buffer must be bound as
+   * GL_ELEMENT_ARRAY_BUFFER. Indices are stored on 16 bits when the indexed
+   * vertices allow it, on 32 bits otherwise.
+   *
+   * @param indices      Pointer to the indices
+   * @param indexCount   Number of indices
+   * @param vertexCount  Number of vertices the indices refer to
+   * @param usageHint    Hint for OpenGL, how is the data intended to be used
+   * (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
+   *
+   * @return Type of the uploaded indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+   */
+  GLenum uploadIndicesToGPU(const GLuint* indices,
+                            size_t indexCount,
+                            size_t vertexCount,
+                            GLenum usageHint);
+
+  /**
+   * Gets the type of indices to use for the given number of vertices
+   * (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+   */
+  static GLenum getIndexType(size_t vertexCount);
+
   /**
    * Maps buffer data to a memory pointer.
    *
@@ -0,0 +1,63 @@
+#include <filesystem>
+#include <vector>
+
+#include "gl_wrappers/ktx_file.hpp"
+#include "gl_wrappers/shader_manager.hpp"
+#include "gl_wrappers/shader_program_manager.hpp"
+#include "gl_wrappers/texture_manager.hpp"
+#include "scene/model_manager.hpp"
+
+#include "hot_reloader.hpp"
+
+namespace fs = std::filesystem;
+
+HotReloader::HotReloader() {
+  _fileWatcher.watchDirectory("models");
+  _fileWatcher.watchDirectory("shaders");
+}
+
+void HotReloader::update() {
+  for (const auto& filePath : _fileWatcher.pollChangedFiles()) {
+    _reloadFile(filePath);
+  }
+
+  ModelManager::getInstance().update();
+}
+
+void HotReloader::_reloadFile(const std::string& filePath) {
+  const fs::path path(filePath);
+  std::vector<std::string> components;
+  for (const auto& component : path) {
+    components.push_back(component.string());
+  }
+  if (components.size() < 2) {
+    return;
+  }
+
+  if (components[0] == "shaders") {
+    const auto reloadedShaders =
+        ShaderManager::getInstance().reloadShaders(filePath);
+    if (!reloadedShaders.empty()) {
+      ShaderProgramManager::getInstance().relinkProgramsUsing(reloadedShaders);
+    }
+    return;
+  }
+
+  // Model files: models/<model>/<file> and models/<model>/textures/<image>
+  if (components[0] != "models" || components.size() < 3) {
+    return;
+  }
+  const auto& modelName = components[1];
+  if (components.size() == 3 &&
+      (components[2] == "model.obj" || path.extension() == ".mtl")) {
+    ModelManager::getInstance().reloadModelAsync(modelName);
+  } else if (components.size() == 4 && components[2] == "textures") {
+    // A baked texture is named after its source image
+    auto imagePath = filePath;
+    const auto compressedSuffix = KtxFile::getCompressedFilePath("");
+    if (path.extension() == compressedSuffix) {
+      imagePath.resize(imagePath.size() - compressedSuffix.size());
+    }
+    TextureManager::getInstance().reloadTexture(imagePath);
+  }
+}
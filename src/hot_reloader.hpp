@@ -0,0 +1,42 @@
+#ifndef HOT_RELOADER_HPP
+#define HOT_RELOADER_HPP
+
+#include <string>
+
+#include "utils/file_watcher.hpp"
+
+/**
+ * Reloads the assets whose files change while the application runs, in
+ * place, without touching the rest of the scene:
+ * - models/<model>/model.obj or *.mtl: the model (geometry and materials) of
+ *   every object placing it, loaded on the asset loading threads,
+ * - models/<model>/textures/<image> (or its baked .ktx): the texture, streamed
+ *   into the same texture object,
+ * - shaders/<file>: the shaders compiled from it (including through
+ *   #include), then the programs using them are relinked.
+ *
+ * An asset that fails to load, compile or link keeps its previous version.
+ */
+class HotReloader {
+ public:
+  /**
+   * Starts watching the models and shaders directories.
+   */
+  HotReloader();
+
+  /**
+   * Starts reloading the assets whose files changed, and replaces the models
+   * done reloading. Must be called once per frame on the render thread.
+   */
+  void update();
+
+ private:
+  /**
+   * Reloads the asset the changed file belongs to, if any.
+   */
+  void _reloadFile(const std::string& filePath);
+
+  FileWatcher _fileWatcher;  // Watches the models and shaders directories
+};
+
+#endif
@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "utils/thread_pool.hpp"
+
+#include "occlusion_culler.hpp"
+
+/**
+ * Converts a time in milliseconds to a duration of the steady clock.
+ */
+static std::chrono::steady_clock::duration toDuration(double milliseconds) {
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double, std::milli>(milliseconds));
+}
+
+OcclusionCuller::OcclusionCuller(size_t width, size_t height)
+    : _width(static_cast<int>((width + 3) / 4 * 4)),
+      _height(static_cast<int>(std::max<size_t>(height, 1))),
+      _rasterizationBudget(toDuration(RASTERIZATION_BUDGET)),
+      _timeBudget(toDuration(TIME_BUDGET)) {
+  // Levels down to a single texel, each covering 2x2 texels of the previous
+  glm::ivec2 size(_width, _height);
+  while (true) {
+    _levelSizes.push_back(size);
+    _levels.emplace_back(static_cast<size_t>(size.x) * size.y, 0.0f);
+    if (size.x == 1 && size.y == 1) {
+      break;
+    }
+    size = glm::max((size + 1) / 2, glm::ivec2(1));
+  }
+}
+
+void OcclusionCuller::setTimeBudget(double rasterizationBudget,
+                                    double timeBudget) {
+  _rasterizationBudget = toDuration(rasterizationBudget);
+  _timeBudget = toDuration(timeBudget);
+}
+
+void OcclusionCuller::begin(const glm::mat4& viewProjectionMatrix) {
+  _viewProjectionMatrix = viewProjectionMatrix;
+  _occluders.clear();
+  _statistics = Statistics();
+}
+
+void OcclusionCuller::addOccluder(const std::vector<glm::vec3>& triangles,
+                                  const glm::mat4& modelMatrix,
+                                  float distance) {
+  if (triangles.empty()) {
+    return;
+  }
+  _occluders.push_back(
+      {&triangles, _viewProjectionMatrix * modelMatrix, distance});
+}
+
+void OcclusionCuller::rasterize() {
+  const auto start = Clock::now();
+  const auto rasterizationDeadline = start + _rasterizationBudget;
+  _deadline = start + _timeBudget;
+  std::fill(_levels.front().begin(), _levels.front().end(), 0.0f);
+
+  // Nearest occluders first, as they hide the most
+  std::sort(_occluders.begin(), _occluders.end(),
+            [](const Occluder& a, const Occluder& b) {
+              return a.distance < b.distance;
+            });
+
+  // By batches: set up the triangles of each occluder, then rasterize each
+  // band of rows, each band stopping before the first occluder over budget
+  auto& threadPool = ThreadPool::getInstance();
+  _screenTriangles.resize(_occluders.size());
+  _bandOccluderCounts.assign(BAND_COUNT, 0);
+  size_t batchBegin = 0;
+  while (batchBegin < _occluders.size()) {
+    const auto batchEnd =
+        std::min(batchBegin + OCCLUDER_BATCH_SIZE, _occluders.size());
+    threadPool.parallelFor(batchEnd - batchBegin, [&](size_t i) {
+      _setUpTriangles(_occluders[batchBegin + i],
+                      _screenTriangles[batchBegin + i]);
+    });
+    threadPool.parallelFor(BAND_COUNT, [&](size_t band) {
+      _rasterizeBand(band, batchBegin, batchEnd, rasterizationDeadline);
+    });
+    if (*std::min_element(_bandOccluderCounts.begin(),
+                          _bandOccluderCounts.end()) < batchEnd) {
+      _statistics.isOverBudget = true;
+      break;
+    }
+    batchBegin = batchEnd;
+  }
+
+  // The occluders every band has rasterized (the others only partly hide)
+  _statistics.occluderCount = *std::min_element(_bandOccluderCounts.begin(),
+                                                _bandOccluderCounts.end());
+  for (size_t i = 0; i < _statistics.occluderCount; i++) {
+    _statistics.triangleCount += _occluders[i].triangles->size() / 3;
+  }
+
+  _buildPyramid();
+  _testStart = Clock::now();
+  _statistics.rasterizationTime =
+      std::chrono::duration<double, std::milli>(_testStart - start).count();
+}
+
+void OcclusionCuller::_setUpTriangles(
+    const Occluder& occluder,
+    std::vector<ScreenTriangle>& screenTriangles) const {
+  screenTriangles.clear();
+  const auto& triangles = *occluder.triangles;
+  const glm::vec2 screenSize(_width, _height);
+
+  // Projects a clip space vertex on the buffer
+  const auto project = [&screenSize](const glm::vec4& vertex) {
+    const float inverseW = 1.0f / vertex.w;
+    const glm::vec2 position =
+        (glm::vec2(vertex) * inverseW * 0.5f + 0.5f) * screenSize;
+    return glm::vec3(position, inverseW);
+  };
+  const auto addTriangle = [&](const glm::vec4& a, const glm::vec4& b,
+                               const glm::vec4& c) {
+    ScreenTriangle triangle = {{project(a), project(b), project(c)}, 0, 0};
+    triangle.minY = std::min(triangle.vertices[0].y,
+                             std::min(triangle.vertices[1].y,
+                                      triangle.vertices[2].y));
+    triangle.maxY = std::max(triangle.vertices[0].y,
+                             std::max(triangle.vertices[1].y,
+                                      triangle.vertices[2].y));
+    screenTriangles.push_back(triangle);
+  };
+
+  for (size_t t = 0; t + 2 < triangles.size(); t += 3) {
+    glm::vec4 vertices[3];
+    for (int i = 0; i < 3; i++) {
+      vertices[i] = occluder.matrix * glm::vec4(triangles[t + i], 1.0f);
+    }
+
+    // Skip triangles entirely beyond a side of the frustum
+    bool isOutside = false;
+    for (int axis = 0; axis < 3 && !isOutside; axis++) {
+      isOutside = (vertices[0][axis] > vertices[0].w &&
+                   vertices[1][axis] > vertices[1].w &&
+                   vertices[2][axis] > vertices[2].w) ||
+                  (vertices[0][axis] < -vertices[0].w &&
+                   vertices[1][axis] < -vertices[1].w &&
+                   vertices[2][axis] < -vertices[2].w);
+    }
+    if (isOutside) {
+      continue;
+    }
+
+    // Clip against the near plane (z >= -w), giving up to 4 vertices
+    glm::vec4 clipped[4];
+    int clippedCount = 0;
+    for (int i = 0; i < 3; i++) {
+      const auto& a = vertices[i];
+      const auto& b = vertices[(i + 1) % 3];
+      const float aDistance = a.z + a.w;
+      const float bDistance = b.z + b.w;
+      if (aDistance >= 0.0f) {
+        clipped[clippedCount++] = a;
+      }
+      if ((aDistance >= 0.0f) != (bDistance >= 0.0f)) {
+        clipped[clippedCount++] =
+            a + (b - a) * (aDistance / (aDistance - bDistance));
+      }
+    }
+    for (int i = 2; i < clippedCount; i++) {
+      addTriangle(clipped[0], clipped[i - 1], clipped[i]);
+    }
+  }
+}
+
+void OcclusionCuller::_rasterizeBand(size_t band,
+                                     size_t firstOccluder,
+                                     size_t lastOccluder,
+                                     Clock::time_point deadline) {
+  const int rowBegin = static_cast<int>(band * _height / BAND_COUNT);
+  const int rowEnd = static_cast<int>((band + 1) * _height / BAND_COUNT);
+  for (size_t i = firstOccluder; i < lastOccluder; i++) {
+    if (i > 0 && Clock::now() > deadline) {
+      return;
+    }
+    for (const auto& triangle : _screenTriangles[i]) {
+      if (triangle.maxY >= rowBegin && triangle.minY <= rowEnd) {
+        _rasterizeTriangle(triangle, rowBegin, rowEnd);
+      }
+    }
+    _bandOccluderCounts[band]++;
+  }
+}
+
+void OcclusionCuller::_rasterizeTriangle(const ScreenTriangle& triangle,
+                                         int rowBegin,
+                                         int rowEnd) {
+  // Counterclockwise vertices, so that the inside is where all the edge
+  // functions are positive
+  glm::vec3 v0 = triangle.vertices[0];
+  glm::vec3 v1 = triangle.vertices[1];
+  glm::vec3 v2 = triangle.vertices[2];
+  float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+  if (area == 0.0f || std::isnan(area)) {
+    return;
+  }
+  if (area < 0.0f) {
+    std::swap(v1, v2);
+    area = -area;
+  }
+
+  // Edge functions (ax + by + c), each one null on an edge
+  const glm::vec3 a(v0.y - v1.y, v1.y - v2.y, v2.y - v0.y);
+  const glm::vec3 b(v1.x - v0.x, v2.x - v1.x, v0.x - v2.x);
+  const glm::vec3 c(-(a.x * v0.x + b.x * v0.y), -(a.y * v1.x + b.y * v1.y),
+                    -(a.z * v2.x + b.z * v2.y));
+
+  // Plane of the inverse depths
+  const float depthDx =
+      ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+  const float depthDy =
+      ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+  const float depth0 = v0.z - depthDx * v0.x - depthDy * v0.y;
+
+  // Pixels whose centers may be inside, by groups of 4 aligned ones (clamped
+  // before conversion, as vertices near the near plane project far away)
+  const float minX = std::max(std::min(v0.x, std::min(v1.x, v2.x)), 0.0f);
+  const float maxX = std::min(std::max(v0.x, std::max(v1.x, v2.x)),
+                              static_cast<float>(_width));
+  const int xBegin = static_cast<int>(minX) / 4 * 4;
+  const int xEnd = static_cast<int>(std::ceil(maxX));
+  const int yBegin = static_cast<int>(
+      std::max(std::floor(triangle.minY), static_cast<float>(rowBegin)));
+  const int yEnd = static_cast<int>(
+      std::min(std::ceil(triangle.maxY), static_cast<float>(rowEnd)));
+
+  auto& depths = _levels.front();
+  for (int y = yBegin; y < yEnd; y++) {
+    const float centerY = y + 0.5f;
+    float* row = &depths[static_cast<size_t>(y) * _width];
+#if defined(__SSE2__)
+    const auto rowEdges = _mm_setr_ps(b.x * centerY + c.x,
+                                      b.y * centerY + c.y,
+                                      b.z * centerY + c.z, 0.0f);
+    const auto edge0Row = _mm_shuffle_ps(rowEdges, rowEdges, 0x00);
+    const auto edge1Row = _mm_shuffle_ps(rowEdges, rowEdges, 0x55);
+    const auto edge2Row = _mm_shuffle_ps(rowEdges, rowEdges, 0xAA);
+    const auto depthRow = _mm_set1_ps(depth0 + depthDy * centerY);
+    const auto offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const auto zero = _mm_setzero_ps();
+    for (int x = xBegin; x < xEnd; x += 4) {
+      const auto centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)),
+                                      offsets);
+      const auto edge0 =
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.x), centerX), edge0Row);
+      const auto edge1 =
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.y), centerX), edge1Row);
+      const auto edge2 =
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.z), centerX), edge2Row);
+      const auto inside = _mm_and_ps(
+          _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+          _mm_cmpge_ps(edge2, zero));
+      if (_mm_movemask_ps(inside) == 0) {
+        continue;
+      }
+
+      // Keep the closest depth (outside pixels get 0, the farthest)
+      const auto depth = _mm_add_ps(
+          _mm_mul_ps(_mm_set1_ps(depthDx), centerX), depthRow);
+      _mm_storeu_ps(row + x, _mm_max_ps(_mm_loadu_ps(row + x),
+                                        _mm_and_ps(inside, depth)));
+    }
+#else
+    for (int x = xBegin; x < xEnd; x++) {
+      const float centerX = x + 0.5f;
+      if (a.x * centerX + b.x * centerY + c.x >= 0.0f &&
+          a.y * centerX + b.y * centerY + c.y >= 0.0f &&
+          a.z * centerX + b.z * centerY + c.z >= 0.0f) {
+        row[x] = std::max(row[x], depth0 + depthDx * centerX +
+                                      depthDy * centerY);
+      }
+    }
+#endif
+  }
+}
+
+void OcclusionCuller::_buildPyramid() {
+  // Each texel keeps the farthest depth (smallest inverse depth) of the 2x2
+  // texels it covers, clamped at the edges of odd sizes
+  for (size_t level = 1; level < _levels.size(); level++) {
+    const auto& sourceSize = _levelSizes[level - 1];
+    const auto& size = _levelSizes[level];
+    const auto& source = _levels[level - 1];
+    auto& destination = _levels[level];
+    for (int y = 0; y < size.y; y++) {
+      const int y0 = 2 * y;
+      const int y1 = std::min(2 * y + 1, sourceSize.y - 1);
+      for (int x = 0; x < size.x; x++) {
+        const int x0 = 2 * x;
+        const int x1 = std::min(2 * x + 1, sourceSize.x - 1);
+        destination[static_cast<size_t>(y) * size.x + x] = std::min(
+            std::min(source[static_cast<size_t>(y0) * sourceSize.x + x0],
+                     source[static_cast<size_t>(y0) * sourceSize.x + x1]),
+            std::min(source[static_cast<size_t>(y1) * sourceSize.x + x0],
+                     source[static_cast<size_t>(y1) * sourceSize.x + x1]));
+      }
+    }
+  }
+}
+
+bool OcclusionCuller::testBox(const glm::vec3& aabbMin,
+                              const glm::vec3& aabbMax) {
+  if (_statistics.skippedCount > 0 || !_isWithinTestBudget()) {
+    _statistics.skippedCount++;
+    _statistics.isOverBudget = true;
+    return true;
+  }
+  _statistics.testedCount++;
+  if (_occluders.empty()) {
+    return true;
+  }
+
+  // Screen rectangle and closest depth of the box, visible if it crosses the
+  // near plane
+  glm::vec2 minPosition(FLT_MAX), maxPosition(-FLT_MAX);
+  float maxDepth = 0.0f;
+  for (int i = 0; i < 8; i++) {
+    const glm::vec3 corner(i & 1 ? aabbMax.x : aabbMin.x,
+                           i & 2 ? aabbMax.y : aabbMin.y,
+                           i & 4 ? aabbMax.z : aabbMin.z);
+    const auto vertex = _viewProjectionMatrix * glm::vec4(corner, 1.0f);
+    if (vertex.z < -vertex.w || vertex.w <= 0.0f) {
+      return true;
+    }
+    const float inverseW = 1.0f / vertex.w;
+    const glm::vec2 position = glm::vec2(vertex) * inverseW;
+    minPosition = glm::min(minPosition, position);
+    maxPosition = glm::max(maxPosition, position);
+    maxDepth = std::max(maxDepth, inverseW);
+  }
+  const glm::vec2 screenSize(_width, _height);
+  minPosition = (minPosition * 0.5f + 0.5f) * screenSize;
+  maxPosition = (maxPosition * 0.5f + 0.5f) * screenSize;
+  if (maxPosition.x < 0.0f || maxPosition.y < 0.0f ||
+      minPosition.x >= screenSize.x || minPosition.y >= screenSize.y) {
+    return true;  // Off screen, left to the frustum culling
+  }
+
+  // Texels covered by the box, in the level where they are few enough
+  glm::ivec2 minTexel = glm::max(glm::ivec2(glm::floor(minPosition)), 0);
+  glm::ivec2 maxTexel =
+      glm::min(glm::ivec2(glm::floor(maxPosition)), glm::ivec2(_width - 1,
+                                                               _height - 1));
+  size_t level = 0;
+  while (level + 1 < _levels.size() &&
+         glm::any(glm::greaterThanEqual(maxTexel - minTexel,
+                                        glm::ivec2(MAX_TESTED_TEXELS)))) {
+    minTexel /= 2;
+    maxTexel /= 2;
+    level++;
+  }
+
+  // Hidden if the farthest occluder of every texel is closer than the box
+  const auto& depths = _levels[level];
+  const int levelWidth = _levelSizes[level].x;
+  for (int y = minTexel.y; y <= maxTexel.y; y++) {
+    for (int x = minTexel.x; x <= maxTexel.x; x++) {
+      if (depths[static_cast<size_t>(y) * levelWidth + x] <= maxDepth) {
+        return true;
+      }
+    }
+  }
+  _statistics.occludedCount++;
+  return false;
+}
+
+bool OcclusionCuller::_isWithinTestBudget() {
+  if (_statistics.testedCount % TEST_BATCH_SIZE != 0) {
+    return true;
+  }
+  const auto now = Clock::now();
+  _statistics.testTime =
+      std::chrono::duration<double, std::milli>(now - _testStart).count();
+  return now <= _deadline;
+}
+
+const OcclusionCuller::Statistics& OcclusionCuller::getStatistics() const {
+  return _statistics;
+}
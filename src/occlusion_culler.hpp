@@ -0,0 +1,193 @@
+#ifndef OCCLUSION_CULLER_HPP
+#define OCCLUSION_CULLER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * Tests bounding boxes against the depth of occluders (low-poly proxies of
+ * large objects) rasterized on the CPU into a small depth buffer, so that
+ * objects hidden behind them aren't drawn.
+ *
+ * The buffer stores the inverse of the view depth (larger is closer, 0 is
+ * empty), which interpolates linearly across triangles. Occluders are
+ * rasterized nearest first, by batches, in horizontal bands by the threads of
+ * the shared thread pool, 4 pixels at a time with SSE. A pyramid of the
+ * farthest depths of 2x2 texels then lets a box be tested against a few texels
+ * whatever its size on screen. A texel is covered when its center is.
+ *
+ * The time budget covers both rasterizing the occluders and testing the
+ * boxes, from the start of rasterize(). Each band stops rasterizing once the
+ * rasterization budget is spent (checked before each occluder), and boxes
+ * tested once the whole budget is spent are reported visible untested (checked
+ * every TEST_BATCH_SIZE boxes). Both only make culling less effective. A test
+ * costs about 50 ns (8 corners projected and at most 4x4 texels read).
+ */
+class OcclusionCuller {
+ public:
+  /**
+   * Counts and timing of the last frame.
+   */
+  struct Statistics {
+    size_t occluderCount = 0;        // Occluders rasterized in every band
+    size_t triangleCount = 0;        // Triangles of the rasterized occluders
+    size_t testedCount = 0;          // Boxes tested
+    size_t skippedCount = 0;         // Boxes reported visible over budget
+    size_t occludedCount = 0;        // Boxes found hidden
+    double rasterizationTime = 0.0;  // In milliseconds, with the pyramid
+    double testTime = 0.0;  // In milliseconds, as of the last budget check
+    bool isOverBudget = false;  // Whether occluders or boxes have been skipped
+  };
+
+  /**
+   * Creates the culler and its depth buffer.
+   * @param width   Width of the depth buffer (rounded up to a multiple of 4)
+   * @param height  Height of the depth buffer
+   */
+  explicit OcclusionCuller(size_t width = DEFAULT_WIDTH,
+                           size_t height = DEFAULT_HEIGHT);
+
+  /**
+   * Sets the time budget (RASTERIZATION_BUDGET and TIME_BUDGET by default).
+   * @param rasterizationBudget  Time after which no more occluders are
+   * rasterized, in milliseconds from the start of rasterize()
+   * @param timeBudget           Time after which no more boxes are tested, in
+   * milliseconds from the start of rasterize()
+   */
+  void setTimeBudget(double rasterizationBudget, double timeBudget);
+
+  /**
+   * Starts a frame, removing the occluders of the previous one.
+   * @param viewProjectionMatrix  Projection matrix times view matrix
+   */
+  void begin(const glm::mat4& viewProjectionMatrix);
+
+  /**
+   * Adds an occluder to rasterize.
+   * @param triangles    Vertices of the triangles (3 per triangle, must stay
+   * valid until rasterize() returns)
+   * @param modelMatrix  Transformation of the vertices to world coordinates
+   * @param distance     Distance to the viewer (nearest occluders are
+   * rasterized first)
+   */
+  void addOccluder(const std::vector<glm::vec3>& triangles,
+                   const glm::mat4& modelMatrix,
+                   float distance);
+
+  /**
+   * Rasterizes the occluders into the depth buffer, then builds its pyramid.
+   */
+  void rasterize();
+
+  /**
+   * Tests whether a box may be visible, i.e. isn't entirely behind the
+   * rasterized occluders (counted in the statistics). Once the time budget is
+   * spent, returns true without testing.
+   * @param aabbMin  Minimal corner of the box (in world coordinates)
+   * @param aabbMax  Maximal corner of the box (in world coordinates)
+   */
+  bool testBox(const glm::vec3& aabbMin, const glm::vec3& aabbMax);
+
+  /**
+   * Gets the statistics of the current frame.
+   */
+  const Statistics& getStatistics() const;
+
+  // Default size of the depth buffer
+  static constexpr size_t DEFAULT_WIDTH = 256;
+  static constexpr size_t DEFAULT_HEIGHT = 128;
+  // Number of bands of rows rasterized in parallel
+  static constexpr size_t BAND_COUNT = 8;
+  // Number of occluders set up in parallel before rasterizing them
+  static constexpr size_t OCCLUDER_BATCH_SIZE = 16;
+  // Default time after which no more occluders are rasterized, in milliseconds
+  // from the start of rasterize() (the first one always is)
+  static constexpr double RASTERIZATION_BUDGET = 0.6;
+  // Default time after which no more boxes are tested, in milliseconds from
+  // the start of rasterize()
+  static constexpr double TIME_BUDGET = 1.0;
+  // Number of boxes tested between checks of the time budget
+  static constexpr size_t TEST_BATCH_SIZE = 64;
+  // Maximal size (in texels) of the side of the area tested for a box, the
+  // pyramid level being chosen accordingly
+  static constexpr int MAX_TESTED_TEXELS = 4;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Occluder to rasterize.
+   */
+  struct Occluder {
+    const std::vector<glm::vec3>* triangles;  // 3 vertices per triangle
+    glm::mat4 matrix;                         // To clip coordinates
+    float distance;                           // To the viewer
+  };
+
+  /**
+   * Triangle projected on the depth buffer.
+   */
+  struct ScreenTriangle {
+    glm::vec3 vertices[3];  // In pixels, and inverse depth
+    float minY, maxY;       // Rows covered
+  };
+
+  /**
+   * Clips the triangles of an occluder against the near plane and projects
+   * them on the depth buffer.
+   */
+  void _setUpTriangles(const Occluder& occluder,
+                       std::vector<ScreenTriangle>& screenTriangles) const;
+
+  /**
+   * Rasterizes the triangles of some occluders into a band of rows, until the
+   * deadline (counting them in the band's occluders).
+   * @param band           Index of the band
+   * @param firstOccluder  First occluder to rasterize
+   * @param lastOccluder   Occluder after the last one to rasterize
+   * @param deadline       Time after which no more occluders are rasterized
+   * (but the first of the frame)
+   */
+  void _rasterizeBand(size_t band,
+                      size_t firstOccluder,
+                      size_t lastOccluder,
+                      Clock::time_point deadline);
+
+  /**
+   * Rasterizes a triangle into some rows of the depth buffer.
+   */
+  void _rasterizeTriangle(const ScreenTriangle& triangle,
+                          int rowBegin,
+                          int rowEnd);
+
+  /**
+   * Builds the levels of the pyramid above the depth buffer.
+   */
+  void _buildPyramid();
+
+  /**
+   * Checks the time budget every TEST_BATCH_SIZE tested boxes (updating the
+   * test time), telling whether boxes may still be tested.
+   */
+  bool _isWithinTestBudget();
+
+  int _width;                        // Of the depth buffer
+  int _height;                       // Of the depth buffer
+  glm::mat4 _viewProjectionMatrix;   // Of the current frame
+  std::vector<Occluder> _occluders;  // Occluders of the current frame
+  std::vector<std::vector<ScreenTriangle>>
+      _screenTriangles;  // By occluder, nearest first
+  std::vector<std::vector<float>> _levels;  // Depth buffer, then pyramid
+  std::vector<glm::ivec2> _levelSizes;      // Sizes of the levels
+  std::vector<size_t> _bandOccluderCounts;  // Occluders rasterized by band
+  Clock::duration _rasterizationBudget;     // See setTimeBudget()
+  Clock::duration _timeBudget;              // See setTimeBudget()
+  Clock::time_point _testStart;             // End of the rasterization
+  Clock::time_point _deadline;              // End of the time budget
+  Statistics _statistics;                   // Of the current frame
+};
+
+#endif
@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "shader_uniforms.hpp"
+#include "utils/sort_utils.hpp"
+
+#include "render_queue.hpp"
+
+// Bits of the sort key fields
+static const int PASS_SHIFT = 62;
+static const int PROGRAM_SHIFT = 56;
+static const int POOL_SHIFT = 53;
+static const int TEXTURE_SHIFT = 37;
+static const int MATERIAL_SHIFT = 24;
+static const int LOD_SHIFT = 21;
+static const uint64_t PROGRAM_MASK = 0x3F;
+static const uint64_t POOL_MASK = 0x7;
+static const uint64_t TEXTURE_MASK = 0xFFFF;
+static const uint64_t MATERIAL_MASK = 0x1FFF;
+static const uint64_t LOD_MASK = 0x7;
+static const uint64_t DEPTH_MASK = 0x1FFFFF;
+
+using shader_uniforms::MainUniforms;
+
+/**
+ * Gets the 21 most significant bits of a non-negative float (without the
+ * sign), which sort like the float itself.
+ */
+static uint64_t getDepthBits(float depth) {
+  const float clampedDepth = std::max(depth, 0.0f);
+  uint32_t bits;
+  memcpy(&bits, &clampedDepth, sizeof(bits));
+  return (bits >> 10) & DEPTH_MASK;
+}
+
+/**
+ * Checks if materials set the same uniforms.
+ */
+static bool haveSameUniforms(const shader_structs::Material& material,
+                             const shader_structs::Material& otherMaterial) {
+  return material.ambient == otherMaterial.ambient &&
+         material.diffuse == otherMaterial.diffuse &&
+         material.specular == otherMaterial.specular &&
+         material.shininess == otherMaterial.shininess;
+}
+
+RenderQueue::RenderQueue() {
+  // Matrices take one attribute per column
+  _instanceLayout.stride = sizeof(ObjectMatrices);
+  for (GLuint column = 0; column < 4; column++) {
+    _instanceLayout.attributes.push_back(
+        {VertexLayout::ATTRIBUTE_INSTANCE_MODEL_MATRIX + column, 4, GL_FLOAT,
+         GL_FALSE,
+         offsetof(ObjectMatrices, modelMatrix) + column * sizeof(glm::vec4)});
+  }
+  for (GLuint column = 0; column < 3; column++) {
+    _instanceLayout.attributes.push_back(
+        {VertexLayout::ATTRIBUTE_INSTANCE_NORMAL_MATRIX + column, 3, GL_FLOAT,
+         GL_FALSE,
+         offsetof(ObjectMatrices, normalMatrix) + column * sizeof(glm::vec3)});
+  }
+}
+
+RenderQueue::~RenderQueue() {
+  _instanceBuffer.deleteVBO();
+  _drawCommandBuffer.deleteVBO();
+}
+
+bool RenderQueue::isMultiDrawIndirectSupported() {
+  return GLAD_GL_VERSION_4_3 != 0;
+}
+
+size_t RenderQueue::Statistics::getSkippedCount() const {
+  return programBindsSkipped + textureBindsSkipped + vertexArrayBindsSkipped +
+         materialUploadsSkipped;
+}
+
+uint32_t RenderQueue::addObject(const glm::mat4& modelMatrix) {
+  _objects.push_back(
+      {modelMatrix, glm::transpose(glm::inverse(glm::mat3(modelMatrix)))});
+  return static_cast<uint32_t>(_objects.size() - 1);
+}
+
+void RenderQueue::submit(RenderPass renderPass,
+                         ShaderProgram& shaderProgram,
+                         const SceneObjectMaterial& material,
+                         uint32_t objectIndex,
+                         size_t lodLevel,
+                         float depth) {
+  // Programs are few, a linear search is the fastest
+  auto program =
+      std::find(_shaderPrograms.begin(), _shaderPrograms.end(), &shaderProgram);
+  if (program == _shaderPrograms.end()) {
+    if (_shaderPrograms.size() > PROGRAM_MASK) {
+      throw std::runtime_error("Too many shader programs in the render queue");
+    }
+    program = _shaderPrograms.insert(program, &shaderProgram);
+  }
+  const uint64_t programIndex = program - _shaderPrograms.begin();
+
+  // Textures only matter to the main pass
+  uint64_t textureID = 0;
+  if (renderPass == RenderPass::Main) {
+    const auto texture = _getBoundTexture(material);
+    textureID = texture != nullptr ? texture->getID() : 0;
+  }
+
+  const uint64_t sortKey =
+      (static_cast<uint64_t>(renderPass) << PASS_SHIFT) |
+      (programIndex << PROGRAM_SHIFT) |
+      ((material.geometry.pool->getIndex() & POOL_MASK) << POOL_SHIFT) |
+      ((textureID & TEXTURE_MASK) << TEXTURE_SHIFT) |
+      ((static_cast<uint64_t>(material.id) & MATERIAL_MASK) << MATERIAL_SHIFT) |
+      (std::min<uint64_t>(lodLevel, LOD_MASK) << LOD_SHIFT) |
+      getDepthBits(depth);
+  _packets.push_back(
+      {sortKey, &material, objectIndex, static_cast<uint32_t>(lodLevel)});
+}
+
+void RenderQueue::sort() {
+  sort_utils::radixSort(_packets, _sortingPackets,
+                        [](const DrawPacket& packet) { return packet.sortKey; });
+}
+
+void RenderQueue::execute() {
+  if (_packets.empty()) {
+    return;
+  }
+
+  // Stream the matrices of all the instances (and the draw commands) at once
+  const auto useMultiDraw = isMultiDrawIndirectSupported();
+  _buildBatches(useMultiDraw);
+  if (_instanceBuffer.getBufferID() == 0) {
+    _instanceBuffer.createVBO();
+  }
+  _instanceBuffer.bindVBO();
+  _instanceBuffer.uploadRawDataToGPU(
+      _instances.data(), _instances.size() * sizeof(ObjectMatrices),
+      GL_STREAM_DRAW);
+  if (useMultiDraw) {
+    if (_drawCommandBuffer.getBufferID() == 0) {
+      _drawCommandBuffer.createVBO();
+    }
+    _drawCommandBuffer.bindVBO(GL_DRAW_INDIRECT_BUFFER);
+    _drawCommandBuffer.uploadRawDataToGPU(
+        _drawCommands.data(),
+        _drawCommands.size() * sizeof(DrawElementsIndirectCommand),
+        GL_STREAM_DRAW);
+  }
+
+  // State in effect (nothing is assumed at first)
+  const ShaderProgram* currentProgram = nullptr;
+  const SceneObjectMaterial* currentMaterial = nullptr;
+  GLuint currentTextureID = 0;
+  int currentMissingTexture = -1;
+  GLuint currentVAO = 0;
+
+  for (size_t batchIndex = 0; batchIndex < _batches.size();) {
+    const auto& batch = _batches[batchIndex];
+    const auto& packet = _packets[batch.firstPacket];
+    const auto renderPass =
+        static_cast<RenderPass>(packet.sortKey >> PASS_SHIFT);
+    auto& program =
+        *_shaderPrograms[(packet.sortKey >> PROGRAM_SHIFT) & PROGRAM_MASK];
+    const auto& material = *packet.material;
+
+    // Following batches sharing the state are drawn by the same multi-draw
+    size_t batchCount = 1;
+    while (useMultiDraw && batchIndex + batchCount < _batches.size() &&
+           _canMergeBatches(batch, _batches[batchIndex + batchCount])) {
+      batchCount++;
+    }
+
+    if (&program != currentProgram) {
+      program.useProgram();
+      _statistics.programBinds++;
+      currentProgram = &program;
+
+      // Uniforms are per program
+      currentMaterial = nullptr;
+      currentMissingTexture = -1;
+      if (renderPass == RenderPass::Main) {
+        program.set(MainUniforms::albedoSampler, 0);
+      }
+    } else {
+      _statistics.programBindsSkipped++;
+    }
+
+    if (renderPass == RenderPass::Main) {
+      if (&material != currentMaterial) {
+        material.material.setUniform(program, MainUniforms::material);
+        _statistics.materialUploads++;
+        currentMaterial = &material;
+      } else {
+        _statistics.materialUploadsSkipped++;
+      }
+
+      const auto texture = _getBoundTexture(material);
+      const int missingTexture = texture == nullptr;
+      if (missingTexture != currentMissingTexture) {
+        program.set(MainUniforms::missingTexture, texture == nullptr);
+        currentMissingTexture = missingTexture;
+      }
+      if (texture != nullptr) {
+        if (texture->getID() != currentTextureID) {
+          texture->bind(0);
+          _statistics.textureBinds++;
+          currentTextureID = texture->getID();
+        } else {
+          _statistics.textureBindsSkipped++;
+        }
+      }
+    }
+
+    // All the meshes of a pool share its VAO
+    const auto& pool = *material.geometry.pool;
+    if (pool.getVertexArrayID() != currentVAO) {
+      glBindVertexArray(pool.getVertexArrayID());
+      _statistics.vertexArrayBinds++;
+      currentVAO = pool.getVertexArrayID();
+
+      // Draw commands select their instances (the instance buffer is still
+      // bound)
+      if (useMultiDraw) {
+        _instanceLayout.apply(0, 1);
+      }
+    } else {
+      _statistics.vertexArrayBindsSkipped++;
+    }
+
+    if (useMultiDraw) {
+      glMultiDrawElementsIndirect(
+          GL_TRIANGLES, pool.getIndexType(),
+          reinterpret_cast<const void*>(batchIndex *
+                                        sizeof(DrawElementsIndirectCommand)),
+          static_cast<GLsizei>(batchCount), 0);
+    } else {
+      // Point the instance attributes at the batch's matrices
+      _instanceLayout.apply(batch.firstInstance * sizeof(ObjectMatrices), 1);
+      material.drawElements(packet.lodLevel,
+                            static_cast<GLsizei>(batch.instanceCount));
+    }
+
+    _statistics.drawCount++;
+    _statistics.meshCount += batchCount;
+    for (size_t i = 0; i < batchCount; i++) {
+      _statistics.instanceCount += _batches[batchIndex + i].instanceCount;
+    }
+    batchIndex += batchCount;
+  }
+
+  glBindVertexArray(0);
+  _instanceBuffer.unbindVBO();
+  if (useMultiDraw) {
+    _drawCommandBuffer.unbindVBO();
+  }
+}
+
+void RenderQueue::clear() {
+  _packets.clear();
+  _objects.clear();
+}
+
+void RenderQueue::resetStatistics() {
+  _statistics = Statistics();
+}
+
+const RenderQueue::Statistics& RenderQueue::getStatistics() const {
+  return _statistics;
+}
+
+void RenderQueue::_buildBatches(bool buildDrawCommands) {
+  _batches.clear();
+  _instances.clear();
+
+  // Packets differing only by their depth draw the same mesh the same way
+  for (size_t i = 0; i < _packets.size(); i++) {
+    const auto& packet = _packets[i];
+    if (_batches.empty() || !_isSameMesh(packet, _batches.back())) {
+      _batches.push_back({i, 0, _instances.size()});
+    }
+    _batches.back().instanceCount++;
+
+    // Include the position transform of the material's geometry
+    const auto& object = _objects[packet.objectIndex];
+    _instances.push_back(
+        {object.modelMatrix * packet.material->positionTransform,
+         object.normalMatrix});
+  }
+
+  _drawCommands.clear();
+  if (buildDrawCommands) {
+    for (const auto& batch : _batches) {
+      const auto& packet = _packets[batch.firstPacket];
+      _drawCommands.push_back(packet.material->getDrawCommand(
+          packet.lodLevel, static_cast<GLuint>(batch.instanceCount),
+          static_cast<GLuint>(batch.firstInstance)));
+    }
+  }
+}
+
+bool RenderQueue::_isSameMesh(const DrawPacket& packet,
+                              const Batch& batch) const {
+  const auto& firstPacket = _packets[batch.firstPacket];
+  return (firstPacket.sortKey >> LOD_SHIFT) == (packet.sortKey >> LOD_SHIFT) &&
+         firstPacket.material == packet.material &&
+         firstPacket.lodLevel == packet.lodLevel;
+}
+
+bool RenderQueue::_canMergeBatches(const Batch& batch,
+                                   const Batch& nextBatch) const {
+  // Same pass, program, pool and texture
+  const auto& packet = _packets[batch.firstPacket];
+  const auto& nextPacket = _packets[nextBatch.firstPacket];
+  if ((packet.sortKey >> TEXTURE_SHIFT) !=
+      (nextPacket.sortKey >> TEXTURE_SHIFT)) {
+    return false;
+  }
+
+  // Materials of the main pass are uniforms
+  const auto renderPass = static_cast<RenderPass>(packet.sortKey >> PASS_SHIFT);
+  return renderPass != RenderPass::Main ||
+         haveSameUniforms(packet.material->material,
+                          nextPacket.material->material);
+}
+
+const Texture* RenderQueue::_getBoundTexture(
+    const SceneObjectMaterial& material) {
+  if (material.texture == nullptr) {
+    return nullptr;
+  }
+
+  // Textures still streaming in are replaced by the placeholder
+  return material.texture->isLoaded() ? material.texture.get()
+                                      : Texture::getMissingTexture().get();
+}
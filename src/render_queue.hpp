@@ -0,0 +1,201 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "gl_wrappers/shader_program.hpp"
+#include "gl_wrappers/vertex_buffer_object.hpp"
+#include "render_pass.hpp"
+#include "scene/scene_object_material.hpp"
+#include "scene/vertex_layout.hpp"
+
+/**
+ * Queue of the draws of a render pass. Objects submit compact draw packets,
+ * which are sorted by a 64 bits key so that draws sharing the same GL state
+ * end up next to each other, then executed while skipping the state changes
+ * that are already in effect.
+ *
+ * Sort key, from the most significant bits:
+ * - render pass (2 bits)
+ * - shader program (6 bits, index in the order programs were first submitted)
+ * - geometry pool (3 bits, index in the arena, each pool having its VAO)
+ * - texture (16 bits, OpenGL ID, 0 outside of the main pass)
+ * - material (13 bits, identifier)
+ * - level of detail (3 bits)
+ * - depth (21 bits, distance to the viewer, so that draws sharing a material
+ *   are drawn front to back)
+ *
+ * Packets sharing everything but the depth (i.e. objects sharing a mesh) are
+ * drawn at once, as instances whose matrices are streamed through a per
+ * instance vertex buffer. Where indirect multi-draw is supported (OpenGL 4.3),
+ * consecutive meshes of a pool sharing the same texture and material uniforms
+ * are drawn by a single glMultiDrawElementsIndirect call.
+ *
+ * Uniforms are set through the generated handles of the programs of each
+ * pass (see shader_uniforms.hpp), so executing allocates no strings and looks
+ * up no names.
+ */
+class RenderQueue {
+ public:
+  RenderQueue();
+  ~RenderQueue();
+
+  // No copy constructor allowed
+  RenderQueue(const RenderQueue&) = delete;
+
+  // No copy assignment allowed
+  RenderQueue& operator=(const RenderQueue&) = delete;
+
+  /**
+   * Counts of the draws and state changes executed, and of the redundant
+   * state changes skipped.
+   */
+  struct Statistics {
+    size_t drawCount = 0;      // Draw calls issued (multi-draws count once)
+    size_t meshCount = 0;      // Meshes drawn (i.e. instanced draws)
+    size_t instanceCount = 0;  // Instances drawn (i.e. packets)
+    size_t programBinds = 0;
+    size_t programBindsSkipped = 0;
+    size_t textureBinds = 0;
+    size_t textureBindsSkipped = 0;
+    size_t vertexArrayBinds = 0;
+    size_t vertexArrayBindsSkipped = 0;
+    size_t materialUploads = 0;  // Material uniforms sent
+    size_t materialUploadsSkipped = 0;
+
+    /**
+     * Gets the total number of state changes skipped.
+     */
+    size_t getSkippedCount() const;
+  };
+
+  /**
+   * Checks if draws can be submitted by glMultiDrawElementsIndirect, with
+   * their own base instance (OpenGL 4.3).
+   */
+  static bool isMultiDrawIndirectSupported();
+
+  /**
+   * Adds an object drawn by the next submitted packets.
+   * @param modelMatrix Model matrix of the object
+   * @return Index of the object, to submit its packets with
+   */
+  uint32_t addObject(const glm::mat4& modelMatrix);
+
+  /**
+   * Submits the draw of a material of an object.
+   * @param renderPass     Render pass the draw belongs to
+   * @param shaderProgram  Program to draw with
+   * @param material       Material to draw (must outlive the execution)
+   * @param objectIndex    Index of the object, as returned by addObject()
+   * @param lodLevel       Level of detail to draw
+   * @param depth          Distance from the viewer to the object
+   */
+  void submit(RenderPass renderPass,
+              ShaderProgram& shaderProgram,
+              const SceneObjectMaterial& material,
+              uint32_t objectIndex,
+              size_t lodLevel,
+              float depth);
+
+  /**
+   * Sorts the submitted packets by their key.
+   */
+  void sort();
+
+  /**
+   * Draws the packets in their current order, instancing consecutive packets
+   * of the same mesh and skipping redundant state changes (the state left by
+   * anything else is not relied upon).
+   */
+  void execute();
+
+  /**
+   * Removes the submitted packets and objects (keeping their storage).
+   */
+  void clear();
+
+  /**
+   * Resets the statistics, accumulated over all the executions since the
+   * last reset (e.g. each frame).
+   */
+  void resetStatistics();
+
+  /**
+   * Gets the statistics accumulated since the last reset.
+   */
+  const Statistics& getStatistics() const;
+
+ private:
+  /**
+   * Draw of a material of an object.
+   */
+  struct DrawPacket {
+    uint64_t sortKey;
+    const SceneObjectMaterial* material;
+    uint32_t objectIndex;  // Index in _objects
+    uint32_t lodLevel;
+  };
+
+  /**
+   * Matrices of an object, computed once for all its packets. They're also
+   * the per instance attributes of the draws.
+   */
+  struct ObjectMatrices {
+    glm::mat4 modelMatrix;
+    glm::mat3 normalMatrix;
+  };
+
+  /**
+   * Consecutive packets drawn at once.
+   */
+  struct Batch {
+    size_t firstPacket;    // Index of the first packet in _packets
+    size_t instanceCount;  // Number of packets
+    size_t firstInstance;  // Index of the first instance in _instances
+  };
+
+  /**
+   * Groups the sorted packets into batches, and gathers their instances'
+   * matrices in the same order.
+   * @param buildDrawCommands Whether to build the draw command of each batch
+   */
+  void _buildBatches(bool buildDrawCommands);
+
+  /**
+   * Checks if a packet draws the mesh of a batch, the same way.
+   */
+  bool _isSameMesh(const DrawPacket& packet, const Batch& batch) const;
+
+  /**
+   * Checks if the next batch can be drawn by the same multi-draw as a batch.
+   */
+  bool _canMergeBatches(const Batch& batch, const Batch& nextBatch) const;
+
+  /**
+   * Gets the texture a material binds (the placeholder while it's streaming
+   * in), or nullptr if it has none.
+   */
+  static const Texture* _getBoundTexture(const SceneObjectMaterial& material);
+
+  std::vector<DrawPacket> _packets;         // Submitted packets
+  std::vector<DrawPacket> _sortingPackets;  // Scratch buffer of the sort
+  std::vector<ObjectMatrices> _objects;     // Submitted objects
+  std::vector<Batch> _batches;              // Batches of the execution
+  std::vector<ObjectMatrices> _instances;   // Instances, in batches order
+  VertexBufferObject _instanceBuffer;       // Instances streamed to the GPU
+  std::vector<DrawElementsIndirectCommand>
+      _drawCommands;                        // Commands of the batches
+  VertexBufferObject _drawCommandBuffer;  // Commands streamed to the GPU
+  VertexLayout _instanceLayout;             // Attributes of an instance
+  std::vector<ShaderProgram*>
+      _shaderPrograms;  // Programs submitted, by index in the sort keys
+  Statistics _statistics;  // Statistics since the last reset
+};
+
+#endif
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <stdexcept>
@@ -9,9 +12,24 @@
 #include "gl_wrappers/shader_program_manager.hpp"
 #include "scene/scene.hpp"
 #include "shader_structs/directional_light.hpp"
+#include "shader_uniforms.hpp"
+#include "utils/profiler.hpp"
 
 #include "renderer.hpp"
 
+// Layout of the cascaded shadows uniform block (std140: array elements are
+// aligned to 16 bytes)
+static const GLsizeiptr CASCADE_SPLITS_OFFSET = sizeof(glm::vec4);
+static const GLsizeiptr CASCADE_MATRICES_OFFSET =
+    CASCADE_SPLITS_OFFSET +
+    CascadedShadowMaps::MAX_CASCADES * sizeof(glm::vec4);
+
+// Maps clip coordinates to shadow map coordinates ([-1;1] to [0;1])
+static const glm::mat4 SHADOW_MAP_BIAS_MATRIX(0.5f, 0.0f, 0.0f, 0.0f,
+                                              0.0f, 0.5f, 0.0f, 0.0f,
+                                              0.0f, 0.0f, 0.5f, 0.0f,
+                                              0.5f, 0.5f, 0.5f, 1.0f);
+
 Renderer::Renderer(const App& app, const Scene& scene)
     : _app(app), _scene(scene) {
   // Depth test (closest will be displayed)
@@ -29,14 +47,30 @@ Renderer::Renderer(const App& app, const Scene& scene)
                _scene.backgroundColor.b, _scene.backgroundColor.a);
 
   // Load shaders
-  _loadMainShaderProgram();
-  _loadDepthShaderProgram();
+  {
+    Profiler::ScopedPhase phase("renderer", "mainShaderProgram");
+    _loadMainShaderProgram();
+  }
+  {
+    Profiler::ScopedPhase phase("renderer", "depthShaderProgram");
+    _loadDepthShaderProgram();
+  }
+  {
+    Profiler::ScopedPhase phase("renderer", "cascadeShaderProgram");
+    _loadCascadeShaderProgram();
+  }
 
   // Create UBOs for shaders structs
-  _createShaderStructsUBOs();
+  {
+    Profiler::ScopedPhase phase("renderer", "uniformBuffers");
+    _createShaderStructsUBOs();
+  }
 
   // Create shadows framebuffers
-  _createDepthFBOs();
+  {
+    Profiler::ScopedPhase phase("renderer", "shadowFramebuffers");
+    _createDepthFBOs();
+  }
 }
 
 void Renderer::_loadMainShaderProgram() {
@@ -50,18 +84,15 @@ void Renderer::_loadMainShaderProgram() {
                                  "shaders/main.vert");
   shaderManager.loadFragmentShader(ShaderProgramKeys::main(),
                                    "shaders/main.frag");
-  shaderManager.loadGeometryShader(ShaderProgramKeys::main(),
-                                   "shaders/main.geom");
 
   // Add loaded shaders to the program
   mainProgram.addShaderToProgram(
       shaderManager.getVertexShader(ShaderProgramKeys::main()));
   mainProgram.addShaderToProgram(
       shaderManager.getFragmentShader(ShaderProgramKeys::main()));
-  mainProgram.addShaderToProgram(
-      shaderManager.getGeometryShader(ShaderProgramKeys::main()));
 
-  // Link program
+  // Link program (resolving the locations of its uniform handles)
+  mainProgram.setUniformHandles<shader_uniforms::MainUniforms>();
   mainProgram.linkProgram();
 }
 
@@ -74,23 +105,44 @@ void Renderer::_loadDepthShaderProgram() {
   ShaderManager& shaderManager = ShaderManager::getInstance();
   shaderManager.loadVertexShader(ShaderProgramKeys::depth(),
                                  "shaders/depth.vert");
-  shaderManager.loadGeometryShader(ShaderProgramKeys::depth(),
-                                   "shaders/depth.geom");
   shaderManager.loadFragmentShader(ShaderProgramKeys::depth(),
                                    "shaders/depth.frag");
 
   // Add loaded shaders to the program
   depthProgram.addShaderToProgram(
       shaderManager.getVertexShader(ShaderProgramKeys::depth()));
-  depthProgram.addShaderToProgram(
-      shaderManager.getGeometryShader(ShaderProgramKeys::depth()));
   depthProgram.addShaderToProgram(
       shaderManager.getFragmentShader(ShaderProgramKeys::depth()));
 
-  // Link program
+  // Link program (resolving the locations of its uniform handles)
+  depthProgram.setUniformHandles<shader_uniforms::DepthUniforms>();
   depthProgram.linkProgram();
 }
 
+void Renderer::_loadCascadeShaderProgram() {
+  // Create shader program
+  auto& cascadeProgram =
+      ShaderProgramManager::getInstance().createShaderProgram(
+          ShaderProgramKeys::cascade());
+
+  // Load shaders
+  ShaderManager& shaderManager = ShaderManager::getInstance();
+  shaderManager.loadVertexShader(ShaderProgramKeys::cascade(),
+                                 "shaders/cascade.vert");
+  shaderManager.loadFragmentShader(ShaderProgramKeys::cascade(),
+                                   "shaders/cascade.frag");
+
+  // Add loaded shaders to the program
+  cascadeProgram.addShaderToProgram(
+      shaderManager.getVertexShader(ShaderProgramKeys::cascade()));
+  cascadeProgram.addShaderToProgram(
+      shaderManager.getFragmentShader(ShaderProgramKeys::cascade()));
+
+  // Link program (resolving the locations of its uniform handles)
+  cascadeProgram.setUniformHandles<shader_uniforms::CascadeUniforms>();
+  cascadeProgram.linkProgram();
+}
+
 void Renderer::_createShaderStructsUBOs() {
   auto& mainProgram = ShaderProgramManager::getInstance().getShaderProgram(
       ShaderProgramKeys::main());
@@ -120,30 +172,65 @@ void Renderer::_createShaderStructsUBOs() {
       UniformBlockBindingPoints::POINT_LIGHTS);
   mainProgram.bindUniformBlockToBindingPoint(
       "PointLightsBlock", UniformBlockBindingPoints::POINT_LIGHTS);
-}
 
-void Renderer::_createDepthFBOs() {
-  // Point Lights
+  // Cascaded shadows UBO
+  _uboCascadedShadows.createUBO(
+      CASCADE_MATRICES_OFFSET + Scene::MAX_DIRECTIONAL_LIGHTS *
+                                    CascadedShadowMaps::MAX_CASCADES *
+                                    sizeof(glm::mat4));
+  _uboCascadedShadows.bindBufferBaseToBindingPoint(
+      UniformBlockBindingPoints::CASCADED_SHADOWS);
+  mainProgram.bindUniformBlockToBindingPoint(
+      "CascadedShadowsBlock", UniformBlockBindingPoints::CASCADED_SHADOWS);
 
-  // Create depth frame buffer and bind it
-  glGenFramebuffers(1, &_depthFrameBufferID);
-  glBindFramebuffer(GL_FRAMEBUFFER, _depthFrameBufferID);
+  // Point shadows UBO (the tile of each cube face)
+  _uboPointShadows.createUBO(Scene::MAX_POINT_LIGHTS * 6 * sizeof(glm::vec4));
+  _uboPointShadows.bindBufferBaseToBindingPoint(
+      UniformBlockBindingPoints::POINT_SHADOWS);
+  mainProgram.bindUniformBlockToBindingPoint(
+      "PointShadowsBlock", UniformBlockBindingPoints::POINT_SHADOWS);
+}
 
-  // Create depth texture cube map
-  _depthTextureCubeMap.create(_shadowMapSize, _shadowMapSize,
-                              GL_DEPTH_COMPONENT);
+void Renderer::_createDepthFBOs() {
+  // Point lights: frame buffers of each layer of the atlas (created with the
+  // first light)
+  glGenFramebuffers(2, _pointShadowFrameBufferIDs);
 
-  // Attach depth texture cube map to frame buffer
-  glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _depthFrameBufferID,
-                       0);
+  // Directional lights: frame buffer of a single layer (one cascade)
+  glGenFramebuffers(1, &_directionalShadowFrameBufferID);
+  glBindFramebuffer(GL_FRAMEBUFFER, _directionalShadowFrameBufferID);
   glDrawBuffer(GL_NONE);
   glReadBuffer(GL_NONE);
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  _createDirectionalShadowMaps();
+}
+
+void Renderer::_createPointShadowAtlas() {
+  // Create the depth texture array (static then sampled layer) and attach
+  // each layer to its frame buffer
+  const auto size = static_cast<GLsizei>(_pointShadowAtlas.getSize());
+  _pointShadowAtlasTexture.create(size, size, 2, GL_DEPTH_COMPONENT24,
+                                  GL_DEPTH_COMPONENT);
+  for (GLint layer = 0; layer < 2; layer++) {
+    glBindFramebuffer(GL_FRAMEBUFFER, _pointShadowFrameBufferIDs[layer]);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              _pointShadowAtlasTexture.getID(), 0, layer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      std::cerr << "Point light shadows frame buffer is incomplete\n";
+    }
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  // The main pass compares depths while sampling (with 2x2 PCF)
+  _pointShadowAtlasTexture.enableDepthComparison();
 }
 
 std::array<glm::mat4, 6> Renderer::_getCubeMapViewMatrices(
     const glm::vec3& position) {
-  static const std::array<glm::mat4, 6> viewMatrices = {
+  const std::array<glm::mat4, 6> viewMatrices = {
       glm::lookAt(position, position + glm::vec3(1.0, 0.0, 0.0),
                   glm::vec3(0.0, -1.0, 0.0)),
       glm::lookAt(position, position + glm::vec3(-1.0, 0.0, 0.0),
@@ -216,13 +303,420 @@ void Renderer::_sendShaderStructsToProgram() {
   _uboPointLights.unbindUBO();
 }
 
-void Renderer::_drawScene(RenderPass renderPass) {
+void Renderer::_cullScene(const glm::mat4& viewProjectionMatrix,
+                          const glm::vec3& viewerPosition) {
+  // Gather the world bounds of all the objects (updated for moved objects
+  // only), then test them all at once
+  _frustumCuller.clear();
   for (const auto& object : _scene.objects) {
-    object->draw(renderPass);
+    _frustumCuller.addBox(object->getWorldAabbMin(), object->getWorldAabbMax());
+  }
+  _frustumCuller.cull(Frustum::fromMatrix(viewProjectionMatrix),
+                      _objectVisibilities);
+
+  // Rasterize the occluders in the frustum, then test the objects left
+  _occlusionCuller.begin(viewProjectionMatrix);
+  for (size_t i = 0; i < _scene.objects.size(); i++) {
+    auto& object = *_scene.objects[i];
+    if (_objectVisibilities[i] && object.isOccluder()) {
+      const auto center =
+          (object.getWorldAabbMin() + object.getWorldAabbMax()) * 0.5f;
+      _occlusionCuller.addOccluder(object.getModel()->getOccluderTriangles(),
+                                   object.getModelMatrix(),
+                                   glm::distance(viewerPosition, center));
+    }
+  }
+  _occlusionCuller.rasterize();
+  for (size_t i = 0; i < _scene.objects.size(); i++) {
+    if (_objectVisibilities[i]) {
+      _objectVisibilities[i] = _occlusionCuller.testBox(
+          _scene.objects[i]->getWorldAabbMin(),
+          _scene.objects[i]->getWorldAabbMax());
+    }
+  }
+}
+
+void Renderer::_drawScene(RenderPass renderPass,
+                          ShaderProgram& shaderProgram,
+                          const glm::vec3& viewerPosition,
+                          const std::vector<uint8_t>* visibilities) {
+  _renderQueue.clear();
+  for (size_t i = 0; i < _scene.objects.size(); i++) {
+    if (visibilities && !(*visibilities)[i]) {
+      continue;
+    }
+    _scene.objects[i]->submit(_renderQueue, renderPass, shaderProgram,
+                              viewerPosition);
+  }
+  _renderQueue.sort();
+  _renderQueue.execute();
+}
+
+void Renderer::_drawObjects(RenderPass renderPass,
+                            ShaderProgram& shaderProgram,
+                            const glm::vec3& viewerPosition,
+                            const std::vector<size_t>& objectIndices) {
+  _renderQueue.clear();
+  for (const auto objectIndex : objectIndices) {
+    _scene.objects[objectIndex]->submit(_renderQueue, renderPass,
+                                        shaderProgram, viewerPosition);
+  }
+  _renderQueue.sort();
+  _renderQueue.execute();
+}
+
+void Renderer::_updatePointLightShadows(
+    ShaderProgram& depthProgram,
+    const glm::mat4& faceProjectionMatrix,
+    const Frustum& cameraFrustum,
+    const glm::vec3& cameraPosition,
+    float screenScale) {
+  const auto lightCount = _scene.pointLights.size();
+  _pointLightShadows.resize(lightCount);
+  if (lightCount > 0 && !_pointShadowAtlasTexture.isLoaded()) {
+    _createPointShadowAtlas();
+  }
+
+  // Static objects whose bounds changed (moved, or their model reloaded)
+  // outdate the static layer of all the lights, and so does a new hierarchy
+  // of them (the casters come from it, which only follows them after the
+  // frame)
+  const auto objectCount = _scene.objects.size();
+  bool haveStaticObjectsChanged =
+      _staticObjectBoundsRevisions.size() != objectCount ||
+      _scene.getStaticBvhRevision() != _staticBvhRevision;
+  _staticBvhRevision = _scene.getStaticBvhRevision();
+  _staticObjectBoundsRevisions.resize(objectCount, 0);
+  _movingObjectFlags.assign(objectCount, 0);
+  for (const auto objectIndex : _scene.getMovingObjects()) {
+    _movingObjectFlags[objectIndex] = 1;
+  }
+  for (size_t i = 0; i < objectCount; i++) {
+    if (_movingObjectFlags[i]) {
+      continue;
+    }
+    const auto revision = _scene.objects[i]->getBoundsRevision();
+    if (revision != _staticObjectBoundsRevisions[i]) {
+      _staticObjectBoundsRevisions[i] = revision;
+      haveStaticObjectsChanged = true;
+    }
+  }
+
+  // Lights whose range (its bounding box) may light what the camera sees
+  _shadowCuller.clear();
+  for (const auto& light : _scene.pointLights) {
+    const glm::vec3 range(_getPointLightRange(light));
+    _shadowCuller.addBox(light.position - range, light.position + range);
+  }
+  _shadowCuller.cull(cameraFrustum, _shadowCullerVisibilities);
+
+  // Size the tiles of those lights by the part of the screen their range
+  // covers (all of it from inside), then pack them
+  _pointShadowTileSizes.assign(6 * lightCount, 0);
+  for (size_t l = 0; l < lightCount; l++) {
+    const auto& light = _scene.pointLights[l];
+    auto& shadow = _pointLightShadows[l];
+    const auto range = _getPointLightRange(light);
+    if (!light.isOn || range <= 0.0f || !_shadowCullerVisibilities[l]) {
+      shadow.tileSize = 0;
+      continue;
+    }
+    const auto squaredDistance =
+        glm::dot(light.position - cameraPosition,
+                 light.position - cameraPosition);
+    float coverage = 1.0f;
+    if (squaredDistance > range * range) {
+      coverage =
+          range * screenScale / std::sqrt(squaredDistance - range * range);
+    }
+    shadow.tileSize = _pointShadowAtlas.getTileSize(coverage, shadow.tileSize);
+    std::fill_n(_pointShadowTileSizes.begin() + 6 * l, 6, shadow.tileSize);
+  }
+  _pointShadowAtlas.pack(_pointShadowTileSizes, _pointShadowTiles);
+
+  using shader_uniforms::DepthUniforms;
+  const auto atlasSize = static_cast<float>(_pointShadowAtlas.getSize());
+  glEnable(GL_SCISSOR_TEST);
+  _uboPointShadows.bindUBO();
+  for (size_t l = 0; l < lightCount; l++) {
+    const auto& light = _scene.pointLights[l];
+    auto& shadow = _pointLightShadows[l];
+    const auto* tiles = &_pointShadowTiles[6 * l];
+
+    // Send the tiles (a light without them has no shadow, which is only
+    // possible when it lights nothing the camera sees)
+    std::array<glm::vec4, 6> tileRectangles;
+    for (size_t face = 0; face < 6; face++) {
+      tileRectangles[face] =
+          glm::vec4(glm::vec2(tiles[face].offset), tiles[face].size, 0.0f) /
+          atlasSize;
+    }
+    _uboPointShadows.setBufferData(6 * l * sizeof(glm::vec4),
+                                   tileRectangles.data(),
+                                   sizeof(tileRectangles));
+    if (tiles[0].size == 0) {
+      // Other lights may draw over the tiles it had
+      shadow.isStaticLayerValid = false;
+      shadow.hasDynamicCasters = false;
+      continue;
+    }
+
+    // Draw the static casters in range again if the light, they, or the
+    // tiles moved
+    const auto range = _getPointLightRange(light);
+    const bool isStaticLayerOutdated =
+        haveStaticObjectsChanged || !shadow.isStaticLayerValid ||
+        light.position != shadow.lightPosition || range != shadow.range ||
+        !std::equal(shadow.staticTiles.begin(), shadow.staticTiles.end(),
+                    tiles);
+
+    // Moving casters in range are drawn over a copy of the static layer
+    // (which is also needed once they left, to erase them), static ones only
+    // when it's outdated
+    _pointShadowCasters.clear();
+    _scene.queryObjectsInSphere(light.position, range, _pointShadowCasters);
+    const auto isStatic = [this](size_t objectIndex) {
+      return !_movingObjectFlags[objectIndex];
+    };
+    if (!isStaticLayerOutdated) {
+      _pointShadowCasters.erase(
+          std::remove_if(_pointShadowCasters.begin(),
+                         _pointShadowCasters.end(), isStatic),
+          _pointShadowCasters.end());
+    }
+    const bool hasDynamicCasters =
+        !std::all_of(_pointShadowCasters.begin(), _pointShadowCasters.end(),
+                     isStatic);
+    _shadowCuller.clear();
+    for (const auto objectIndex : _pointShadowCasters) {
+      auto& object = *_scene.objects[objectIndex];
+      _shadowCuller.addBox(object.getWorldAabbMin(), object.getWorldAabbMax());
+    }
+    const bool isSampledLayerOutdated = isStaticLayerOutdated ||
+                                        hasDynamicCasters ||
+                                        shadow.hasDynamicCasters;
+
+    depthProgram.set(DepthUniforms::lightWorldPos, light.position);
+    const auto viewMatrices = _getCubeMapViewMatrices(light.position);
+    for (size_t face = 0; face < 6 && isSampledLayerOutdated; face++) {
+      const auto& tile = tiles[face];
+      glViewport(tile.offset.x, tile.offset.y, tile.size, tile.size);
+      glScissor(tile.offset.x, tile.offset.y, tile.size, tile.size);
+      depthProgram.set(DepthUniforms::matrices.view, viewMatrices[face]);
+
+      // Casters in range seen by the face, static or moving
+      _shadowCuller.cull(
+          Frustum::fromMatrix(faceProjectionMatrix * viewMatrices[face]),
+          _shadowCullerVisibilities);
+      for (const bool isMoving : {false, true}) {
+        _casterIndices.clear();
+        for (size_t i = 0; i < _pointShadowCasters.size(); i++) {
+          const auto objectIndex = _pointShadowCasters[i];
+          if (_shadowCullerVisibilities[i] &&
+              _movingObjectFlags[objectIndex] == isMoving) {
+            _casterIndices.push_back(objectIndex);
+          }
+        }
+
+        if (!isMoving && isStaticLayerOutdated) {
+          glBindFramebuffer(GL_FRAMEBUFFER, _pointShadowFrameBufferIDs[0]);
+          glClear(GL_DEPTH_BUFFER_BIT);
+          _drawObjects(RenderPass::Depth, depthProgram, light.position,
+                       _casterIndices);
+        } else if (isMoving) {
+          // Copy the static layer's tile (the scissor box is the tile)
+          glBindFramebuffer(GL_READ_FRAMEBUFFER,
+                            _pointShadowFrameBufferIDs[0]);
+          glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+                            _pointShadowFrameBufferIDs[1]);
+          const auto end = tile.offset + tile.size;
+          glBlitFramebuffer(tile.offset.x, tile.offset.y, end.x, end.y,
+                            tile.offset.x, tile.offset.y, end.x, end.y,
+                            GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+          if (hasDynamicCasters) {
+            glBindFramebuffer(GL_FRAMEBUFFER, _pointShadowFrameBufferIDs[1]);
+            _drawObjects(RenderPass::Depth, depthProgram, light.position,
+                         _casterIndices);
+          }
+        }
+      }
+    }
+
+    if (isStaticLayerOutdated) {
+      shadow.lightPosition = light.position;
+      shadow.range = range;
+      std::copy(tiles, tiles + 6, shadow.staticTiles.begin());
+      shadow.isStaticLayerValid = true;
+    }
+    shadow.hasDynamicCasters = hasDynamicCasters;
+  }
+  _uboPointShadows.unbindUBO();
+  glDisable(GL_SCISSOR_TEST);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+float Renderer::_getPointLightRange(const shader_structs::PointLight& light) {
+  // Solve intensity / (1 + attenuation * distance^2) = minimal intensity
+  const auto intensityRatio = light.intensityFactor / MIN_POINT_LIGHT_INTENSITY;
+  if (light.attenuationFactor <= 0.0f || intensityRatio <= 1.0f) {
+    return intensityRatio <= 1.0f ? 0.0f : POINT_SHADOW_FAR_PLANE;
+  }
+  return std::min(
+      std::sqrt((intensityRatio - 1.0f) / light.attenuationFactor),
+      POINT_SHADOW_FAR_PLANE);
+}
+
+void Renderer::_createDirectionalShadowMaps() {
+  _directionalShadowMaps.deleteTexture();
+  const auto& settings = _cascadedShadowMaps.getSettings();
+  const auto layerCount = static_cast<GLsizei>(
+      _scene.directionalLights.size() * settings.cascadeCount);
+  if (layerCount == 0) {
+    return;
   }
+
+  _directionalShadowMaps.create(settings.resolution, settings.resolution,
+                                layerCount, GL_DEPTH_COMPONENT24,
+                                GL_DEPTH_COMPONENT);
+  _directionalShadowMaps.enableDepthComparison();
+}
+
+void Renderer::_updateDirectionalLightShadows(
+    const glm::mat4& viewMatrix,
+    const glm::mat4& projectionMatrix,
+    const glm::vec3& cameraPosition) {
+  // Create the shadow maps again if the lights or settings changed
+  const auto& settings = _cascadedShadowMaps.getSettings();
+  const auto layerCount = static_cast<GLsizei>(
+      _scene.directionalLights.size() * settings.cascadeCount);
+  if (layerCount != _directionalShadowMaps.getLayerCount() ||
+      (layerCount > 0 &&
+       settings.resolution != _directionalShadowMaps.getWidth())) {
+    _createDirectionalShadowMaps();
+  }
+
+  // Send the cascade count first (no light has shadows without cascades)
+  _uboCascadedShadows.bindUBO();
+  const GLint cascadeCount =
+      layerCount > 0 ? static_cast<GLint>(settings.cascadeCount) : 0;
+  _uboCascadedShadows.setBufferData(0, &cascadeCount, sizeof(GLint));
+  if (cascadeCount == 0) {
+    _uboCascadedShadows.unbindUBO();
+    return;
+  }
+
+  auto& cascadeProgram = ShaderProgramManager::getInstance().getShaderProgram(
+      ShaderProgramKeys::cascade());
+  cascadeProgram.useProgram();
+  glBindFramebuffer(GL_FRAMEBUFFER, _directionalShadowFrameBufferID);
+  glViewport(0, 0, settings.resolution, settings.resolution);
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(CASCADE_SLOPE_BIAS, CASCADE_CONSTANT_BIAS);
+
+  using shader_uniforms::CascadeUniforms;
+  for (size_t l = 0; l < _scene.directionalLights.size(); l++) {
+    const auto& light = _scene.directionalLights[l];
+    if (!light.isOn) {
+      continue;
+    }
+
+    _cascadedShadowMaps.fit(viewMatrix, projectionMatrix, light.direction);
+    for (size_t c = 0; c < settings.cascadeCount; c++) {
+      // Casters in the cascade's projection (or between it and the light),
+      // whose depth range is extended up to the nearest one
+      _casterIndices.clear();
+      _scene.queryObjectsInFrustum(_cascadedShadowMaps.getCasterFrustum(c),
+                                   _casterIndices);
+      const auto& lightViewMatrix =
+          _cascadedShadowMaps.getCascades()[c].viewMatrix;
+      const glm::vec3 depthAxis(lightViewMatrix[0][2], lightViewMatrix[1][2],
+                                lightViewMatrix[2][2]);
+      float casterMaxZ = -FLT_MAX;
+      for (const auto objectIndex : _casterIndices) {
+        auto& object = *_scene.objects[objectIndex];
+        const auto center =
+            (object.getWorldAabbMin() + object.getWorldAabbMax()) * 0.5f;
+        const auto extents =
+            (object.getWorldAabbMax() - object.getWorldAabbMin()) * 0.5f;
+        casterMaxZ = std::max(casterMaxZ,
+                              glm::dot(depthAxis, center) +
+                                  glm::dot(glm::abs(depthAxis), extents));
+      }
+      _cascadedShadowMaps.includeCasters(c, casterMaxZ);
+      const auto& cascade = _cascadedShadowMaps.getCascades()[c];
+
+      // Draw the casters into the cascade's layer
+      const auto layer = static_cast<GLint>(l * settings.cascadeCount + c);
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                _directionalShadowMaps.getID(), 0, layer);
+      glClear(GL_DEPTH_BUFFER_BIT);
+      cascadeProgram.set(CascadeUniforms::matrices.projection,
+                         cascade.projectionMatrix);
+      cascadeProgram.set(CascadeUniforms::matrices.view, cascade.viewMatrix);
+      _drawObjects(RenderPass::Depth, cascadeProgram, cameraPosition,
+                   _casterIndices);
+
+      // Send the cascade
+      const glm::mat4 shadowMatrix = SHADOW_MAP_BIAS_MATRIX *
+                                     cascade.projectionMatrix *
+                                     cascade.viewMatrix;
+      const auto matrixIndex = l * CascadedShadowMaps::MAX_CASCADES + c;
+      _uboCascadedShadows.setBufferData(
+          CASCADE_MATRICES_OFFSET + matrixIndex * sizeof(glm::mat4),
+          &shadowMatrix, sizeof(glm::mat4));
+    }
+  }
+
+  // Send the split distances (the same for all the lights)
+  const auto& cascades = _cascadedShadowMaps.getCascades();
+  for (size_t c = 0; c < cascades.size(); c++) {
+    _uboCascadedShadows.setBufferData(
+        CASCADE_SPLITS_OFFSET + c * sizeof(glm::vec4),
+        &cascades[c].splitDistance, sizeof(float));
+  }
+  _uboCascadedShadows.unbindUBO();
+
+  glDisable(GL_POLYGON_OFFSET_FILL);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Renderer::setCascadedShadowSettings(
+    const CascadedShadowMaps::Settings& settings) {
+  _cascadedShadowMaps.setSettings(settings);
+}
+
+const CascadedShadowMaps::Settings& Renderer::getCascadedShadowSettings()
+    const {
+  return _cascadedShadowMaps.getSettings();
+}
+
+const RenderQueue::Statistics& Renderer::getRenderStatistics() const {
+  return _renderQueue.getStatistics();
+}
+
+const FrustumCuller::Statistics& Renderer::getCullingStatistics() const {
+  return _frustumCuller.getStatistics();
+}
+
+const OcclusionCuller::Statistics& Renderer::getOcclusionStatistics() const {
+  return _occlusionCuller.getStatistics();
 }
 
 void Renderer::update(Camera& camera) {
+  _renderQueue.resetStatistics();
+  ShaderProgram::resetUniformStatistics();
+
+  // Select the levels of detail, from the pixels one world unit covers at
+  // distance one (vertically, as the projection is)
+  const auto mainProjectionMatrix = _app.getProjectionMatrix();
+  const float pixelsPerUnit =
+      mainProjectionMatrix[1][1] * _app.getWindowSize().y * 0.5f;
+  const float fogDensity =
+      _scene.fogParams.isEnabled ? _scene.fogParams.density : 0.0f;
+  for (const auto& object : _scene.objects) {
+    object->selectLod(camera.getPosition(), pixelsPerUnit, fogDensity);
+  }
+
   // Lights depth maps pass
 
   // Get shader program
@@ -230,46 +724,28 @@ void Renderer::update(Camera& camera) {
       ShaderProgramKeys::depth());
   depthProgram.useProgram();
 
-  // Set OpenGL viewport to shadowmap size
-  glViewport(0, 0, _shadowMapSize, _shadowMapSize);
-
   // Calculate projection matrix
   const float vFov = 90.0f;
   const float aspectRatio = 1;
   const float zNear = 0.1f;
-  const float zFar = 1500.0f;
+  const float zFar = POINT_SHADOW_FAR_PLANE;
   const auto projectionMatrix =
       glm::perspective(glm::radians(vFov), aspectRatio, zNear, zFar);
 
   // Send projection matrix and far plane uniforms
-  depthProgram[ShaderConstants::projectionMatrix()] = projectionMatrix;
-  depthProgram[ShaderConstants::farPlane()] = zFar;
+  using shader_uniforms::DepthUniforms;
+  depthProgram.set(DepthUniforms::matrices.projection, projectionMatrix);
+  depthProgram.set(DepthUniforms::farPlane, zFar);
 
   // Point lights shadows
-  // for (size_t i = 0; i < _scene.pointLights.size(); i++) {
-  //   // Needed vars
-  //   const auto& light = _scene.pointLights[i];
-
-  //   // Get view matrix and send it to shader
-  //   const auto viewMatrices = _getCubeMapViewMatrices(light.position);
-  //   depthProgram[ShaderConstants::cubeMapViewMatrices()].set(
-  //       viewMatrices.data(), (GLsizei)viewMatrices.size());
-
-  //   // Send light position
-  //   depthProgram[ShaderConstants::lightWorldPos()] = light.position;
+  const auto cameraFrustum =
+      Frustum::fromMatrix(mainProjectionMatrix * camera.getViewMatrix());
+  _updatePointLightShadows(depthProgram, projectionMatrix, cameraFrustum,
+                           camera.getPosition(), mainProjectionMatrix[1][1]);
 
-  //   // Bind this light's depth frame buffer
-  //   glBindFramebuffer(GL_FRAMEBUFFER, _depthFrameBufferID);
-
-  //   // Clear depth buffer
-  //   glClear(GL_DEPTH_BUFFER_BIT);
-
-  //   // Draw the scene
-  //   _drawScene(RenderPass::Depth);
-
-  //   // Unbind this light's depth frame buffer
-  //   glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  // }
+  // Directional lights shadows
+  _updateDirectionalLightShadows(camera.getViewMatrix(), mainProjectionMatrix,
+                                 camera.getPosition());
 
   // Main pass
 
@@ -279,18 +755,27 @@ void Renderer::update(Camera& camera) {
   mainProgram.useProgram();
 
   // Send matrices uniforms to shader
-  mainProgram[ShaderConstants::projectionMatrix()] = _app.getProjectionMatrix();
-  mainProgram[ShaderConstants::viewMatrix()] = camera.getViewMatrix();
-  mainProgram[ShaderConstants::cameraWorldPos()] = camera.getPosition();
+  using shader_uniforms::MainUniforms;
+  mainProgram.set(MainUniforms::matrices.projection, mainProjectionMatrix);
+  mainProgram.set(MainUniforms::matrices.view, camera.getViewMatrix());
+  mainProgram.set(MainUniforms::cameraWorldPos, camera.getPosition());
 
   // Send other uniforms to shader
-  _scene.fogParams.setUniform(mainProgram, ShaderConstants::fogParams());
+  _scene.fogParams.setUniform(mainProgram, MainUniforms::fogParams);
 
   // Depth uniforms
-  mainProgram[ShaderConstants::farPlane()] = zFar;
-  GLint depthCubeMapTextureUnit = 1;
-  mainProgram[ShaderConstants::depthSampler()] = depthCubeMapTextureUnit;
-  _depthTextureCubeMap.bind(depthCubeMapTextureUnit);
+  mainProgram.set(MainUniforms::farPlane, zFar);
+  const GLint pointShadowTextureUnit = 1;
+  mainProgram.set(MainUniforms::pointShadowSampler, pointShadowTextureUnit);
+  if (_pointShadowAtlasTexture.isLoaded()) {
+    _pointShadowAtlasTexture.bind(pointShadowTextureUnit);
+  }
+  const GLint directionalShadowTextureUnit = 2;
+  mainProgram.set(MainUniforms::directionalShadowSampler,
+                  directionalShadowTextureUnit);
+  if (_directionalShadowMaps.isLoaded()) {
+    _directionalShadowMaps.bind(directionalShadowTextureUnit);
+  }
 
   // Send structs to shaders
   _sendShaderStructsToProgram();
@@ -304,6 +789,9 @@ void Renderer::update(Camera& camera) {
   // Clear the screen
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // Draw all objects in the scene
-  _drawScene(RenderPass::Main);
+  // Draw the objects in the camera's frustum
+  _cullScene(mainProjectionMatrix * camera.getViewMatrix(),
+             camera.getPosition());
+  _drawScene(RenderPass::Main, mainProgram, camera.getPosition(),
+             &_objectVisibilities);
 }
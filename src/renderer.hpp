@@ -2,6 +2,7 @@
 #define RENDERER_HPP
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -11,11 +12,16 @@
 
 #include "app.hpp"
 #include "camera/camera.hpp"
+#include "cascaded_shadow_maps.hpp"
+#include "frustum_culler.hpp"
+#include "occlusion_culler.hpp"
+#include "shadow_atlas.hpp"
 #include "gl_wrappers/frame_buffer.hpp"
 #include "gl_wrappers/shader_program.hpp"
-#include "gl_wrappers/texture_cube_map.hpp"
+#include "gl_wrappers/texture_array.hpp"
 #include "gl_wrappers/uniform_buffer_object.hpp"
 #include "render_pass.hpp"
+#include "render_queue.hpp"
 #include "scene/scene.hpp"
 
 class App;
@@ -25,6 +31,42 @@ class Renderer {
   Renderer(const App& app, const Scene& scene);
   void update(Camera& camera);
 
+  /**
+   * Gets the statistics of the draws of the last frame.
+   */
+  const RenderQueue::Statistics& getRenderStatistics() const;
+
+  /**
+   * Gets the statistics of the frustum culling of the last frame.
+   */
+  const FrustumCuller::Statistics& getCullingStatistics() const;
+
+  /**
+   * Gets the statistics of the occlusion culling of the last frame.
+   */
+  const OcclusionCuller::Statistics& getOcclusionStatistics() const;
+
+  /**
+   * Changes the settings of the directional lights' cascaded shadow maps (the
+   * shadow maps are created again if their size changes).
+   * Throws std::runtime_error if the settings are invalid.
+   */
+  void setCascadedShadowSettings(const CascadedShadowMaps::Settings& settings);
+
+  /**
+   * Gets the settings of the directional lights' cascaded shadow maps.
+   */
+  const CascadedShadowMaps::Settings& getCascadedShadowSettings() const;
+
+  // Far plane of the point light shadow maps (distances to the lights are
+  // stored relative to it)
+  static constexpr float POINT_SHADOW_FAR_PLANE = 1500.0f;
+  // Attenuated intensity under which a point light doesn't light anymore
+  static constexpr float MIN_POINT_LIGHT_INTENSITY = 1.0f / 256.0f;
+  // Depth bias of the cascades' casters (polygon offset factor and units)
+  static constexpr float CASCADE_SLOPE_BIAS = 2.0f;
+  static constexpr float CASCADE_CONSTANT_BIAS = 4.0f;
+
  private:
   const App& _app;
   const Scene& _scene;
@@ -32,17 +74,116 @@ class Renderer {
   UniformBufferObject _uboAmbientLights;
   UniformBufferObject _uboDirectionalLights;
   UniformBufferObject _uboPointLights;
+  UniformBufferObject _uboCascadedShadows;
+  UniformBufferObject _uboPointShadows;
+
+  /**
+   * Shadow map of a point light: the 6 faces of its cube, in tiles of the
+   * atlas.
+   */
+  struct PointLightShadow {
+    glm::vec3 lightPosition = glm::vec3(0);  // Of the static layer
+    float range = 0.0f;                      // Of the static layer
+    std::array<ShadowAtlas::Tile, 6> staticTiles;  // Of the static layer
+    int tileSize = 0;                 // Requested in the last frame
+    bool isStaticLayerValid = false;  // Whether static casters are drawn
+    bool hasDynamicCasters = false;   // Whether moving casters were drawn on
+                                      // top in the last frame
+  };
+
+  // Point light shadows share an atlas, whose tiles are sized by how much of
+  // the screen the lights cover. It has a layer of the static casters, only
+  // drawn again when a light, a static object or a tile moves, and a layer the
+  // main pass samples, where they are copied under the moving casters
+  ShadowAtlas _pointShadowAtlas;
+  TextureArray _pointShadowAtlasTexture;
+  GLuint _pointShadowFrameBufferIDs[2] = {};  // One layer each (static, then
+                                              // sampled)
+  std::vector<PointLightShadow> _pointLightShadows;  // By point light
+  std::vector<int> _pointShadowTileSizes;  // Requested, by light then face
+  std::vector<ShadowAtlas::Tile> _pointShadowTiles;  // Placed, by light then
+                                                     // face
+  std::vector<size_t> _pointShadowCasters;  // Casters in range of a light
+  std::vector<size_t> _staticObjectBoundsRevisions;  // As in the static layers
+  size_t _staticBvhRevision = SIZE_MAX;  // Of the scene's hierarchy queried by
+                                         // the static layers
+  std::vector<uint8_t> _movingObjectFlags;  // Whether moved by the scene, by
+                                            // object
+  FrustumCuller _shadowCuller;  // Bounds of the point lights, then of the
+                                // casters in range of one
+  std::vector<uint8_t> _shadowCullerVisibilities;  // By box of _shadowCuller
 
-  const GLsizei _shadowMapSize = 1024;
-  GLuint _depthFrameBufferID;
-  TextureCubeMap _depthTextureCubeMap;
+  CascadedShadowMaps _cascadedShadowMaps;  // Of the current directional light
+  TextureArray _directionalShadowMaps;     // Cascades of each directional
+                                           // light, in consecutive layers
+  GLuint _directionalShadowFrameBufferID = 0;  // One layer (drawn to)
+  std::vector<size_t> _casterIndices;  // Casters drawn in a shadow map
+
+  RenderQueue _renderQueue;  // Draws of the current pass
+
+  FrustumCuller _frustumCuller;      // Bounds of the scene's objects
+  OcclusionCuller _occlusionCuller;  // Depth of the occluders
+  std::vector<uint8_t> _objectVisibilities;  // Neither outside the camera's
+                                             // frustum nor occluded, by object
 
   void _loadMainShaderProgram();
   void _loadDepthShaderProgram();
+  void _loadCascadeShaderProgram();
   void _createShaderStructsUBOs();
   void _createDepthFBOs();
+
+  /**
+   * Creates the atlas texture of the point light shadows.
+   */
+  void _createPointShadowAtlas();
+
+  /**
+   * Packs the shadow maps of the point lights the camera sees into the atlas,
+   * draws them (the static layer only when outdated, and the moving casters
+   * on top of it), and sends their tiles to the main program.
+   * @param depthProgram          Program drawing the casters
+   * @param faceProjectionMatrix  Projection of a cube face
+   * @param cameraFrustum         Frustum of the camera
+   * @param cameraPosition        Position of the camera
+   * @param screenScale           Vertical scale of the camera's projection
+   */
+  void _updatePointLightShadows(ShaderProgram& depthProgram,
+                                const glm::mat4& faceProjectionMatrix,
+                                const Frustum& cameraFrustum,
+                                const glm::vec3& cameraPosition,
+                                float screenScale);
+
+  /**
+   * Gets the distance from a point light at which it stops lighting (capped
+   * by the far plane of the shadow maps).
+   */
+  static float _getPointLightRange(const shader_structs::PointLight& light);
+
+  /**
+   * Creates the cascaded shadow maps of the directional lights, replacing the
+   * previous ones.
+   */
+  void _createDirectionalShadowMaps();
+
+  /**
+   * Fits the cascades of the directional lights to the camera, draws their
+   * casters, and sends the cascades to the main program.
+   */
+  void _updateDirectionalLightShadows(const glm::mat4& viewMatrix,
+                                      const glm::mat4& projectionMatrix,
+                                      const glm::vec3& cameraPosition);
+
   void _sendShaderStructsToProgram();
-  void _drawScene(RenderPass renderPass);
+  void _cullScene(const glm::mat4& viewProjectionMatrix,
+                  const glm::vec3& viewerPosition);
+  void _drawScene(RenderPass renderPass,
+                  ShaderProgram& shaderProgram,
+                  const glm::vec3& viewerPosition,
+                  const std::vector<uint8_t>* visibilities = nullptr);
+  void _drawObjects(RenderPass renderPass,
+                    ShaderProgram& shaderProgram,
+                    const glm::vec3& viewerPosition,
+                    const std::vector<size_t>& objectIndices);
 
   std::array<glm::mat4, 6> _getCubeMapViewMatrices(const glm::vec3& position);
 };
@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "bounding_volume_hierarchy.hpp"
+
+void BoundingBox::extend(const BoundingBox& box) {
+  min = glm::min(min, box.min);
+  max = glm::max(max, box.max);
+}
+
+void BoundingBox::extend(const glm::vec3& point) {
+  min = glm::min(min, point);
+  max = glm::max(max, point);
+}
+
+float BoundingBox::getSurfaceArea() const {
+  if (min.x > max.x) {
+    return 0.0f;
+  }
+  const auto size = max - min;
+  return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool BoundingBox::intersects(const BoundingBox& box) const {
+  return min.x <= box.max.x && box.min.x <= max.x && min.y <= box.max.y &&
+         box.min.y <= max.y && min.z <= box.max.z && box.min.z <= max.z;
+}
+
+bool BoundingBox::operator==(const BoundingBox& box) const {
+  return min == box.min && max == box.max;
+}
+
+/**
+ * Gets the signed distances from a plane to the nearest and farthest points of
+ * a box (along the plane's normal).
+ */
+static void getPlaneDistances(const glm::vec4& plane,
+                              const BoundingBox& box,
+                              float& nearDistance,
+                              float& farDistance) {
+  const glm::vec3 normal(plane);
+  const auto center = (box.min + box.max) * 0.5f;
+  const auto extents = (box.max - box.min) * 0.5f;
+  const float distance = glm::dot(normal, center) + plane.w;
+  const float radius = glm::dot(glm::abs(normal), extents);
+  nearDistance = distance - radius;
+  farDistance = distance + radius;
+}
+
+/**
+ * Checks whether a ray crosses a box before its end.
+ * @param inverseDirection  Inverse of the ray's direction (per coordinate)
+ */
+static bool intersectRay(const BoundingBox& box,
+                         const glm::vec3& origin,
+                         const glm::vec3& inverseDirection,
+                         float maxDistance) {
+  // Slab test: the ray is inside the box where it's inside all three slabs
+  const auto t0 = (box.min - origin) * inverseDirection;
+  const auto t1 = (box.max - origin) * inverseDirection;
+  const auto tMin = glm::min(t0, t1);
+  const auto tMax = glm::max(t0, t1);
+  const float enter =
+      std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+  const float exit =
+      std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+  return enter <= exit;
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<size_t>& items,
+                                    const std::vector<BoundingBox>& boxes) {
+  _nodes.clear();
+  _items = items;
+  _itemBoxes.assign(boxes.size(), BoundingBox());
+  _itemLeaves.assign(boxes.size(), 0);
+  if (items.empty()) {
+    return;
+  }
+
+  // Splits are decided on the centers of the boxes
+  std::vector<glm::vec3> centers(boxes.size());
+  for (const auto item : items) {
+    _itemBoxes[item] = boxes[item];
+    centers[item] = (boxes[item].min + boxes[item].max) * 0.5f;
+  }
+
+  _nodes.reserve(2 * items.size() / MAX_LEAF_SIZE + 1);
+  _nodes.emplace_back();
+  _buildNode(0, 0, static_cast<uint32_t>(items.size()), centers);
+}
+
+void BoundingVolumeHierarchy::_buildNode(
+    uint32_t nodeIndex,
+    uint32_t first,
+    uint32_t count,
+    const std::vector<glm::vec3>& centers) {
+  const auto itemsBegin = _items.begin() + first;
+  const auto itemsEnd = itemsBegin + count;
+
+  // Bounds of the items and of their centers
+  BoundingBox box, centerBox;
+  for (auto it = itemsBegin; it != itemsEnd; ++it) {
+    box.extend(_itemBoxes[*it]);
+    centerBox.extend(centers[*it]);
+  }
+  _nodes[nodeIndex].box = box;
+
+  const auto makeLeaf = [&]() {
+    _nodes[nodeIndex].first = first;
+    _nodes[nodeIndex].count = count;
+    for (auto it = itemsBegin; it != itemsEnd; ++it) {
+      _itemLeaves[*it] = nodeIndex;
+    }
+  };
+  if (count <= 1) {
+    makeLeaf();
+    return;
+  }
+
+  // Find the split between bins with the lowest cost: the chance of visiting
+  // each side (proportional to its surface) times its number of items
+  struct Bin {
+    BoundingBox box;
+    uint32_t count = 0;
+  };
+  float bestCost = FLT_MAX;
+  int bestAxis = -1;
+  size_t bestSplit = 0;
+  const auto centerExtents = centerBox.max - centerBox.min;
+  for (int axis = 0; axis < 3; axis++) {
+    if (centerExtents[axis] <= 0.0f) {
+      continue;
+    }
+    const float binScale = BIN_COUNT / centerExtents[axis];
+    std::array<Bin, BIN_COUNT> bins;
+    for (auto it = itemsBegin; it != itemsEnd; ++it) {
+      const auto bin = std::min(
+          static_cast<size_t>((centers[*it][axis] - centerBox.min[axis]) *
+                              binScale),
+          BIN_COUNT - 1);
+      bins[bin].box.extend(_itemBoxes[*it]);
+      bins[bin].count++;
+    }
+
+    // Sweep from the right for the costs of the right sides, then from the
+    // left
+    std::array<float, BIN_COUNT> rightCosts;
+    BoundingBox rightBox;
+    uint32_t rightCount = 0;
+    for (size_t i = BIN_COUNT - 1; i > 0; i--) {
+      rightBox.extend(bins[i].box);
+      rightCount += bins[i].count;
+      rightCosts[i] = rightBox.getSurfaceArea() * rightCount;
+    }
+    BoundingBox leftBox;
+    uint32_t leftCount = 0;
+    for (size_t i = 1; i < BIN_COUNT; i++) {
+      leftBox.extend(bins[i - 1].box);
+      leftCount += bins[i - 1].count;
+      const float cost = leftBox.getSurfaceArea() * leftCount + rightCosts[i];
+      if (leftCount > 0 && leftCount < count && cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestSplit = i;
+      }
+    }
+  }
+
+  // Keep the items together when splitting them costs more than testing them
+  const float surfaceArea = box.getSurfaceArea();
+  const float splitCost =
+      surfaceArea > 0.0f ? TRAVERSAL_COST + bestCost / surfaceArea : FLT_MAX;
+  if (count <= MAX_LEAF_SIZE && splitCost >= count) {
+    makeLeaf();
+    return;
+  }
+
+  // Partition the items, at the middle when their centers are all the same
+  auto middle = itemsBegin + count / 2;
+  if (bestAxis >= 0) {
+    const float binScale = BIN_COUNT / centerExtents[bestAxis];
+    middle = std::partition(itemsBegin, itemsEnd, [&](size_t item) {
+      const auto bin = std::min(
+          static_cast<size_t>(
+              (centers[item][bestAxis] - centerBox.min[bestAxis]) * binScale),
+          BIN_COUNT - 1);
+      return bin < bestSplit;
+    });
+  }
+  const auto leftCount = static_cast<uint32_t>(middle - itemsBegin);
+
+  // Children are consecutive
+  const auto leftIndex = static_cast<uint32_t>(_nodes.size());
+  _nodes.emplace_back();
+  _nodes.emplace_back();
+  _nodes[leftIndex].parent = nodeIndex;
+  _nodes[leftIndex + 1].parent = nodeIndex;
+  _nodes[nodeIndex].first = leftIndex;
+  _nodes[nodeIndex].count = 0;
+  _buildNode(leftIndex, first, leftCount, centers);
+  _buildNode(leftIndex + 1, first + leftCount, count - leftCount, centers);
+}
+
+void BoundingVolumeHierarchy::refit(size_t item, const BoundingBox& box) {
+  _itemBoxes[item] = box;
+
+  // Bounds of the leaf's items
+  auto nodeIndex = _itemLeaves[item];
+  auto& leaf = _nodes[nodeIndex];
+  BoundingBox leafBox;
+  for (uint32_t i = leaf.first; i < leaf.first + leaf.count; i++) {
+    leafBox.extend(_itemBoxes[_items[i]]);
+  }
+  leaf.box = leafBox;
+
+  // Ancestors, up to the first one whose bounds don't change
+  while (nodeIndex != 0) {
+    nodeIndex = _nodes[nodeIndex].parent;
+    auto& node = _nodes[nodeIndex];
+    BoundingBox nodeBox = _nodes[node.first].box;
+    nodeBox.extend(_nodes[node.first + 1].box);
+    if (nodeBox == node.box) {
+      break;
+    }
+    node.box = nodeBox;
+  }
+}
+
+void BoundingVolumeHierarchy::queryFrustum(const Frustum& frustum,
+                                           std::vector<size_t>& items) const {
+  if (_nodes.empty()) {
+    return;
+  }
+
+  // Nodes to visit, with the planes they may cross (the children of a node
+  // inside a plane are inside it too)
+  constexpr uint8_t ALL_PLANES = (1 << 6) - 1;
+  std::vector<std::pair<uint32_t, uint8_t>> stack = {{0, ALL_PLANES}};
+  while (!stack.empty()) {
+    const auto [nodeIndex, parentPlanes] = stack.back();
+    stack.pop_back();
+    const auto& node = _nodes[nodeIndex];
+
+    uint8_t planes = parentPlanes;
+    bool isOutside = false;
+    for (size_t i = 0; i < frustum.planes.size() && !isOutside; i++) {
+      if (planes & (1 << i)) {
+        float nearDistance, farDistance;
+        getPlaneDistances(frustum.planes[i], node.box, nearDistance,
+                          farDistance);
+        isOutside = farDistance < 0.0f;
+        if (nearDistance >= 0.0f) {
+          planes &= ~(1 << i);
+        }
+      }
+    }
+    if (isOutside) {
+      continue;
+    }
+
+    if (planes == 0) {
+      _collectItems(nodeIndex, items);
+    } else if (node.count > 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        const auto& itemBox = _itemBoxes[_items[i]];
+        bool isInside = true;
+        for (size_t j = 0; j < frustum.planes.size() && isInside; j++) {
+          float nearDistance, farDistance;
+          getPlaneDistances(frustum.planes[j], itemBox, nearDistance,
+                            farDistance);
+          isInside = !(planes & (1 << j)) || farDistance >= 0.0f;
+        }
+        if (isInside) {
+          items.push_back(_items[i]);
+        }
+      }
+    } else {
+      stack.emplace_back(node.first, planes);
+      stack.emplace_back(node.first + 1, planes);
+    }
+  }
+}
+
+void BoundingVolumeHierarchy::queryBox(const BoundingBox& box,
+                                       std::vector<size_t>& items) const {
+  if (_nodes.empty()) {
+    return;
+  }
+
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    const auto& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!node.box.intersects(box)) {
+      continue;
+    }
+    if (node.count > 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        if (_itemBoxes[_items[i]].intersects(box)) {
+          items.push_back(_items[i]);
+        }
+      }
+    } else {
+      stack.push_back(node.first);
+      stack.push_back(node.first + 1);
+    }
+  }
+}
+
+void BoundingVolumeHierarchy::querySphere(const glm::vec3& center,
+                                          float radius,
+                                          std::vector<size_t>& items) const {
+  if (_nodes.empty()) {
+    return;
+  }
+
+  // Squared distance from the center to the closest point of a box
+  const float squaredRadius = radius * radius;
+  const auto intersects = [&](const BoundingBox& box) {
+    const auto offset = center - glm::clamp(center, box.min, box.max);
+    return glm::dot(offset, offset) <= squaredRadius;
+  };
+
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    const auto& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!intersects(node.box)) {
+      continue;
+    }
+    if (node.count > 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        if (intersects(_itemBoxes[_items[i]])) {
+          items.push_back(_items[i]);
+        }
+      }
+    } else {
+      stack.push_back(node.first);
+      stack.push_back(node.first + 1);
+    }
+  }
+}
+
+void BoundingVolumeHierarchy::queryRay(const glm::vec3& origin,
+                                       const glm::vec3& direction,
+                                       float maxDistance,
+                                       std::vector<size_t>& items) const {
+  if (_nodes.empty()) {
+    return;
+  }
+
+  // Infinite for null coordinates, which the slab test handles
+  const auto inverseDirection = 1.0f / direction;
+
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    const auto& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!intersectRay(node.box, origin, inverseDirection, maxDistance)) {
+      continue;
+    }
+    if (node.count > 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        if (intersectRay(_itemBoxes[_items[i]], origin, inverseDirection,
+                         maxDistance)) {
+          items.push_back(_items[i]);
+        }
+      }
+    } else {
+      stack.push_back(node.first);
+      stack.push_back(node.first + 1);
+    }
+  }
+}
+
+size_t BoundingVolumeHierarchy::getItemCount() const {
+  return _items.size();
+}
+
+BoundingBox BoundingVolumeHierarchy::getBoundingBox() const {
+  return _nodes.empty() ? BoundingBox() : _nodes.front().box;
+}
+
+float BoundingVolumeHierarchy::getCost() const {
+  if (_nodes.empty()) {
+    return 0.0f;
+  }
+
+  // Sum of the costs of the nodes weighted by their chance of being visited
+  const float rootArea = _nodes.front().box.getSurfaceArea();
+  if (rootArea <= 0.0f) {
+    return static_cast<float>(_items.size());
+  }
+  float cost = 0.0f;
+  for (const auto& node : _nodes) {
+    const float chance = node.box.getSurfaceArea() / rootArea;
+    cost += chance * (node.count > 0 ? node.count : TRAVERSAL_COST);
+  }
+  return cost;
+}
+
+void BoundingVolumeHierarchy::_collectItems(uint32_t nodeIndex,
+                                            std::vector<size_t>& items) const {
+  const auto& node = _nodes[nodeIndex];
+  if (node.count > 0) {
+    items.insert(items.end(), _items.begin() + node.first,
+                 _items.begin() + node.first + node.count);
+  } else {
+    _collectItems(node.first, items);
+    _collectItems(node.first + 1, items);
+  }
+}
@@ -0,0 +1,157 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_HPP
+#define BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../frustum_culler.hpp"
+
+/**
+ * Axis-aligned bounding box (empty by default).
+ */
+struct BoundingBox {
+  glm::vec3 min = glm::vec3(FLT_MAX);
+  glm::vec3 max = glm::vec3(-FLT_MAX);
+
+  /**
+   * Grows the box to contain another one.
+   */
+  void extend(const BoundingBox& box);
+
+  /**
+   * Grows the box to contain a point.
+   */
+  void extend(const glm::vec3& point);
+
+  /**
+   * Gets the area of the box's faces (0 if empty).
+   */
+  float getSurfaceArea() const;
+
+  /**
+   * Checks whether the box overlaps another one (touching counts).
+   */
+  bool intersects(const BoundingBox& box) const;
+
+  bool operator==(const BoundingBox& box) const;
+};
+
+/**
+ * Bounding volume hierarchy over items (e.g. the objects of a scene) given by
+ * their index and bounding box, for queries in logarithmic rather than linear
+ * time. Built top-down with the surface area heuristic; moving items are
+ * refitted in place (their leaf and its ancestors grow or shrink), which keeps
+ * queries correct but loses quality as they move far away, so trees of moving
+ * items should stay small or be rebuilt from time to time.
+ */
+class BoundingVolumeHierarchy {
+ public:
+  /**
+   * Builds the hierarchy of some items, replacing the previous one.
+   * @param items  Indices of the items
+   * @param boxes  Bounding boxes of all the items, by index (only the boxes of
+   * the given items are read)
+   */
+  void build(const std::vector<size_t>& items,
+             const std::vector<BoundingBox>& boxes);
+
+  /**
+   * Updates the bounding box of an item of the hierarchy, refitting its
+   * ancestors.
+   * @param item  Index of the item
+   * @param box   New bounding box of the item
+   */
+  void refit(size_t item, const BoundingBox& box);
+
+  /**
+   * Appends the items whose bounding box intersects a frustum.
+   */
+  void queryFrustum(const Frustum& frustum, std::vector<size_t>& items) const;
+
+  /**
+   * Appends the items whose bounding box intersects a box.
+   */
+  void queryBox(const BoundingBox& box, std::vector<size_t>& items) const;
+
+  /**
+   * Appends the items whose bounding box intersects a sphere.
+   */
+  void querySphere(const glm::vec3& center,
+                   float radius,
+                   std::vector<size_t>& items) const;
+
+  /**
+   * Appends the items whose bounding box a ray crosses.
+   * @param origin       Origin of the ray
+   * @param direction    Direction of the ray (not necessarily normalized)
+   * @param maxDistance  Length of the ray, in lengths of direction
+   * @param items        Items to append to
+   */
+  void queryRay(const glm::vec3& origin,
+                const glm::vec3& direction,
+                float maxDistance,
+                std::vector<size_t>& items) const;
+
+  /**
+   * Gets the number of items of the hierarchy.
+   */
+  size_t getItemCount() const;
+
+  /**
+   * Gets the bounding box of all the items.
+   */
+  BoundingBox getBoundingBox() const;
+
+  /**
+   * Gets the expected cost of a query in the surface area heuristic, relative
+   * to testing one item (grows as refitted items move).
+   */
+  float getCost() const;
+
+  // Maximal number of items of a leaf
+  static constexpr size_t MAX_LEAF_SIZE = 4;
+  // Number of bins the split candidates are evaluated with, per axis
+  static constexpr size_t BIN_COUNT = 16;
+  // Cost of visiting a node, relative to testing one item
+  static constexpr float TRAVERSAL_COST = 1.0f;
+
+ private:
+  /**
+   * Node of the hierarchy, the root being the first one. Children of a node
+   * are consecutive.
+   */
+  struct Node {
+    BoundingBox box;       // Bounds of the node's items
+    uint32_t first = 0;    // First child (inner node) or item (leaf)
+    uint32_t count = 0;    // Number of items (0 for inner nodes)
+    uint32_t parent = 0;   // Parent (the root being its own)
+  };
+
+  /**
+   * Builds the subtree of a node, splitting its items where the surface area
+   * heuristic is the lowest.
+   * @param nodeIndex  Node to build
+   * @param first      First item of the node (in _items)
+   * @param count      Number of items of the node
+   * @param centers    Centers of the boxes of all the items, by index
+   */
+  void _buildNode(uint32_t nodeIndex,
+                  uint32_t first,
+                  uint32_t count,
+                  const std::vector<glm::vec3>& centers);
+
+  /**
+   * Appends all the items of a subtree.
+   */
+  void _collectItems(uint32_t nodeIndex, std::vector<size_t>& items) const;
+
+  std::vector<Node> _nodes;              // Nodes, the root being the first
+  std::vector<size_t> _items;            // Indices of the items, by leaf
+  std::vector<BoundingBox> _itemBoxes;   // Boxes of the items, by index
+  std::vector<uint32_t> _itemLeaves;     // Leaves of the items, by index
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "../gl_wrappers/vertex_buffer_object.hpp"
+
+#include "geometry_arena.hpp"
+
+GeometryPool::GeometryPool(size_t index,
+                           const VertexLayout& layout,
+                           GLenum indexType)
+    : _index(index), _layout(layout), _indexType(indexType) {
+  glGenVertexArrays(1, &_vertexArrayID);
+}
+
+GeometryPool::~GeometryPool() {
+  deleteBuffers();
+}
+
+GeometryRange GeometryPool::allocate(const void* vertexData,
+                                     size_t vertexCount,
+                                     const GLuint* indexData,
+                                     size_t indexCount) {
+  GeometryRange range;
+  range.pool = this;
+  range.vertexCount = vertexCount;
+  range.indexCount = indexCount;
+
+  // Make room for the mesh
+  if (!_vertexRanges.allocate(vertexCount, range.baseVertex)) {
+    _growBuffer(_vertexBufferID, _vertexRanges, vertexCount, _layout.stride,
+                INITIAL_VERTEX_COUNT);
+    _vertexRanges.allocate(vertexCount, range.baseVertex);
+  }
+  if (!_indexRanges.allocate(indexCount, range.firstIndex)) {
+    _growBuffer(_indexBufferID, _indexRanges, indexCount, getIndexSize(),
+                INITIAL_INDEX_COUNT);
+    _indexRanges.allocate(indexCount, range.firstIndex);
+  }
+
+  // Copy it in its range (through the copy target, which belongs to no VAO)
+  glBindBuffer(GL_COPY_WRITE_BUFFER, _vertexBufferID);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, range.baseVertex * _layout.stride,
+                  vertexCount * _layout.stride, vertexData);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, _indexBufferID);
+  if (_indexType == GL_UNSIGNED_INT) {
+    glBufferSubData(GL_COPY_WRITE_BUFFER, range.firstIndex * sizeof(GLuint),
+                    indexCount * sizeof(GLuint), indexData);
+  } else {
+    // Narrow indices to 16 bits
+    std::vector<GLushort> shortIndices(indexData, indexData + indexCount);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, range.firstIndex * sizeof(GLushort),
+                    indexCount * sizeof(GLushort), shortIndices.data());
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  return range;
+}
+
+void GeometryPool::free(const GeometryRange& range) {
+  _vertexRanges.free(range.baseVertex, range.vertexCount);
+  _indexRanges.free(range.firstIndex, range.indexCount);
+}
+
+void GeometryPool::deleteBuffers() {
+  if (_vertexArrayID == 0) {
+    return;
+  }
+
+  glDeleteVertexArrays(1, &_vertexArrayID);
+  glDeleteBuffers(1, &_vertexBufferID);
+  glDeleteBuffers(1, &_indexBufferID);
+  _vertexArrayID = _vertexBufferID = _indexBufferID = 0;
+}
+
+size_t GeometryPool::getIndex() const {
+  return _index;
+}
+
+const VertexLayout& GeometryPool::getLayout() const {
+  return _layout;
+}
+
+GLuint GeometryPool::getVertexArrayID() const {
+  return _vertexArrayID;
+}
+
+GLenum GeometryPool::getIndexType() const {
+  return _indexType;
+}
+
+size_t GeometryPool::getIndexSize() const {
+  return _indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+void GeometryPool::_growBuffer(GLuint& bufferID,
+                               RangeAllocator& allocator,
+                               size_t count,
+                               size_t size,
+                               size_t minCount) {
+  // At least double, so that growing stays rare
+  const auto oldCapacity = allocator.getCapacity();
+  const auto capacity = std::max(
+      {oldCapacity * 2, oldCapacity + count, minCount});
+
+  GLuint newBufferID;
+  glGenBuffers(1, &newBufferID);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+  glBufferData(GL_COPY_WRITE_BUFFER, capacity * size, nullptr, GL_STATIC_DRAW);
+  if (bufferID != 0) {
+    glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                        oldCapacity * size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glDeleteBuffers(1, &bufferID);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  std::cout << "Grew geometry pool " << _index << " buffer (ID: " << newBufferID
+            << ", " << capacity * size << " bytes)\n";
+  bufferID = newBufferID;
+  allocator.grow(capacity);
+  _setUpVertexArray();
+}
+
+void GeometryPool::_setUpVertexArray() {
+  glBindVertexArray(_vertexArrayID);
+  if (_vertexBufferID != 0) {
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferID);
+    _layout.apply();
+  }
+  if (_indexBufferID != 0) {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferID);  // Stays bound
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GeometryArena& GeometryArena::getInstance() {
+  static GeometryArena arena;
+  return arena;
+}
+
+GeometryRange GeometryArena::allocate(const void* vertexData,
+                                      size_t vertexCount,
+                                      const VertexLayout& layout,
+                                      const GLuint* indexData,
+                                      size_t indexCount) {
+  // Indices are relative to the mesh, so small meshes keep 16 bits indices
+  const auto indexType = VertexBufferObject::getIndexType(vertexCount);
+  auto pool = std::find_if(_pools.begin(), _pools.end(),
+                           [&layout, indexType](const auto& pool) {
+                             return &pool->getLayout() == &layout &&
+                                    pool->getIndexType() == indexType;
+                           });
+  if (pool == _pools.end()) {
+    if (_pools.size() == MAX_POOL_COUNT) {
+      throw std::runtime_error("Too many geometry pools");
+    }
+    _pools.push_back(
+        std::make_unique<GeometryPool>(_pools.size(), layout, indexType));
+    pool = _pools.end() - 1;
+  }
+
+  return (*pool)->allocate(vertexData, vertexCount, indexData, indexCount);
+}
+
+void GeometryArena::free(const GeometryRange& range) {
+  if (range.pool != nullptr) {
+    range.pool->free(range);
+  }
+}
+
+void GeometryArena::clear() {
+  for (const auto& pool : _pools) {
+    pool->deleteBuffers();
+  }
+}
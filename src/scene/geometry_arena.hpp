@@ -0,0 +1,199 @@
+#ifndef GEOMETRY_ARENA_HPP
+#define GEOMETRY_ARENA_HPP
+
+#include <memory>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "../utils/range_allocator.hpp"
+#include "vertex_layout.hpp"
+
+class GeometryPool;
+
+/**
+ * Range of a mesh in a geometry pool.
+ */
+struct GeometryRange {
+  GeometryPool* pool = nullptr;  // Pool holding the mesh (nullptr if none)
+  size_t baseVertex = 0;         // First vertex of the mesh
+  size_t vertexCount = 0;        // Number of vertices
+  size_t firstIndex = 0;         // First index of the mesh
+  size_t indexCount = 0;         // Number of indices (relative to baseVertex)
+};
+
+/**
+ * Draw command of glMultiDrawElementsIndirect.
+ */
+struct DrawElementsIndirectCommand {
+  GLuint count;          // Number of indices
+  GLuint instanceCount;  // Number of instances
+  GLuint firstIndex;     // First index in the index buffer
+  GLint baseVertex;      // Added to the indices
+  GLuint baseInstance;   // First element of the per instance attributes
+};
+
+/**
+ * Vertices and indices of all the meshes sharing a vertex layout and an index
+ * type, in a single VBO and IBO pair bound to a single VAO. Meshes get ranges
+ * of the buffers, which grow (by copying them on the GPU) when full.
+ */
+class GeometryPool {
+ public:
+  /**
+   * Creates the pool, with empty buffers.
+   * @param index      Index of the pool in the arena
+   * @param layout     Layout of the vertices (must outlive the pool)
+   * @param indexType  Type of the indices (GL_UNSIGNED_SHORT or
+   * GL_UNSIGNED_INT)
+   */
+  GeometryPool(size_t index, const VertexLayout& layout, GLenum indexType);
+
+  /**
+   * Deletes the buffers and the VAO.
+   */
+  ~GeometryPool();
+
+  // Disable copy constructor
+  GeometryPool(const GeometryPool&) = delete;
+  GeometryPool& operator=(const GeometryPool&) = delete;
+
+  /**
+   * Copies a mesh into the pool.
+   * @param vertexData   Pointer to the first vertex (in the pool's layout)
+   * @param vertexCount  Number of vertices
+   * @param indexData    Pointer to the first index (relative to the mesh)
+   * @param indexCount   Number of indices
+   * @return Range of the mesh
+   */
+  GeometryRange allocate(const void* vertexData,
+                         size_t vertexCount,
+                         const GLuint* indexData,
+                         size_t indexCount);
+
+  /**
+   * Frees the range of a mesh, for other meshes to reuse.
+   */
+  void free(const GeometryRange& range);
+
+  /**
+   * Deletes the buffers and the VAO (e.g. before the OpenGL context), ranges
+   * can still be freed afterwards.
+   */
+  void deleteBuffers();
+
+  /**
+   * Gets the index of the pool in the arena.
+   */
+  size_t getIndex() const;
+
+  /**
+   * Gets the layout of the vertices.
+   */
+  const VertexLayout& getLayout() const;
+
+  /**
+   * Gets OpenGL-assigned ID of the VAO drawing the pool's meshes.
+   */
+  GLuint getVertexArrayID() const;
+
+  /**
+   * Gets the type of the indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+   */
+  GLenum getIndexType() const;
+
+  /**
+   * Gets the size of an index, in bytes.
+   */
+  size_t getIndexSize() const;
+
+  // Number of elements the buffers are created with
+  static constexpr size_t INITIAL_VERTEX_COUNT = 1 << 16;
+  static constexpr size_t INITIAL_INDEX_COUNT = 1 << 18;
+
+ private:
+  /**
+   * Grows a buffer to fit a range, copying its content to a new, larger one.
+   * @param bufferID   ID of the buffer (replaced)
+   * @param allocator  Allocator of the buffer's elements
+   * @param count      Number of elements of the range to fit
+   * @param size       Size of an element (in bytes)
+   * @param minCount   Minimal number of elements of the buffer
+   */
+  void _growBuffer(GLuint& bufferID,
+                   RangeAllocator& allocator,
+                   size_t count,
+                   size_t size,
+                   size_t minCount);
+
+  /**
+   * Binds the buffers to the VAO.
+   */
+  void _setUpVertexArray();
+
+  size_t _index;                 // Index in the arena
+  const VertexLayout& _layout;   // Layout of the vertices
+  GLenum _indexType;             // Type of the indices
+  GLuint _vertexArrayID = 0;     // OpenGL-assigned VAO ID
+  GLuint _vertexBufferID = 0;    // OpenGL-assigned VBO ID
+  GLuint _indexBufferID = 0;     // OpenGL-assigned IBO ID
+  RangeAllocator _vertexRanges;  // Vertices handed out
+  RangeAllocator _indexRanges;   // Indices handed out
+};
+
+/**
+ * Singleton class holding the geometry of all the meshes, in one pool per
+ * vertex layout and index type. Meshes of a pool are drawn without switching
+ * VAOs, and can be drawn by a single multi-draw call.
+ */
+class GeometryArena {
+ public:
+  /**
+   * Gets the one and only instance of the geometry arena.
+   */
+  static GeometryArena& getInstance();
+
+  /**
+   * Copies a mesh into the pool of its layout and index type.
+   * @param vertexData   Pointer to the first vertex
+   * @param vertexCount  Number of vertices
+   * @param layout       Layout of the vertices (must outlive the arena, e.g.
+   * PackedGeometry::getLayout())
+   * @param indexData    Pointer to the first index
+   * @param indexCount   Number of indices
+   * @return Range of the mesh
+   */
+  GeometryRange allocate(const void* vertexData,
+                         size_t vertexCount,
+                         const VertexLayout& layout,
+                         const GLuint* indexData,
+                         size_t indexCount);
+
+  /**
+   * Frees the range of a mesh (if it has one).
+   */
+  void free(const GeometryRange& range);
+
+  /**
+   * Deletes the buffers of all the pools (before the OpenGL context is
+   * destroyed).
+   */
+  void clear();
+
+  // Maximal number of pools (indexed on 3 bits by the render queue)
+  static constexpr size_t MAX_POOL_COUNT = 8;
+
+ private:
+  // Private constructor to make class singleton
+  GeometryArena() = default;
+
+  // No copy constructor allowed
+  GeometryArena(const GeometryArena&) = delete;
+
+  // No copy assignment allowed
+  void operator=(const GeometryArena&) = delete;
+
+  std::vector<std::unique_ptr<GeometryPool>> _pools;  // Pools, by index
+};
+
+#endif
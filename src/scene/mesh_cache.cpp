@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "../utils/hash_utils.hpp"
+
+#include "mesh_cache.hpp"
+#include "obj_parser.hpp"
+
+// Vertices are handed straight from the mapped file to OpenGL
+static_assert(std::is_trivially_copyable<Vertex>::value,
+              "Vertex must be trivially copyable to be cached");
+
+// Alignment of the vertex and index blocks inside the cache file
+static const uint64_t DATA_ALIGNMENT = 16;
+
+static uint64_t alignOffset(uint64_t offset, uint64_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+constexpr char MeshCache::MAGIC[8];
+
+bool MeshCache::open(const std::string& modelName, float normalCreaseAngle) {
+  close();
+
+  const auto cacheFilePath = getCacheFilePath(modelName);
+  if (!_file.open(cacheFilePath)) {
+    return false;
+  }
+
+  const auto data = _file.getData();
+  const auto size = _file.getSize();
+
+  // Check header
+  if (size < sizeof(Header)) {
+    close();
+    return false;
+  }
+  Header header;
+  memcpy(&header, data, sizeof(Header));
+  if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != FORMAT_VERSION || header.vertexSize != sizeof(Vertex) ||
+      header.normalCreaseAngle != normalCreaseAngle) {
+    std::cout << "Mesh cache of " << modelName << " is outdated\n";
+    close();
+    return false;
+  }
+  if (header.sourceHash != computeSourceHash(modelName)) {
+    std::cout << "Mesh cache of " << modelName
+              << " doesn't match its source files\n";
+    close();
+    return false;
+  }
+
+  // Read material records
+  const uint64_t recordsEnd =
+      sizeof(Header) + uint64_t(header.materialCount) * sizeof(MaterialRecord);
+  if (recordsEnd > size) {
+    close();
+    return false;
+  }
+  for (uint32_t i = 0; i < header.materialCount; i++) {
+    MaterialRecord record;
+    memcpy(&record, data + sizeof(Header) + i * sizeof(MaterialRecord),
+           sizeof(MaterialRecord));
+
+    // Check that referenced data is inside the file
+    const auto vertexDataSize = record.vertexCount * sizeof(Vertex);
+    const auto indexDataSize = record.indexCount * sizeof(GLuint);
+    if (record.textureFilenameOffset + record.textureFilenameLength > size ||
+        record.vertexDataOffset + vertexDataSize > size ||
+        record.vertexDataOffset % DATA_ALIGNMENT != 0 ||
+        record.indexDataOffset + indexDataSize > size ||
+        record.indexDataOffset % DATA_ALIGNMENT != 0 || record.lodCount == 0 ||
+        record.lodCount > MAX_LOD_COUNT) {
+      std::cerr << "Mesh cache of " << modelName << " is corrupted\n";
+      close();
+      return false;
+    }
+
+    shader_structs::Material material(
+        glm::vec3(record.ambient[0], record.ambient[1], record.ambient[2]),
+        glm::vec3(record.diffuse[0], record.diffuse[1], record.diffuse[2]),
+        glm::vec3(record.specular[0], record.specular[1], record.specular[2]),
+        record.shininess);
+    std::string textureFilename(
+        reinterpret_cast<const char*>(data + record.textureFilenameOffset),
+        record.textureFilenameLength);
+    const auto vertices =
+        reinterpret_cast<const Vertex*>(data + record.vertexDataOffset);
+    const auto indices =
+        reinterpret_cast<const GLuint*>(data + record.indexDataOffset);
+
+    // Levels of detail follow each other in the indices
+    std::vector<MeshLod> lods;
+    size_t lodIndexOffset = 0;
+    for (uint32_t l = 0; l < record.lodCount; l++) {
+      lods.push_back(
+          {lodIndexOffset, record.lodIndexCounts[l], record.lodErrors[l]});
+      lodIndexOffset += record.lodIndexCounts[l];
+    }
+    if (lodIndexOffset > record.indexCount) {
+      std::cerr << "Mesh cache of " << modelName << " is corrupted\n";
+      close();
+      return false;
+    }
+
+    _materialBlocks.push_back({material, textureFilename, vertices,
+                               static_cast<size_t>(record.vertexCount),
+                               indices, static_cast<size_t>(record.indexCount),
+                               std::move(lods)});
+  }
+
+  return true;
+}
+
+void MeshCache::close() {
+  _materialBlocks.clear();
+  _file.close();
+}
+
+const std::vector<MeshCache::MaterialBlock>& MeshCache::getMaterialBlocks()
+    const {
+  return _materialBlocks;
+}
+
+bool MeshCache::write(const std::string& modelName,
+                      const std::vector<MaterialBlock>& materialBlocks,
+                      float normalCreaseAngle) {
+  // Header
+  Header header;
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = FORMAT_VERSION;
+  header.vertexSize = sizeof(Vertex);
+  header.materialCount = static_cast<uint32_t>(materialBlocks.size());
+  header.normalCreaseAngle = normalCreaseAngle;
+  header.sourceHash = computeSourceHash(modelName);
+
+  // Compute where each material's data will be
+  std::vector<MaterialRecord> records;
+  uint64_t offset =
+      sizeof(Header) + materialBlocks.size() * sizeof(MaterialRecord);
+  for (const auto& block : materialBlocks) {
+    MaterialRecord record;
+    memcpy(record.ambient, &block.material.ambient, sizeof(record.ambient));
+    memcpy(record.diffuse, &block.material.diffuse, sizeof(record.diffuse));
+    memcpy(record.specular, &block.material.specular, sizeof(record.specular));
+    record.shininess = block.material.shininess;
+    record.textureFilenameLength =
+        static_cast<uint32_t>(block.textureFilename.size());
+    record.reserved = 0;
+    record.textureFilenameOffset = offset;
+    offset += block.textureFilename.size();
+
+    // Without levels of detail, the full detail one spans all the indices (and
+    // extra levels are dropped, their indices simply being unused)
+    std::vector<MeshLod> lods = block.lods;
+    if (lods.empty()) {
+      lods.push_back({0, block.indexCount, 0.0f});
+    }
+    lods.resize(std::min<size_t>(lods.size(), MAX_LOD_COUNT));
+    record.lodCount = static_cast<uint32_t>(lods.size());
+    for (uint32_t l = 0; l < MAX_LOD_COUNT; l++) {
+      record.lodIndexCounts[l] =
+          l < lods.size() ? static_cast<uint32_t>(lods[l].indexCount) : 0;
+      record.lodErrors[l] = l < lods.size() ? lods[l].error : 0.0f;
+    }
+    record.reserved2 = 0;
+    records.push_back(record);
+  }
+  for (size_t i = 0; i < materialBlocks.size(); i++) {
+    offset = alignOffset(offset, DATA_ALIGNMENT);
+    records[i].vertexCount = materialBlocks[i].vertexCount;
+    records[i].vertexDataOffset = offset;
+    offset += materialBlocks[i].vertexCount * sizeof(Vertex);
+
+    offset = alignOffset(offset, DATA_ALIGNMENT);
+    records[i].indexCount = materialBlocks[i].indexCount;
+    records[i].indexDataOffset = offset;
+    offset += materialBlocks[i].indexCount * sizeof(GLuint);
+  }
+
+  // Write to a temporary file first, so that a partially written cache is
+  // never picked up (unique per thread, as a model may be loaded concurrently)
+  const auto cacheFilePath = getCacheFilePath(modelName);
+  const auto threadHash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto tempFilePath =
+      cacheFilePath + "." + std::to_string(threadHash) + ".tmp";
+  std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+  if (!file.good()) {
+    std::cerr << "Unable to write mesh cache: " << cacheFilePath << "\n";
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char*>(records.data()),
+             records.size() * sizeof(MaterialRecord));
+  for (const auto& block : materialBlocks) {
+    file.write(block.textureFilename.data(), block.textureFilename.size());
+  }
+  const char padding[DATA_ALIGNMENT] = {};
+  for (size_t i = 0; i < materialBlocks.size(); i++) {
+    auto position = static_cast<uint64_t>(file.tellp());
+    file.write(padding, records[i].vertexDataOffset - position);
+    file.write(reinterpret_cast<const char*>(materialBlocks[i].vertices),
+               materialBlocks[i].vertexCount * sizeof(Vertex));
+
+    position = static_cast<uint64_t>(file.tellp());
+    file.write(padding, records[i].indexDataOffset - position);
+    file.write(reinterpret_cast<const char*>(materialBlocks[i].indices),
+               materialBlocks[i].indexCount * sizeof(GLuint));
+  }
+  file.close();
+
+  if (!file.good()) {
+    std::cerr << "Unable to write mesh cache: " << cacheFilePath << "\n";
+    std::remove(tempFilePath.c_str());
+    return false;
+  }
+
+  // Replace previous cache (rename doesn't overwrite on every platform)
+  std::remove(cacheFilePath.c_str());
+  if (std::rename(tempFilePath.c_str(), cacheFilePath.c_str()) != 0) {
+    std::cerr << "Unable to write mesh cache: " << cacheFilePath << "\n";
+    std::remove(tempFilePath.c_str());
+    return false;
+  }
+
+  std::cout << "Written mesh cache: " << cacheFilePath << "\n";
+  return true;
+}
+
+std::string MeshCache::getCacheFilePath(const std::string& modelName) {
+  return "models/" + modelName + "/model.meshcache";
+}
+
+uint64_t MeshCache::computeSourceHash(const std::string& modelName) {
+  uint64_t hash = hash_utils::FNV_OFFSET_BASIS;
+
+  // The OBJ file, then the MTL files it references
+  const auto objFilePath = "models/" + modelName + "/model.obj";
+  std::vector<std::string> sourceFilePaths;
+  ObjParser::findMaterialLibraries(objFilePath, sourceFilePaths);
+  sourceFilePaths.insert(sourceFilePaths.begin(), objFilePath);
+  for (const auto& sourceFilePath : sourceFilePaths) {
+    MappedFile sourceFile;
+    if (!sourceFile.open(sourceFilePath)) {
+      // Missing files also count in the hash, so that adding one invalidates
+      const uint64_t missingMarker = UINT64_MAX;
+      hash = hash_utils::fnv1a64(&missingMarker, sizeof(missingMarker), hash);
+      continue;
+    }
+
+    // Include size, so that moving bytes between files changes the hash
+    const uint64_t size = sourceFile.getSize();
+    hash = hash_utils::fnv1a64(&size, sizeof(size), hash);
+    hash =
+        hash_utils::fnv1a64(sourceFile.getData(), sourceFile.getSize(), hash);
+  }
+
+  return hash;
+}
@@ -0,0 +1,132 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "../shader_structs/material.hpp"
+#include "../utils/mapped_file.hpp"
+#include "mesh_lod.hpp"
+#include "vertex.hpp"
+
+/**
+ * Binary cache of a model's meshes, written next to the model's OBJ file the
+ * first time it is loaded and memory-mapped on later runs.
+ *
+ * Layout of a cache file:
+ * - Header (magic, format version, vertex size, normal crease angle, source
+ *   hash)
+ * - One MaterialRecord per material (material, texture name, vertex and index
+ *   blocks, levels of detail)
+ * - Texture names and 16 bytes aligned vertex and index blocks, referenced by
+ *   offset
+ *
+ * The cache is invalidated when the format version, the vertex layout, the
+ * crease angle of the generated normals or the content of the model's OBJ/MTL
+ * files change.
+ */
+class MeshCache {
+ public:
+  /**
+   * View of a material and its indexed vertices.
+   * When read from a cache, pointers refer to the memory-mapped file and are
+   * only valid while the cache is open.
+   */
+  struct MaterialBlock {
+    shader_structs::Material material;
+    std::string textureFilename;
+    const Vertex* vertices;
+    size_t vertexCount;
+    const GLuint* indices;
+    size_t indexCount;  // Number of indices of all the levels of detail
+    std::vector<MeshLod> lods;  // Levels of detail, one after the other in the
+                                // indices (a single one if empty)
+  };
+
+  /**
+   * Opens the cache of the given model, if it exists and is up to date.
+   * @param modelName          Name of the model
+   * @param normalCreaseAngle  Crease angle the missing normals must have been
+   * generated with
+   * @return True if the cache has been opened, false if it's missing or stale
+   */
+  bool open(const std::string& modelName, float normalCreaseAngle);
+
+  /**
+   * Closes the cache (invalidating all the pointers it handed out).
+   */
+  void close();
+
+  /**
+   * Gets the material blocks read from the cache.
+   */
+  const std::vector<MaterialBlock>& getMaterialBlocks() const;
+
+  /**
+   * Writes the cache of the given model.
+   * @param modelName          Name of the model
+   * @param materialBlocks     Materials and indexed vertices of the model
+   * @param normalCreaseAngle  Crease angle the missing normals have been
+   * generated with
+   * @return True if the cache has been written, false otherwise
+   */
+  static bool write(const std::string& modelName,
+                    const std::vector<MaterialBlock>& materialBlocks,
+                    float normalCreaseAngle);
+
+  /**
+   * Gets path of the cache file of the given model.
+   */
+  static std::string getCacheFilePath(const std::string& modelName);
+
+  /**
+   * Computes the hash of the source files of the given model: its OBJ file
+   * and the MTL files it references.
+   */
+  static uint64_t computeSourceHash(const std::string& modelName);
+
+  // Version of the file format, to increase when the layout changes (or when
+  // meshes are processed differently before being cached)
+  static constexpr uint32_t FORMAT_VERSION = 6;
+
+  // Maximal number of levels of detail of a material (full detail included)
+  static constexpr uint32_t MAX_LOD_COUNT = 4;
+
+ private:
+  MappedFile _file;
+  std::vector<MaterialBlock> _materialBlocks;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertexSize;
+    uint32_t materialCount;
+    float normalCreaseAngle;
+    uint64_t sourceHash;
+  };
+
+  struct MaterialRecord {
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float shininess;
+    uint32_t textureFilenameLength;
+    uint32_t reserved;
+    uint64_t textureFilenameOffset;
+    uint64_t vertexCount;
+    uint64_t vertexDataOffset;
+    uint64_t indexCount;
+    uint64_t indexDataOffset;
+    uint32_t lodCount;
+    uint32_t lodIndexCounts[MAX_LOD_COUNT];
+    float lodErrors[MAX_LOD_COUNT];
+    uint32_t reserved2;
+  };
+
+  static constexpr char MAGIC[8] = {'E', 'V', 'G', 'L', 'M', 'S', 'H', '\0'};
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef MESH_LOD_HPP
+#define MESH_LOD_HPP
+
+#include <cstddef>
+
+/**
+ * Level of detail of a mesh: range of its index buffer (all levels share the
+ * same vertices) and how far its surface is from the full detail one.
+ */
+struct MeshLod {
+  size_t indexOffset = 0;  // First index of the level
+  size_t indexCount = 0;   // Number of indices of the level
+  float error = 0.0f;      // Simplification error (in model units)
+};
+
+#endif
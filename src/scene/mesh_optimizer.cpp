@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "mesh_optimizer.hpp"
+
+// Size of the LRU cache modeled by the vertex cache optimization
+static const size_t MODELED_CACHE_SIZE = 32;
+
+// Vertex scoring parameters of Forsyth's algorithm
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+/**
+ * Scores a vertex: vertices recently used (still in cache) and vertices with
+ * few remaining triangles (to finish them off) get the highest scores.
+ */
+static float getVertexScore(int cachePosition, uint32_t remainingTriangles) {
+  if (remainingTriangles == 0) {
+    return -1.0f;  // No triangle left to emit
+  }
+
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    if (cachePosition < 3) {
+      // Used by the last triangle, scored lower so that strips don't win over
+      // fans
+      score = LAST_TRIANGLE_SCORE;
+    } else {
+      const float scaler = 1.0f / (MODELED_CACHE_SIZE - 3);
+      score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+    }
+  }
+
+  score += VALENCE_BOOST_SCALE *
+           std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+  return score;
+}
+
+void MeshOptimizer::optimize(std::vector<Vertex>& vertices,
+                             std::vector<GLuint>& indices) {
+  optimizeVertexCache(indices, vertices.size());
+  optimizeOverdraw(indices, vertices);
+  optimizeVertexFetch(vertices, indices);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<GLuint>& indices,
+                                        size_t vertexCount) {
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+
+  // Triangles using each vertex (packed lists, the remaining ones first)
+  std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+  for (const auto index : indices) {
+    remainingTriangles[index]++;
+  }
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; v++) {
+    adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  {
+    auto cursors = adjacencyOffsets;
+    for (size_t i = 0; i < indices.size(); i++) {
+      adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  // Initial scores
+  std::vector<int> cachePositions(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    vertexScores[v] = getVertexScore(-1, remainingTriangles[v]);
+  }
+  std::vector<float> triangleScores(triangleCount);
+  std::vector<bool> isEmitted(triangleCount, false);
+  int64_t bestTriangle = -1;
+  float bestScore = -std::numeric_limits<float>::max();
+  for (size_t t = 0; t < triangleCount; t++) {
+    triangleScores[t] = vertexScores[indices[t * 3]] +
+                        vertexScores[indices[t * 3 + 1]] +
+                        vertexScores[indices[t * 3 + 2]];
+    if (triangleScores[t] > bestScore) {
+      bestScore = triangleScores[t];
+      bestTriangle = static_cast<int64_t>(t);
+    }
+  }
+
+  std::vector<GLuint> result;
+  result.reserve(indices.size());
+  std::vector<GLuint> cache, newCache;
+  size_t nextUnemitted = 0;
+
+  while (result.size() < indices.size()) {
+    // No scored triangle around the cache, take the next one left
+    if (bestTriangle < 0) {
+      while (isEmitted[nextUnemitted]) {
+        nextUnemitted++;
+      }
+      bestTriangle = static_cast<int64_t>(nextUnemitted);
+    }
+
+    // Emit the best triangle
+    const auto triangle = static_cast<size_t>(bestTriangle);
+    isEmitted[triangle] = true;
+    const GLuint* triangleVertices = &indices[triangle * 3];
+    for (int i = 0; i < 3; i++) {
+      const auto v = triangleVertices[i];
+      result.push_back(v);
+
+      // Remove the triangle from the vertex's remaining ones
+      const auto begin = adjacency.begin() + adjacencyOffsets[v];
+      const auto end = begin + remainingTriangles[v];
+      const auto found = std::find(begin, end, static_cast<uint32_t>(triangle));
+      if (found != end) {
+        std::iter_swap(found, end - 1);
+        remainingTriangles[v]--;
+      }
+    }
+
+    // Move the triangle's vertices to the front of the cache
+    newCache.assign(triangleVertices, triangleVertices + 3);
+    for (const auto v : cache) {
+      if (v != triangleVertices[0] && v != triangleVertices[1] &&
+          v != triangleVertices[2]) {
+        newCache.push_back(v);
+      }
+    }
+    for (const auto v : cache) {
+      cachePositions[v] = -1;
+    }
+    for (size_t i = 0; i < newCache.size(); i++) {
+      cachePositions[newCache[i]] =
+          i < MODELED_CACHE_SIZE ? static_cast<int>(i) : -1;
+    }
+
+    // Rescore the vertices whose cache position changed (including the ones
+    // just evicted), then their triangles
+    for (const auto v : newCache) {
+      vertexScores[v] = getVertexScore(cachePositions[v], remainingTriangles[v]);
+    }
+    bestTriangle = -1;
+    bestScore = -std::numeric_limits<float>::max();
+    for (const auto v : newCache) {
+      for (uint32_t i = 0; i < remainingTriangles[v]; i++) {
+        const auto t = adjacency[adjacencyOffsets[v] + i];
+        triangleScores[t] = vertexScores[indices[t * 3]] +
+                            vertexScores[indices[t * 3 + 1]] +
+                            vertexScores[indices[t * 3 + 2]];
+        if (triangleScores[t] > bestScore) {
+          bestScore = triangleScores[t];
+          bestTriangle = t;
+        }
+      }
+    }
+
+    if (newCache.size() > MODELED_CACHE_SIZE) {
+      newCache.resize(MODELED_CACHE_SIZE);
+    }
+    std::swap(cache, newCache);
+  }
+
+  indices.swap(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<GLuint>& indices,
+                                     const std::vector<Vertex>& vertices,
+                                     float threshold) {
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+  const auto originalStatistics = analyzeVertexCache(indices, vertices.size());
+
+  // Split in clusters where the vertex cache restarts (triangle with 3
+  // misses), so that moving clusters around barely affects cache efficiency
+  const size_t cacheSize = 16;
+  std::vector<size_t> clusterStarts;
+  {
+    std::vector<size_t> timestamps(vertices.size(), 0);
+    size_t time = cacheSize + 1;
+    for (size_t t = 0; t < triangleCount; t++) {
+      int misses = 0;
+      for (int i = 0; i < 3; i++) {
+        const auto v = indices[t * 3 + i];
+        if (time - timestamps[v] > cacheSize) {
+          timestamps[v] = time++;
+          misses++;
+        }
+      }
+      if (t == 0 || misses == 3) {
+        clusterStarts.push_back(t);
+      }
+    }
+  }
+  clusterStarts.push_back(triangleCount);
+  const size_t clusterCount = clusterStarts.size() - 1;
+
+  // Area weighted centroid and normal of the mesh and of each cluster
+  std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0));
+  std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0));
+  std::vector<float> clusterAreas(clusterCount, 0.0f);
+  glm::vec3 meshCentroid(0);
+  float meshArea = 0.0f;
+  for (size_t c = 0; c < clusterCount; c++) {
+    for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+      const auto& p0 = vertices[indices[t * 3]].position;
+      const auto& p1 = vertices[indices[t * 3 + 1]].position;
+      const auto& p2 = vertices[indices[t * 3 + 2]].position;
+      const auto normal = glm::cross(p1 - p0, p2 - p0);
+      const auto area = glm::length(normal);
+      const auto centroid = (p0 + p1 + p2) / 3.0f;
+
+      clusterCentroids[c] += centroid * area;
+      clusterNormals[c] += normal;
+      clusterAreas[c] += area;
+      meshCentroid += centroid * area;
+      meshArea += area;
+    }
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+
+  // Clusters facing away from the mesh's center are likely to occlude the
+  // others, so they're drawn first
+  std::vector<float> clusterSortKeys(clusterCount, 0.0f);
+  for (size_t c = 0; c < clusterCount; c++) {
+    const auto normalLength = glm::length(clusterNormals[c]);
+    if (clusterAreas[c] > 0.0f && normalLength > 0.0f) {
+      const auto centroid = clusterCentroids[c] / clusterAreas[c];
+      clusterSortKeys[c] =
+          glm::dot(centroid - meshCentroid, clusterNormals[c] / normalLength);
+    }
+  }
+  std::vector<size_t> clusterOrder(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++) {
+    clusterOrder[c] = c;
+  }
+  std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+                   [&clusterSortKeys](size_t a, size_t b) {
+                     return clusterSortKeys[a] > clusterSortKeys[b];
+                   });
+
+  std::vector<GLuint> result;
+  result.reserve(indices.size());
+  for (const auto c : clusterOrder) {
+    result.insert(result.end(), indices.begin() + clusterStarts[c] * 3,
+                  indices.begin() + clusterStarts[c + 1] * 3);
+  }
+
+  // Only keep the new order if the vertex cache doesn't suffer too much
+  const auto statistics = analyzeVertexCache(result, vertices.size());
+  if (statistics.acmr <= originalStatistics.acmr * threshold) {
+    indices.swap(result);
+  }
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices,
+                                        std::vector<GLuint>& indices) {
+  const auto unassigned = std::numeric_limits<GLuint>::max();
+  std::vector<GLuint> remap(vertices.size(), unassigned);
+  std::vector<Vertex> result;
+  result.reserve(vertices.size());
+
+  for (auto& index : indices) {
+    if (remap[index] == unassigned) {
+      remap[index] = static_cast<GLuint>(result.size());
+      result.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  vertices.swap(result);
+}
+
+MeshOptimizer::CacheStatistics MeshOptimizer::analyzeVertexCache(
+    const std::vector<GLuint>& indices,
+    size_t vertexCount,
+    size_t cacheSize) {
+  CacheStatistics statistics;
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return statistics;
+  }
+
+  // A vertex is in the FIFO cache if less than cacheSize misses happened since
+  // it was transformed
+  std::vector<size_t> timestamps(vertexCount, 0);
+  size_t time = cacheSize + 1;
+  size_t misses = 0;
+  size_t usedVertexCount = 0;
+  for (const auto index : indices) {
+    if (timestamps[index] == 0) {
+      usedVertexCount++;
+    }
+    if (time - timestamps[index] > cacheSize) {
+      timestamps[index] = time++;
+      misses++;
+    }
+  }
+
+  statistics.acmr = static_cast<float>(misses) / triangleCount;
+  statistics.atvr = static_cast<float>(misses) / usedVertexCount;
+  return statistics;
+}
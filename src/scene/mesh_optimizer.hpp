@@ -0,0 +1,80 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "vertex.hpp"
+
+/**
+ * Reorders indexed triangle meshes so that the GPU processes them faster:
+ * - Triangles for post-transform vertex cache locality (Forsyth's algorithm)
+ * - Clusters of triangles so that outer ones are drawn first (less overdraw)
+ * - Vertices in the order triangles use them (vertex fetch locality)
+ */
+class MeshOptimizer {
+ public:
+  /**
+   * Post-transform vertex cache efficiency of a mesh.
+   */
+  struct CacheStatistics {
+    float acmr = 0;  // Average cache miss ratio (transformed vertices per
+                     // triangle, 0.5 at best, 3 at worst)
+    float atvr = 0;  // Average transformed vertex ratio (transformed vertices
+                     // per vertex, 1 at best)
+  };
+
+  /**
+   * Runs all the optimizations on a mesh.
+   * @param vertices  Vertices of the mesh (reordered, unused ones removed)
+   * @param indices   Triangle indices of the mesh (reordered)
+   */
+  static void optimize(std::vector<Vertex>& vertices,
+                       std::vector<GLuint>& indices);
+
+  /**
+   * Reorders triangles so that their vertices are reused while still in the
+   * post-transform cache.
+   * @param indices      Triangle indices to reorder
+   * @param vertexCount  Number of vertices the indices refer to
+   */
+  static void optimizeVertexCache(std::vector<GLuint>& indices,
+                                  size_t vertexCount);
+
+  /**
+   * Reorders clusters of triangles (bounded by vertex cache restarts), so that
+   * the ones facing out of the mesh are drawn first. The new order is only kept
+   * if it keeps the ACMR within the given threshold.
+   * @param indices    Triangle indices to reorder (already optimized for the
+   * vertex cache)
+   * @param vertices   Vertices the indices refer to
+   * @param threshold  Maximal ACMR increase allowed (e.g. 1.05 for 5%)
+   */
+  static void optimizeOverdraw(std::vector<GLuint>& indices,
+                               const std::vector<Vertex>& vertices,
+                               float threshold = 1.05f);
+
+  /**
+   * Reorders vertices in the order triangles first use them, removing unused
+   * vertices.
+   * @param vertices  Vertices to reorder
+   * @param indices   Triangle indices (remapped to the new vertex order)
+   */
+  static void optimizeVertexFetch(std::vector<Vertex>& vertices,
+                                  std::vector<GLuint>& indices);
+
+  /**
+   * Simulates a FIFO post-transform vertex cache to measure its efficiency.
+   * @param indices      Triangle indices
+   * @param vertexCount  Number of vertices the indices refer to
+   * @param cacheSize    Number of vertices the simulated cache holds
+   * @return Efficiency of the cache
+   */
+  static CacheStatistics analyzeVertexCache(const std::vector<GLuint>& indices,
+                                            size_t vertexCount,
+                                            size_t cacheSize = 16);
+};
+
+#endif
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+
+#include "mesh_simplifier.hpp"
+
+// Weight of the planes keeping borders in place, relative to surface planes
+static const double BORDER_WEIGHT = 10.0;
+
+/**
+ * Quadric error: sum of squared distances to a set of weighted planes,
+ * normalized by their total weight.
+ */
+struct SimplifierQuadric {
+  double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+  double b0 = 0, b1 = 0, b2 = 0;
+  double c = 0;
+  double weight = 0;
+
+  void addPlane(const glm::dvec3& normal, double distance, double planeWeight) {
+    a00 += planeWeight * normal.x * normal.x;
+    a01 += planeWeight * normal.x * normal.y;
+    a02 += planeWeight * normal.x * normal.z;
+    a11 += planeWeight * normal.y * normal.y;
+    a12 += planeWeight * normal.y * normal.z;
+    a22 += planeWeight * normal.z * normal.z;
+    b0 += planeWeight * normal.x * distance;
+    b1 += planeWeight * normal.y * distance;
+    b2 += planeWeight * normal.z * distance;
+    c += planeWeight * distance * distance;
+    weight += planeWeight;
+  }
+
+  void add(const SimplifierQuadric& other) {
+    a00 += other.a00;
+    a01 += other.a01;
+    a02 += other.a02;
+    a11 += other.a11;
+    a12 += other.a12;
+    a22 += other.a22;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+  }
+
+  // Squared distance (weighted average) of a point to the planes
+  double evaluate(const glm::dvec3& p) const {
+    const double error = a00 * p.x * p.x + 2 * a01 * p.x * p.y +
+                         2 * a02 * p.x * p.z + a11 * p.y * p.y +
+                         2 * a12 * p.y * p.z + a22 * p.z * p.z +
+                         2 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+    return weight > 0 ? std::fabs(error) / weight : 0;
+  }
+};
+
+/**
+ * Candidate collapse of a position onto a neighboring one.
+ */
+struct SimplifierCollapse {
+  GLuint from;
+  GLuint to;
+  double error;  // Squared distance
+};
+
+// Kinds of positions, telling where they can collapse
+enum class PositionKind : uint8_t { Manifold, Border, Locked };
+
+static uint64_t getEdgeKey(GLuint from, GLuint to) {
+  return (uint64_t(from) << 32) | to;
+}
+
+std::vector<GLuint> MeshSimplifier::simplify(const std::vector<Vertex>& vertices,
+                                             const std::vector<GLuint>& indices,
+                                             size_t targetIndexCount,
+                                             float targetError,
+                                             float* resultError) {
+  const size_t vertexCount = vertices.size();
+
+  // Vertices sharing a position (attribute seams) collapse together
+  std::vector<GLuint> sortedVertices(vertexCount);
+  std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+  const auto isLess = [&vertices](GLuint a, GLuint b) {
+    const auto& pa = vertices[a].position;
+    const auto& pb = vertices[b].position;
+    return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+  };
+  std::sort(sortedVertices.begin(), sortedVertices.end(), isLess);
+  std::vector<GLuint> positionIds(vertexCount);
+  std::vector<glm::dvec3> positions;
+  for (size_t i = 0; i < vertexCount; i++) {
+    const auto v = sortedVertices[i];
+    if (i == 0 || vertices[sortedVertices[i - 1]].position !=
+                      vertices[v].position) {
+      positions.push_back(glm::dvec3(vertices[v].position));
+    }
+    positionIds[v] = static_cast<GLuint>(positions.size() - 1);
+  }
+  const size_t positionCount = positions.size();
+
+  std::vector<GLuint> result = indices;
+  std::unordered_map<uint64_t, uint32_t> edgeCounts;  // Directed edges
+  const auto countEdges = [&]() {
+    edgeCounts.clear();
+    for (size_t i = 0; i < result.size(); i += 3) {
+      for (int k = 0; k < 3; k++) {
+        const auto a = positionIds[result[i + k]];
+        const auto b = positionIds[result[i + (k + 1) % 3]];
+        edgeCounts[getEdgeKey(a, b)]++;
+      }
+    }
+  };
+  const auto getEdgeCount = [&edgeCounts](GLuint from, GLuint to) {
+    const auto edge = edgeCounts.find(getEdgeKey(from, to));
+    return edge != edgeCounts.end() ? edge->second : 0;
+  };
+
+  // Quadrics of the surface around each position, plus planes perpendicular
+  // to the borders
+  std::vector<SimplifierQuadric> quadrics(positionCount);
+  countEdges();
+  for (size_t i = 0; i < result.size(); i += 3) {
+    const GLuint triangle[3] = {positionIds[result[i]],
+                                positionIds[result[i + 1]],
+                                positionIds[result[i + 2]]};
+    const auto& p0 = positions[triangle[0]];
+    auto normal = glm::cross(positions[triangle[1]] - p0,
+                             positions[triangle[2]] - p0);
+    const auto doubleArea = glm::length(normal);
+    if (doubleArea <= 0) {
+      continue;
+    }
+    normal /= doubleArea;
+
+    for (int k = 0; k < 3; k++) {
+      quadrics[triangle[k]].addPlane(normal, -glm::dot(normal, p0),
+                                     doubleArea * 0.5);
+    }
+
+    for (int k = 0; k < 3; k++) {
+      const auto a = triangle[k];
+      const auto b = triangle[(k + 1) % 3];
+      if (getEdgeCount(b, a) != 0) {
+        continue;
+      }
+      const auto edge = positions[b] - positions[a];
+      const auto borderNormal = glm::cross(edge, normal);
+      const auto borderNormalLength = glm::length(borderNormal);
+      if (borderNormalLength <= 0) {
+        continue;
+      }
+      const auto unitBorderNormal = borderNormal / borderNormalLength;
+      const auto distance = -glm::dot(unitBorderNormal, positions[a]);
+      const auto borderWeight = glm::dot(edge, edge) * BORDER_WEIGHT;
+      quadrics[a].addPlane(unitBorderNormal, distance, borderWeight);
+      quadrics[b].addPlane(unitBorderNormal, distance, borderWeight);
+    }
+  }
+
+  const double targetErrorSquared = double(targetError) * targetError;
+  double maxErrorSquared = 0;
+  std::vector<GLuint> remap(vertexCount);
+
+  // Collapse edges by passes, each position changing at most once per pass
+  while (result.size() > targetIndexCount) {
+    const size_t triangleCount = result.size() / 3;
+    countEdges();
+
+    // Triangles around each position
+    std::vector<uint32_t> adjacencyOffsets(positionCount + 1, 0);
+    for (const auto index : result) {
+      adjacencyOffsets[positionIds[index] + 1]++;
+    }
+    for (size_t p = 0; p < positionCount; p++) {
+      adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+    }
+    std::vector<uint32_t> adjacency(result.size());
+    {
+      auto cursors = adjacencyOffsets;
+      for (size_t i = 0; i < result.size(); i++) {
+        adjacency[cursors[positionIds[result[i]]]++] =
+            static_cast<uint32_t>(i / 3);
+      }
+    }
+
+    // Classify positions: borders only collapse along borders, non-manifold
+    // edges are left alone
+    std::vector<PositionKind> kinds(positionCount, PositionKind::Manifold);
+    for (const auto& edge : edgeCounts) {
+      const auto from = static_cast<GLuint>(edge.first >> 32);
+      const auto to = static_cast<GLuint>(edge.first & 0xFFFFFFFF);
+      if (edge.second > 1) {
+        kinds[from] = kinds[to] = PositionKind::Locked;
+      } else if (getEdgeCount(to, from) == 0) {
+        if (kinds[from] != PositionKind::Locked) {
+          kinds[from] = PositionKind::Border;
+        }
+        if (kinds[to] != PositionKind::Locked) {
+          kinds[to] = PositionKind::Border;
+        }
+      }
+    }
+
+    // Candidate collapses, cheapest first
+    std::vector<SimplifierCollapse> collapses;
+    for (size_t i = 0; i < result.size(); i += 3) {
+      for (int k = 0; k < 3; k++) {
+        const auto a = positionIds[result[i + k]];
+        const auto b = positionIds[result[i + (k + 1) % 3]];
+        const bool isBorderEdge = getEdgeCount(a, b) + getEdgeCount(b, a) == 1;
+        const std::pair<GLuint, GLuint> directions[] = {{a, b}, {b, a}};
+        for (const auto& direction : directions) {
+          const auto from = direction.first;
+          const auto to = direction.second;
+          if (from == to || kinds[from] == PositionKind::Locked ||
+              (kinds[from] == PositionKind::Border && !isBorderEdge)) {
+            continue;
+          }
+          collapses.push_back(
+              {from, to, quadrics[from].evaluate(positions[to])});
+        }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(),
+              [](const SimplifierCollapse& a, const SimplifierCollapse& b) {
+                return a.error < b.error;
+              });
+
+    // Apply the collapses that are still valid
+    std::iota(remap.begin(), remap.end(), 0);
+    std::vector<bool> isChanged(positionCount, false);
+    std::vector<std::pair<GLuint, GLuint>> vertexMap;
+    size_t removedTriangleCount = 0;
+    bool hasCollapsed = false;
+    for (const auto& collapse : collapses) {
+      if (collapse.error > targetErrorSquared ||
+          (triangleCount - removedTriangleCount) * 3 <= targetIndexCount) {
+        break;
+      }
+      if (isChanged[collapse.from] || isChanged[collapse.to]) {
+        continue;
+      }
+
+      // Each vertex at the collapsed position takes the attributes of the
+      // vertex it shares an edge with at the target position, and triangles
+      // must not flip
+      vertexMap.clear();
+      size_t collapsedTriangleCount = 0;
+      bool isValid = true;
+      const auto begin = adjacencyOffsets[collapse.from];
+      const auto end = adjacencyOffsets[collapse.from + 1];
+      for (auto a = begin; a < end && isValid; a++) {
+        const auto t = adjacency[a] * 3;
+        int fromCorner = -1, toCorner = -1;
+        for (int k = 0; k < 3; k++) {
+          const auto positionId = positionIds[result[t + k]];
+          if (positionId == collapse.from) {
+            fromCorner = k;
+          } else if (positionId == collapse.to) {
+            toCorner = k;
+          }
+        }
+
+        if (toCorner >= 0) {
+          collapsedTriangleCount++;
+          const auto vertex = result[t + fromCorner];
+          const bool isMapped =
+              std::any_of(vertexMap.begin(), vertexMap.end(),
+                          [vertex](const std::pair<GLuint, GLuint>& mapping) {
+                            return mapping.first == vertex;
+                          });
+          if (!isMapped) {
+            vertexMap.push_back({vertex, result[t + toCorner]});
+          }
+          continue;
+        }
+
+        glm::dvec3 corners[3];
+        for (int k = 0; k < 3; k++) {
+          corners[k] = positions[positionIds[result[t + k]]];
+        }
+        const auto oldNormal =
+            glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        corners[fromCorner] = positions[collapse.to];
+        const auto newNormal =
+            glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        isValid = glm::dot(oldNormal, newNormal) > 0;
+      }
+      for (auto a = begin; a < end && isValid; a++) {
+        const auto t = adjacency[a] * 3;
+        for (int k = 0; k < 3; k++) {
+          const auto vertex = result[t + k];
+          if (positionIds[vertex] == collapse.from &&
+              std::none_of(vertexMap.begin(), vertexMap.end(),
+                           [vertex](const std::pair<GLuint, GLuint>& mapping) {
+                             return mapping.first == vertex;
+                           })) {
+            isValid = false;  // Seam not following the collapsed edge
+          }
+        }
+      }
+      if (!isValid) {
+        continue;
+      }
+
+      for (const auto& mapping : vertexMap) {
+        remap[mapping.first] = mapping.second;
+      }
+      quadrics[collapse.to].add(quadrics[collapse.from]);
+      for (auto a = begin; a < end; a++) {
+        const auto t = adjacency[a] * 3;
+        for (int k = 0; k < 3; k++) {
+          isChanged[positionIds[result[t + k]]] = true;
+        }
+      }
+      maxErrorSquared = std::max(maxErrorSquared, collapse.error);
+      removedTriangleCount += collapsedTriangleCount;
+      hasCollapsed = true;
+    }
+
+    if (!hasCollapsed) {
+      break;
+    }
+
+    // Remap the triangles, removing the collapsed ones
+    std::vector<GLuint> simplified;
+    simplified.reserve(result.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+      const GLuint triangle[3] = {remap[result[i]], remap[result[i + 1]],
+                                  remap[result[i + 2]]};
+      if (positionIds[triangle[0]] == positionIds[triangle[1]] ||
+          positionIds[triangle[1]] == positionIds[triangle[2]] ||
+          positionIds[triangle[2]] == positionIds[triangle[0]]) {
+        continue;
+      }
+      simplified.insert(simplified.end(), triangle, triangle + 3);
+    }
+    result.swap(simplified);
+  }
+
+  if (resultError != nullptr) {
+    *resultError = static_cast<float>(std::sqrt(maxErrorSquared));
+  }
+  return result;
+}
+
+std::vector<MeshSimplifier::Level> MeshSimplifier::generateLevels(
+    const std::vector<Vertex>& vertices,
+    const std::vector<GLuint>& indices,
+    size_t maxLevelCount) {
+  std::vector<Level> levels;
+  if (indices.empty() || maxLevelCount == 0) {
+    return levels;
+  }
+
+  // Size of the mesh, to scale the allowed error
+  glm::vec3 aabbMin = vertices[indices[0]].position;
+  glm::vec3 aabbMax = aabbMin;
+  for (const auto index : indices) {
+    aabbMin = glm::min(aabbMin, vertices[index].position);
+    aabbMax = glm::max(aabbMax, vertices[index].position);
+  }
+  const float meshSize = glm::length(aabbMax - aabbMin);
+
+  // Each level halves the triangles, with an error budget doubling up to the
+  // maximal one for the coarsest level
+  const std::vector<GLuint>* previousIndices = &indices;
+  float previousError = 0.0f;
+  for (size_t l = 1; l <= maxLevelCount; l++) {
+    const size_t targetIndexCount = previousIndices->size() / 6 * 3;
+    const float maxError = MAX_RELATIVE_ERROR * meshSize /
+                           static_cast<float>(1 << (maxLevelCount - l));
+
+    float error = 0.0f;
+    auto levelIndices = simplify(vertices, *previousIndices, targetIndexCount,
+                                 maxError - previousError, &error);
+    if (levelIndices.empty() ||
+        levelIndices.size() > previousIndices->size() * MIN_REDUCTION) {
+      break;
+    }
+
+    // Errors of successive simplifications add up (upper bound)
+    previousError += error;
+    levels.push_back({std::move(levelIndices), previousError});
+    previousIndices = &levels.back().indices;
+  }
+
+  return levels;
+}
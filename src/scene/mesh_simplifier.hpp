@@ -0,0 +1,64 @@
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "vertex.hpp"
+
+/**
+ * Simplifies indexed triangle meshes by collapsing edges in the order of the
+ * quadric error metric (Garland & Heckbert). Vertices are only removed, never
+ * moved, so that all the levels of detail share the same vertex buffer.
+ *
+ * Mesh borders only collapse along themselves, and attribute seams (vertices
+ * sharing a position but not their normal or uv) only collapse along the seam.
+ */
+class MeshSimplifier {
+ public:
+  /**
+   * Level of detail generated by the simplifier.
+   */
+  struct Level {
+    std::vector<GLuint> indices;  // Triangle indices of the level
+    float error;                  // Simplification error (in model units)
+  };
+
+  /**
+   * Simplifies a mesh until it reaches the target triangle count or error.
+   * @param vertices          Vertices of the mesh
+   * @param indices           Triangle indices of the mesh
+   * @param targetIndexCount  Number of indices to reach
+   * @param targetError       Maximal error allowed (in model units)
+   * @param resultError       Receives the error of the simplified mesh
+   * @return Triangle indices of the simplified mesh
+   */
+  static std::vector<GLuint> simplify(const std::vector<Vertex>& vertices,
+                                      const std::vector<GLuint>& indices,
+                                      size_t targetIndexCount,
+                                      float targetError,
+                                      float* resultError = nullptr);
+
+  /**
+   * Generates levels of detail, each one halving the triangles of the previous
+   * one (within an error relative to the mesh's size). Stops early when a
+   * level can't be simplified enough.
+   * @param vertices       Vertices of the mesh
+   * @param indices        Triangle indices of the full detail mesh
+   * @param maxLevelCount  Maximal number of levels, excluding the full detail
+   * one
+   * @return The generated levels, from the finest to the coarsest
+   */
+  static std::vector<Level> generateLevels(const std::vector<Vertex>& vertices,
+                                           const std::vector<GLuint>& indices,
+                                           size_t maxLevelCount);
+
+  // Maximal error of the coarsest level, relative to the mesh's size
+  static constexpr float MAX_RELATIVE_ERROR = 0.05f;
+  // Minimal triangle reduction for a level to be kept
+  static constexpr float MIN_REDUCTION = 0.8f;
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "../gl_wrappers/texture_manager.hpp"
+#include "../utils/profiler.hpp"
+
+#include "model.hpp"
+
+Model::Model(const ModelData& modelData) : _name(modelData.modelName) {
+  _upload(modelData);
+}
+
+Model::~Model() {
+  // Release the textures before evicting those left unused
+  _materials.clear();
+  TextureManager::getInstance().evictUnusedTextures();
+}
+
+void Model::reload(const ModelData& modelData) {
+  // The new materials get the shared textures before the old ones release
+  // them, so that unchanged textures stay loaded
+  auto oldMaterials = std::move(_materials);
+  _materials.clear();
+  _aabbMin = glm::vec3(0);
+  _aabbMax = glm::vec3(0);
+  _boundingSphereCenter = glm::vec3(0);
+  _boundingSphereRadius = 0.0f;
+  _occluderTriangles.clear();
+  _upload(modelData);
+  _revision++;
+
+  oldMaterials.clear();
+  TextureManager::getInstance().evictUnusedTextures();
+}
+
+void Model::_upload(const ModelData& modelData) {
+  const auto asset = Profiler::getAssetName("model", _name);
+  Profiler::ScopedPhase phase(asset, "upload");
+
+  // Box of all the vertices, and bounding sphere around it
+  glm::vec3 aabbMin(FLT_MAX), aabbMax(-FLT_MAX);
+  for (const auto& materialData : modelData.materials) {
+    const auto& block = materialData.block;
+    for (size_t i = 0; i < block.vertexCount; i++) {
+      aabbMin = glm::min(aabbMin, block.vertices[i].position);
+      aabbMax = glm::max(aabbMax, block.vertices[i].position);
+    }
+  }
+  if (aabbMin.x <= aabbMax.x) {
+    _aabbMin = aabbMin;
+    _aabbMax = aabbMax;
+    _boundingSphereCenter = (aabbMin + aabbMax) * 0.5f;
+    for (const auto& materialData : modelData.materials) {
+      const auto& block = materialData.block;
+      for (size_t i = 0; i < block.vertexCount; i++) {
+        _boundingSphereRadius = std::max(
+            _boundingSphereRadius,
+            glm::distance(_boundingSphereCenter, block.vertices[i].position));
+      }
+    }
+  }
+
+  _createOccluderProxy(modelData);
+
+  for (const auto& materialData : modelData.materials) {
+    const auto& block = materialData.block;
+    auto objectMaterial = new SceneObjectMaterial(block.material);
+
+    // Get the shared texture, streaming the decoded image in if not cached
+    // yet (the placeholder is drawn until then, or forever when inexistent
+    // texture given)
+    if (block.textureFilename.empty()) {  // When no texture given
+      objectMaterial->texture = nullptr;
+    } else {
+      objectMaterial->texture = TextureManager::getInstance().getTextureAsync(
+          ModelData::getTextureFilePath(_name, block.textureFilename),
+          materialData.textureImage);
+    }
+
+    // Upload geometry, packed when its format allows it
+    const auto& geometry = materialData.packedGeometry;
+    if (geometry.format == PackedGeometry::Format::Float) {
+      objectMaterial->bufferData(block.vertices, block.vertexCount,
+                                 block.indices, block.indexCount);
+    } else {
+      objectMaterial->bufferData(geometry.vertexData.data(), block.vertexCount,
+                                 geometry.getLayout(), block.indices,
+                                 block.indexCount);
+    }
+    objectMaterial->positionTransform = geometry.positionTransform;
+    objectMaterial->lods = block.lods;
+    Profiler::getInstance().addCount(
+        asset, "uploadedBytes",
+        block.vertexCount * geometry.getLayout().stride +
+            block.indexCount * (objectMaterial->indexType == GL_UNSIGNED_SHORT
+                                    ? sizeof(GLushort)
+                                    : sizeof(GLuint)));
+
+    _materials.emplace_back(objectMaterial);
+  }
+}
+
+void Model::_createOccluderProxy(const ModelData& modelData) {
+  // Coarsest level of each material close enough to the full detail (levels
+  // get coarser)
+  const float maxError = _boundingSphereRadius * MAX_OCCLUDER_ERROR_RATIO;
+  std::vector<MeshLod> lods(modelData.materials.size());
+  size_t triangleCount = 0;
+  for (size_t m = 0; m < modelData.materials.size(); m++) {
+    const auto& block = modelData.materials[m].block;
+    lods[m].indexCount = block.indexCount;
+    for (const auto& lod : block.lods) {
+      if (lod.error <= maxError) {
+        lods[m] = lod;
+      }
+    }
+    triangleCount += lods[m].indexCount / 3;
+  }
+  if (triangleCount > MAX_OCCLUDER_TRIANGLE_COUNT) {
+    return;
+  }
+
+  _occluderTriangles.reserve(triangleCount * 3);
+  for (size_t m = 0; m < modelData.materials.size(); m++) {
+    const auto& block = modelData.materials[m].block;
+    const auto& lod = lods[m];
+    for (size_t i = 0; i < lod.indexCount / 3 * 3; i++) {
+      _occluderTriangles.push_back(
+          block.vertices[block.indices[lod.indexOffset + i]].position);
+    }
+  }
+}
+
+size_t Model::getLodCount() const {
+  size_t lodCount = 1;
+  for (const auto& objectMaterial : _materials) {
+    lodCount = std::max(lodCount, objectMaterial->lods.size());
+  }
+  return lodCount;
+}
+
+float Model::getLodError(size_t lodLevel) const {
+  // Materials with fewer levels draw their coarsest one
+  float error = 0.0f;
+  for (const auto& objectMaterial : _materials) {
+    const auto& lods = objectMaterial->lods;
+    if (!lods.empty()) {
+      error = std::max(error, lods[std::min(lodLevel, lods.size() - 1)].error);
+    }
+  }
+  return error;
+}
+
+const glm::vec3& Model::getAabbMin() const {
+  return _aabbMin;
+}
+
+const glm::vec3& Model::getAabbMax() const {
+  return _aabbMax;
+}
+
+const glm::vec3& Model::getBoundingSphereCenter() const {
+  return _boundingSphereCenter;
+}
+
+float Model::getBoundingSphereRadius() const {
+  return _boundingSphereRadius;
+}
+
+const std::vector<glm::vec3>& Model::getOccluderTriangles() const {
+  return _occluderTriangles;
+}
+
+size_t Model::getRevision() const {
+  return _revision;
+}
+
+const std::string& Model::getName() const {
+  return _name;
+}
+
+const std::vector<std::unique_ptr<SceneObjectMaterial>>& Model::getMaterials()
+    const {
+  return _materials;
+}
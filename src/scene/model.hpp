@@ -0,0 +1,130 @@
+#ifndef MODEL_HPP
+#define MODEL_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "model_data.hpp"
+#include "scene_object_material.hpp"
+
+/**
+ * GPU resources of a model (materials with their buffers and textures),
+ * shared by all the scene objects placing that model.
+ */
+class Model {
+ public:
+  /**
+   * Uploads the given model data (geometry and textures) to the GPU.
+   * @param modelData Data of the model to upload
+   */
+  explicit Model(const ModelData& modelData);
+
+  /**
+   * Frees the materials, then the textures no other model uses anymore.
+   */
+  ~Model();
+
+  // Disable copy constructor
+  Model(const Model&) = delete;
+  Model& operator=(const Model&) = delete;
+
+  /**
+   * Replaces the GPU resources of the model by the given data (e.g. after its
+   * files changed), in place so that the objects placing it draw the new
+   * version.
+   * @param modelData New data of the model
+   */
+  void reload(const ModelData& modelData);
+
+  /**
+   * Gets the number of levels of detail of the model (the most of its
+   * materials).
+   */
+  size_t getLodCount() const;
+
+  /**
+   * Gets the simplification error of a level of detail (the largest of its
+   * materials), in model units.
+   * @param lodLevel Level of detail
+   */
+  float getLodError(size_t lodLevel) const;
+
+  /**
+   * Gets the minimal corner of the model's bounding box, in model units.
+   */
+  const glm::vec3& getAabbMin() const;
+
+  /**
+   * Gets the maximal corner of the model's bounding box, in model units.
+   */
+  const glm::vec3& getAabbMax() const;
+
+  /**
+   * Gets the center of the model's bounding sphere, in model units.
+   */
+  const glm::vec3& getBoundingSphereCenter() const;
+
+  /**
+   * Gets the radius of the model's bounding sphere, in model units.
+   */
+  float getBoundingSphereRadius() const;
+
+  /**
+   * Gets the triangles (3 vertices each, in model units) of the model's
+   * occluder proxy: its coarsest level of detail staying close enough to the
+   * full one not to hide what the model doesn't (empty if that level is too
+   * detailed to be a proxy).
+   */
+  const std::vector<glm::vec3>& getOccluderTriangles() const;
+
+  /**
+   * Gets the number of times the model has been reloaded, for the objects to
+   * know when their bounds are outdated.
+   */
+  size_t getRevision() const;
+
+  /**
+   * Gets the name of the model.
+   */
+  const std::string& getName() const;
+
+  /**
+   * Gets the materials of the model.
+   */
+  const std::vector<std::unique_ptr<SceneObjectMaterial>>& getMaterials()
+      const;
+
+  // Maximal simplification error of the occluder proxy, relative to the
+  // bounding sphere radius
+  static constexpr float MAX_OCCLUDER_ERROR_RATIO = 0.01f;
+  // Maximal number of triangles of the occluder proxy (more would take most
+  // of the occlusion culling budget, so the model gets no proxy)
+  static constexpr size_t MAX_OCCLUDER_TRIANGLE_COUNT = 8192;
+
+ private:
+  /**
+   * Uploads the materials of the given data and computes the bounding box and
+   * sphere.
+   */
+  void _upload(const ModelData& modelData);
+
+  /**
+   * Copies the triangles of the occluder proxy from the given data.
+   */
+  void _createOccluderProxy(const ModelData& modelData);
+
+  std::string _name;  // Name of the model
+  std::vector<std::unique_ptr<SceneObjectMaterial>>
+      _materials;  // Materials of the model
+  glm::vec3 _aabbMin = glm::vec3(0);               // In model units
+  glm::vec3 _aabbMax = glm::vec3(0);               // In model units
+  glm::vec3 _boundingSphereCenter = glm::vec3(0);  // In model units
+  float _boundingSphereRadius = 0.0f;              // In model units
+  size_t _revision = 0;                            // Number of reloads
+  std::vector<glm::vec3> _occluderTriangles;       // In model units
+};
+
+#endif
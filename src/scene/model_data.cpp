@@ -0,0 +1,260 @@
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include "../gl_wrappers/texture_manager.hpp"
+#include "../gl_wrappers/vertex_buffer_object.hpp"
+#include "../utils/profiler.hpp"
+#include "../utils/thread_pool.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_simplifier.hpp"
+#include "normal_generator.hpp"
+#include "obj_parser.hpp"
+
+#include "model_data.hpp"
+
+std::unique_ptr<ModelData> ModelData::load(
+    const std::string& modelName,
+    const ImportSettings& importSettings) {
+  std::cout << "Loading model: " << modelName << "\n";
+
+  auto modelData = std::make_unique<ModelData>();
+  modelData->modelName = modelName;
+  modelData->importSettings = importSettings;
+
+  // Parse the OBJ file only when the mesh cache isn't up to date
+  if (modelData->_loadFromCache()) {
+    std::cout << "(" << modelName << " loaded from mesh cache)\n";
+  } else {
+    modelData->_loadFromObj();
+  }
+
+  modelData->_packGeometry();
+  modelData->_decodeTextures();
+
+  // Size of the loaded geometry
+  auto& profiler = Profiler::getInstance();
+  const auto asset = Profiler::getAssetName("model", modelName);
+  for (const auto& materialData : modelData->materials) {
+    const auto& block = materialData.block;
+    const auto triangleCount = block.lods.empty()
+                                   ? block.indexCount / 3
+                                   : block.lods.front().indexCount / 3;
+    profiler.addCount(asset, "vertices", block.vertexCount);
+    profiler.addCount(asset, "triangles", triangleCount);
+    // As uploaded (small meshes get 16 bits indices)
+    const auto indexSize =
+        VertexBufferObject::getIndexType(block.vertexCount) ==
+                GL_UNSIGNED_SHORT
+            ? sizeof(GLushort)
+            : sizeof(GLuint);
+    profiler.addCount(asset, "indexBytes", block.indexCount * indexSize);
+  }
+
+  return modelData;
+}
+
+std::future<std::unique_ptr<ModelData>> ModelData::loadAsync(
+    const std::string& modelName,
+    const ImportSettings& importSettings) {
+  return ThreadPool::getInstance().submit([modelName, importSettings]() {
+    return load(modelName, importSettings);
+  });
+}
+
+bool ModelData::_loadFromCache() {
+  Profiler::ScopedPhase phase(Profiler::getAssetName("model", modelName),
+                              "cacheRead");
+  if (!_meshCache.open(modelName, importSettings.normalCreaseAngle)) {
+    return false;
+  }
+
+  for (const auto& block : _meshCache.getMaterialBlocks()) {
+    materials.push_back({block, {}, nullptr});
+  }
+
+  return true;
+}
+
+void ModelData::_loadFromObj() {
+  auto& profiler = Profiler::getInstance();
+  const auto asset = Profiler::getAssetName("model", modelName);
+
+  // Parse the model (in parallel, straight from the mapped file)
+  auto phaseStart = Profiler::Clock::now();
+  const auto objFilePath = "models/" + modelName + "/model.obj";
+  ObjParser parser;
+  if (!parser.parse(objFilePath)) {
+    throw std::runtime_error("Could not load model '" + modelName + "'");
+  }
+  std::cout << "(" << modelName << ": " << parser.getTriangleCount()
+            << " triangles)\n";
+  profiler.addPhase(asset, "parse", phaseStart, Profiler::Clock::now());
+  std::error_code error;
+  const auto objFileSize = std::filesystem::file_size(objFilePath, error);
+  profiler.addCount(asset, "objBytes", error ? 0 : objFileSize);
+
+  // Generate the normals the file lacks (faces then share normals across
+  // smooth edges, which also lets more of their vertices be welded)
+  phaseStart = Profiler::Clock::now();
+  ThreadPool::getInstance().parallelFor(
+      parser.materialVertices.size(), [this, &parser](size_t m) {
+        NormalGenerator::generate(parser.materialVertices[m],
+                                  importSettings.normalCreaseAngle);
+      });
+  profiler.addPhase(asset, "normals", phaseStart, Profiler::Clock::now());
+
+  // One welder per material, merging identical vertices into indexed geometry
+  phaseStart = Profiler::Clock::now();
+  _weldedGeometry.resize(parser.materials.size());
+  ThreadPool::getInstance().parallelFor(
+      _weldedGeometry.size(), [this, &parser](size_t m) {
+        for (const auto& vertex : parser.materialVertices[m]) {
+          _weldedGeometry[m].addVertex(vertex);
+        }
+      });
+  profiler.addPhase(asset, "weld", phaseStart, Profiler::Clock::now());
+
+  // Generate the levels of detail of the welded geometry, then reorder it for
+  // the GPU, measuring the vertex cache efficiency of the full detail level
+  // before and after (weighted by triangles)
+  phaseStart = Profiler::Clock::now();
+  std::vector<std::vector<MeshLod>> geometryLods(_weldedGeometry.size());
+  float acmrBefore = 0, acmrAfter = 0, atvrBefore = 0, atvrAfter = 0;
+  size_t triangleCount = 0, lodTriangleCount = 0;
+  for (size_t i = 0; i < _weldedGeometry.size(); i++) {
+    auto& geometry = _weldedGeometry[i];
+    auto& lods = geometryLods[i];
+    const auto before = MeshOptimizer::analyzeVertexCache(
+        geometry.indices, geometry.vertices.size());
+    MeshOptimizer::optimizeVertexCache(geometry.indices,
+                                       geometry.vertices.size());
+    MeshOptimizer::optimizeOverdraw(geometry.indices, geometry.vertices);
+    const auto after = MeshOptimizer::analyzeVertexCache(
+        geometry.indices, geometry.vertices.size());
+    lods.push_back({0, geometry.indices.size(), 0.0f});
+
+    // Coarser levels share the vertices, their indices following the full
+    // detail ones
+    auto levels = MeshSimplifier::generateLevels(
+        geometry.vertices, geometry.indices, MeshCache::MAX_LOD_COUNT - 1);
+    for (auto& level : levels) {
+      MeshOptimizer::optimizeVertexCache(level.indices,
+                                         geometry.vertices.size());
+      MeshOptimizer::optimizeOverdraw(level.indices, geometry.vertices);
+      lods.push_back(
+          {geometry.indices.size(), level.indices.size(), level.error});
+      geometry.indices.insert(geometry.indices.end(), level.indices.begin(),
+                              level.indices.end());
+      lodTriangleCount += level.indices.size() / 3;
+    }
+    MeshOptimizer::optimizeVertexFetch(geometry.vertices, geometry.indices);
+
+    const auto materialTriangleCount = lods.front().indexCount / 3;
+    acmrBefore += before.acmr * materialTriangleCount;
+    acmrAfter += after.acmr * materialTriangleCount;
+    atvrBefore += before.atvr * materialTriangleCount;
+    atvrAfter += after.atvr * materialTriangleCount;
+    triangleCount += materialTriangleCount;
+  }
+  if (triangleCount > 0) {
+    std::cout << "(" << modelName << ": ACMR " << acmrBefore / triangleCount
+              << " -> " << acmrAfter / triangleCount << ", ATVR "
+              << atvrBefore / triangleCount << " -> "
+              << atvrAfter / triangleCount << ", " << lodTriangleCount
+              << " triangles in coarser levels of detail)\n";
+  }
+  profiler.addPhase(asset, "optimize", phaseStart, Profiler::Clock::now());
+
+  // Load object materials, pointing to their welded geometry
+  size_t indexCount = 0;
+  size_t uniqueVertexCount = 0;
+  for (size_t i = 0; i < parser.materials.size(); i++) {
+    const auto& material = parser.materials[i];
+    const auto& geometry = _weldedGeometry[i];
+
+    // Load material elements
+    shader_structs::Material modelMaterial(material.ambient, material.diffuse,
+                                           material.specular,
+                                           material.shininess);
+
+    MeshCache::MaterialBlock block{modelMaterial,
+                                   material.diffuseTextureFilename,
+                                   geometry.vertices.data(),
+                                   geometry.vertices.size(),
+                                   geometry.indices.data(),
+                                   geometry.indices.size(),
+                                   geometryLods[i]};
+    materials.push_back({block, {}, nullptr});
+
+    indexCount += geometryLods[i].front().indexCount;
+    uniqueVertexCount += geometry.vertices.size();
+  }
+  std::cout << "(" << modelName << ": welded " << indexCount
+            << " vertices into " << uniqueVertexCount << " unique vertices)\n";
+
+  // Write the mesh cache, so that next launches don't parse the OBJ again
+  phaseStart = Profiler::Clock::now();
+  std::vector<MeshCache::MaterialBlock> materialBlocks;
+  for (const auto& materialData : materials) {
+    materialBlocks.push_back(materialData.block);
+  }
+  MeshCache::write(modelName, materialBlocks,
+                   importSettings.normalCreaseAngle);
+  profiler.addPhase(asset, "cacheWrite", phaseStart, Profiler::Clock::now());
+}
+
+void ModelData::_packGeometry() {
+  const auto asset = Profiler::getAssetName("model", modelName);
+  Profiler::ScopedPhase phase(asset, "pack");
+
+  size_t floatSize = 0;
+  size_t packedSize = 0;
+  for (auto& materialData : materials) {
+    const auto& block = materialData.block;
+    materialData.packedGeometry =
+        PackedGeometry::pack(block.vertices, block.vertexCount);
+
+    floatSize += block.vertexCount * sizeof(Vertex);
+    packedSize +=
+        block.vertexCount * materialData.packedGeometry.getVertexSize();
+  }
+
+  std::cout << "(" << modelName << ": packed " << floatSize
+            << " bytes of vertices into " << packedSize << " bytes)\n";
+  Profiler::getInstance().addCount(asset, "vertexBytes", packedSize);
+}
+
+std::string ModelData::getTextureFilePath(const std::string& modelName,
+                                          const std::string& textureFilename) {
+  return "models/" + modelName + "/textures/" + textureFilename;
+}
+
+void ModelData::_decodeTextures() {
+  // Materials sharing a texture file share its decoded image
+  std::map<std::string, std::shared_ptr<Texture::Image>> decodedImages;
+
+  for (auto& materialData : materials) {
+    const auto& textureFilename = materialData.block.textureFilename;
+    if (textureFilename.empty()) {
+      continue;
+    }
+
+    const auto filePath = getTextureFilePath(modelName, textureFilename);
+    const auto decodedImage = decodedImages.find(filePath);
+    if (decodedImage != decodedImages.end()) {
+      materialData.textureImage = decodedImage->second;
+      continue;
+    }
+
+    // No need to decode textures another model already uploaded
+    if (TextureManager::getInstance().containsTexture(filePath)) {
+      continue;
+    }
+
+    materialData.textureImage = Texture::decodeImage(filePath);
+    decodedImages[filePath] = materialData.textureImage;
+  }
+}
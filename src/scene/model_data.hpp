@@ -0,0 +1,111 @@
+#ifndef MODEL_DATA_HPP
+#define MODEL_DATA_HPP
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../gl_wrappers/texture.hpp"
+#include "mesh_cache.hpp"
+#include "normal_generator.hpp"
+#include "packed_geometry.hpp"
+#include "vertex_welder.hpp"
+
+/**
+ * CPU side data of a model: materials, indexed geometry and decoded textures.
+ * Loading it makes no OpenGL call, so it can be done on worker threads, while
+ * only the upload to the GPU (see Model) happens on the context thread.
+ */
+class ModelData {
+ public:
+  /**
+   * Material of the model, with its geometry and decoded texture.
+   */
+  struct MaterialData {
+    MeshCache::MaterialBlock block;  // Material, texture name and geometry
+    PackedGeometry packedGeometry;   // Vertices in their most compact format
+    std::shared_ptr<Texture::Image>
+        textureImage;  // Decoded texture (nullptr if none, undecodable or
+                       // already cached by the TextureManager)
+  };
+
+  /**
+   * How a model is imported from its OBJ file.
+   */
+  struct ImportSettings {
+    // Crease angle of the missing normals, in degrees (0 for flat normals)
+    float normalCreaseAngle = NormalGenerator::DEFAULT_CREASE_ANGLE;
+  };
+
+  std::string modelName;                // Name of the model
+  ImportSettings importSettings;        // How the model has been imported
+  std::vector<MaterialData> materials;  // Materials of the model
+
+  ModelData() = default;
+
+  // Disable copy constructor (geometry may point into owned storage)
+  ModelData(const ModelData&) = delete;
+  ModelData& operator=(const ModelData&) = delete;
+
+  /**
+   * Loads the data of a model, from its mesh cache when it's up to date or by
+   * parsing its OBJ file (then writing the cache) otherwise.
+   * Throws std::runtime_error if the model can't be loaded.
+   * @param modelName       Name of the model to load
+   * @param importSettings  How to import the model
+   * @return The loaded data
+   */
+  static std::unique_ptr<ModelData> load(
+      const std::string& modelName,
+      const ImportSettings& importSettings);
+
+  /**
+   * Loads the data of a model on the asset loading threads.
+   * @param modelName       Name of the model to load
+   * @param importSettings  How to import the model
+   * @return Future holding the loaded data (or the loading error)
+   */
+  static std::future<std::unique_ptr<ModelData>> loadAsync(
+      const std::string& modelName,
+      const ImportSettings& importSettings);
+
+  /**
+   * Gets path of a texture file of the given model.
+   * @param modelName       Name of the model
+   * @param textureFilename Name of the texture file, as given by the material
+   */
+  static std::string getTextureFilePath(const std::string& modelName,
+                                        const std::string& textureFilename);
+
+ private:
+  MeshCache _meshCache;  // Mapped cache the geometry points into, if loaded
+                         // from it
+  std::vector<VertexWelder>
+      _weldedGeometry;  // Geometry parsed from OBJ, if not loaded from cache
+
+  /**
+   * Loads the materials and geometry from the mesh cache.
+   * @return True if the cache was up to date, false otherwise
+   */
+  bool _loadFromCache();
+
+  /**
+   * Loads the materials and geometry by parsing the OBJ and MTL files, then
+   * writes the mesh cache.
+   */
+  void _loadFromObj();
+
+  /**
+   * Packs the vertices of every material in their most compact format.
+   */
+  void _packGeometry();
+
+  /**
+   * Decodes the textures of the materials, once per file and only when they
+   * aren't already cached by the TextureManager.
+   */
+  void _decodeTextures();
+};
+
+#endif
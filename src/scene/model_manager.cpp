@@ -0,0 +1,105 @@
+#include <chrono>
+#include <iostream>
+
+#include "../utils/profiler.hpp"
+
+#include "model_manager.hpp"
+
+ModelManager& ModelManager::getInstance() {
+  static ModelManager mm;
+  return mm;
+}
+
+void ModelManager::setImportSettings(
+    const std::string& modelName,
+    const ModelData::ImportSettings& importSettings) {
+  _importSettings[modelName] = importSettings;
+}
+
+void ModelManager::loadModelAsync(const std::string& modelName) {
+  if (containsModel(modelName) || _pendingModels.count(modelName) > 0) {
+    return;
+  }
+
+  _pendingModels[modelName] =
+      ModelData::loadAsync(modelName, _getImportSettings(modelName));
+}
+
+std::shared_ptr<Model> ModelManager::getModel(const std::string& modelName) {
+  // Already loaded and still in use
+  auto model = _modelCache[modelName].lock();
+  if (model) {
+    return model;
+  }
+
+  // Get the model data, from its pending load if any
+  std::unique_ptr<ModelData> modelData;
+  const auto pendingModel = _pendingModels.find(modelName);
+  if (pendingModel != _pendingModels.end()) {
+    auto future = std::move(pendingModel->second);
+    _pendingModels.erase(pendingModel);
+
+    // Time the render thread spends blocked on the background load
+    Profiler::ScopedPhase phase(Profiler::getAssetName("model", modelName),
+                                "wait");
+    modelData = future.get();
+  } else {
+    modelData = ModelData::load(modelName, _getImportSettings(modelName));
+  }
+
+  // Upload it and keep track of it
+  model = std::make_shared<Model>(*modelData);
+  _modelCache[modelName] = model;
+
+  return model;
+}
+
+void ModelManager::reloadModelAsync(const std::string& modelName) {
+  if (!containsModel(modelName)) {
+    return;
+  }
+
+  // A reload already in progress may have read the files before they changed
+  std::cout << "Reloading model: " << modelName << "\n";
+  _reloadingModels[modelName] =
+      ModelData::loadAsync(modelName, _getImportSettings(modelName));
+}
+
+void ModelManager::update() {
+  for (auto it = _reloadingModels.begin(); it != _reloadingModels.end();) {
+    if (it->second.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      ++it;
+      continue;
+    }
+
+    const auto modelName = it->first;
+    auto future = std::move(it->second);
+    it = _reloadingModels.erase(it);
+    const auto model = _modelCache[modelName].lock();
+    if (!model) {  // No longer used
+      continue;
+    }
+
+    try {
+      const auto modelData = future.get();
+      model->reload(*modelData);
+      std::cout << "Reloaded model: " << modelName << "\n";
+    } catch (const std::exception& exception) {
+      std::cerr << "Unable to reload model '" << modelName
+                << "': " << exception.what() << "\n";
+    }
+  }
+}
+
+bool ModelManager::containsModel(const std::string& modelName) const {
+  const auto cachedModel = _modelCache.find(modelName);
+  return cachedModel != _modelCache.end() && !cachedModel->second.expired();
+}
+
+ModelData::ImportSettings ModelManager::_getImportSettings(
+    const std::string& modelName) const {
+  const auto importSettings = _importSettings.find(modelName);
+  return importSettings != _importSettings.end() ? importSettings->second
+                                                 : ModelData::ImportSettings();
+}
@@ -0,0 +1,101 @@
+#ifndef MODEL_MANAGER_HPP
+#define MODEL_MANAGER_HPP
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "model.hpp"
+#include "model_data.hpp"
+
+/**
+ * Singleton class that keeps track of all loaded models, so that objects
+ * placing the same model share its GPU buffers, materials and textures.
+ * Models are reference counted: a model is freed once no object uses it.
+ * Must only be used from the OpenGL context's thread.
+ */
+class ModelManager {
+ public:
+  /**
+   * Gets the one and only instance of the model manager.
+   */
+  static ModelManager& getInstance();
+
+  /**
+   * Sets how a model is imported from its OBJ file (e.g. flat normals with a
+   * crease angle of 0), for its next loads. Models not set are imported with
+   * the default settings.
+   *
+   * @param modelName       Name of the model
+   * @param importSettings  How to import the model
+   */
+  void setImportSettings(const std::string& modelName,
+                         const ModelData::ImportSettings& importSettings);
+
+  /**
+   * Starts loading a model on the asset loading threads, unless it's already
+   * loaded or loading.
+   *
+   * @param modelName  Name of the model to load
+   */
+  void loadModelAsync(const std::string& modelName);
+
+  /**
+   * Retrieves the model with the specified name, loading it (or waiting for
+   * its asynchronous loading) and uploading it if it isn't loaded yet.
+   *
+   * @param modelName  Name of the model to get
+   *
+   * @return Shared model with the specified name.
+   */
+  std::shared_ptr<Model> getModel(const std::string& modelName);
+
+  /**
+   * Starts loading again a loaded model on the asset loading threads (e.g.
+   * after its files changed). The model is replaced in place by update() once
+   * loaded, and kept as is if it can't be loaded.
+   *
+   * @param modelName  Name of the model to reload
+   */
+  void reloadModelAsync(const std::string& modelName);
+
+  /**
+   * Replaces the models whose reloading is done. Must be called once per
+   * frame.
+   */
+  void update();
+
+  /**
+   * Checks, if a model with the specified name is currently loaded.
+   *
+   * @param modelName  Name of the model to check existence of
+   *
+   * @return True if the model is loaded, false otherwise.
+   */
+  bool containsModel(const std::string& modelName) const;
+
+ private:
+  ModelManager() {}  // Private constructor to make class singleton
+  ModelManager(const ModelManager&) = delete;  // No copy constructor allowed
+  void operator=(const ModelManager&) = delete;  // No copy assignment allowed
+
+  std::map<std::string, std::weak_ptr<Model>>
+      _modelCache;  // Model cache - references the loaded models without
+                    // keeping them alive
+  std::map<std::string, std::future<std::unique_ptr<ModelData>>>
+      _pendingModels;  // Models being loaded on the asset loading threads
+  std::map<std::string, std::future<std::unique_ptr<ModelData>>>
+      _reloadingModels;  // Loaded models being loaded again
+  std::map<std::string, ModelData::ImportSettings>
+      _importSettings;  // Import settings of the models not imported with
+                        // the default ones
+
+  /**
+   * Gets how a model is imported.
+   */
+  ModelData::ImportSettings _getImportSettings(
+      const std::string& modelName) const;
+};
+
+#endif
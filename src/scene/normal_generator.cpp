@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+
+#include "normal_generator.hpp"
+
+// Normal given to vertices of degenerate triangles (which cover no pixel)
+static const glm::vec3 FALLBACK_NORMAL = glm::vec3(0.0f, 1.0f, 0.0f);
+
+/**
+ * Orders positions lexicographically, so that equal ones end up consecutive.
+ */
+static bool isPositionLess(const glm::vec3& a, const glm::vec3& b) {
+  return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+}
+
+void NormalGenerator::generate(std::vector<Vertex>& vertices,
+                               float creaseAngle) {
+  const auto triangleCount = vertices.size() / 3;
+
+  // Faces with a missing normal, with their area weighted and unit normals
+  std::vector<uint32_t> missingCorners;
+  std::vector<glm::vec3> faceNormals(triangleCount, glm::vec3(0));
+  std::vector<glm::vec3> unitFaceNormals(triangleCount, glm::vec3(0));
+  for (size_t t = 0; t < triangleCount; t++) {
+    bool isMissing = false;
+    for (size_t c = 3 * t; c < 3 * t + 3; c++) {
+      if (vertices[c].normal == glm::vec3(0)) {
+        missingCorners.push_back(static_cast<uint32_t>(c));
+        isMissing = true;
+      }
+    }
+    if (!isMissing) {
+      continue;
+    }
+
+    const auto& p0 = vertices[3 * t].position;
+    const auto& p1 = vertices[3 * t + 1].position;
+    const auto& p2 = vertices[3 * t + 2].position;
+    faceNormals[t] = glm::cross(p1 - p0, p2 - p0);
+    const auto length = glm::length(faceNormals[t]);
+    if (length > 0 && std::isfinite(length)) {
+      unitFaceNormals[t] = faceNormals[t] / length;
+    } else {
+      faceNormals[t] = glm::vec3(0);
+    }
+  }
+  if (missingCorners.empty()) {
+    return;
+  }
+
+  if (creaseAngle <= 0.0f) {
+    for (const auto corner : missingCorners) {
+      const auto& normal = unitFaceNormals[corner / 3];
+      vertices[corner].normal =
+          normal == glm::vec3(0) ? FALLBACK_NORMAL : normal;
+    }
+    return;
+  }
+
+  // Group the corners by position, then average the normals of the faces of
+  // each group within the crease angle of the corner's face (only faces with
+  // missing normals are considered, the others being shaded as authored)
+  std::sort(missingCorners.begin(), missingCorners.end(),
+            [&vertices](uint32_t a, uint32_t b) {
+              return isPositionLess(vertices[a].position,
+                                    vertices[b].position);
+            });
+  const auto minCosine = std::cos(glm::radians(creaseAngle));
+  std::vector<glm::vec3> groupNormals;
+  for (size_t first = 0; first < missingCorners.size();) {
+    const auto& position = vertices[missingCorners[first]].position;
+    auto last = first + 1;
+    while (last < missingCorners.size() &&
+           vertices[missingCorners[last]].position == position) {
+      last++;
+    }
+
+    groupNormals.assign(last - first, glm::vec3(0));
+    for (size_t i = first; i < last; i++) {
+      const auto& unitNormal = unitFaceNormals[missingCorners[i] / 3];
+      if (unitNormal == glm::vec3(0)) {
+        continue;
+      }
+      for (size_t j = first; j < last; j++) {
+        const auto other = missingCorners[j] / 3;
+        if (glm::dot(unitNormal, unitFaceNormals[other]) >= minCosine) {
+          groupNormals[i - first] += faceNormals[other];
+        }
+      }
+    }
+
+    for (size_t i = first; i < last; i++) {
+      const auto& normal = groupNormals[i - first];
+      const auto length = glm::length(normal);
+      // Only degenerate faces, which always face themselves otherwise
+      vertices[missingCorners[i]].normal =
+          length > 0 ? normal / length : FALLBACK_NORMAL;
+    }
+    first = last;
+  }
+}
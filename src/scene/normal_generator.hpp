@@ -0,0 +1,33 @@
+#ifndef NORMAL_GENERATOR_HPP
+#define NORMAL_GENERATOR_HPP
+
+#include <vector>
+
+#include "vertex.hpp"
+
+/**
+ * Generates the normals models don't provide, at import rather than for every
+ * frame on the GPU.
+ *
+ * A missing normal is the average of the normals of the faces sharing its
+ * position (weighted by their area), among those making an angle with its own
+ * face below a crease angle, so that curved surfaces are smooth while sharp
+ * edges stay sharp. A crease angle of zero gives flat normals.
+ */
+class NormalGenerator {
+ public:
+  /**
+   * Fills the missing (zero) normals of triangle vertices, leaving the other
+   * ones untouched.
+   * @param vertices     Vertices of the triangles (3 per triangle)
+   * @param creaseAngle  Largest angle between faces whose normals are
+   * averaged, in degrees (0 for flat normals)
+   */
+  static void generate(std::vector<Vertex>& vertices,
+                       float creaseAngle = DEFAULT_CREASE_ANGLE);
+
+  // Crease angle of generated normals, in degrees
+  static constexpr float DEFAULT_CREASE_ANGLE = 60.0f;
+};
+
+#endif
@@ -0,0 +1,729 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../utils/mapped_file.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include "obj_parser.hpp"
+
+// Digits are parsed 8 at a time with SSE2, or elsewhere with SWAR (SIMD
+// within a register) arithmetic, which relies on the bytes order of
+// little-endian machines
+#if defined(__SSE2__)
+static const bool CAN_PARSE_EIGHT_DIGITS = true;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static const bool CAN_PARSE_EIGHT_DIGITS = false;
+#else
+static const bool CAN_PARSE_EIGHT_DIGITS = true;
+#endif
+
+// Most significant digits a 64 bits mantissa holds
+static const int MAX_MANTISSA_DIGITS = 19;
+
+// Powers of ten exactly representable as doubles
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/**
+ * Index of a face corner attribute, as written in the file.
+ */
+struct ObjIndex {
+  enum class Kind : uint8_t {
+    Missing,   // No attribute
+    Absolute,  // Index from the first attribute of the file
+    Relative   // Index from the first attribute of the chunk (negative
+               // indices count back from the last attribute read)
+  };
+
+  int32_t value = 0;
+  Kind kind = Kind::Missing;
+};
+
+/**
+ * Corner of a triangle: indices of its position, uv and normal.
+ */
+struct ObjCorner {
+  ObjIndex position;
+  ObjIndex uv;
+  ObjIndex normal;
+};
+
+/**
+ * Lines of the OBJ file parsed by one task.
+ */
+struct ObjChunk {
+  const char* begin;
+  const char* end;
+
+  // Attributes and triangles read from the chunk
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec2> uvs;
+  std::vector<ObjCorner> corners;  // 3 per triangle
+
+  // Materials used from a triangle on (before the first one, triangles keep
+  // the material of the previous chunk)
+  std::vector<std::pair<size_t, std::string>> materialNames;
+  std::vector<int> materialIds;  // Resolved names (-1 if unknown)
+  int initialMaterialId = -1;    // Material of the previous chunk's end
+  std::vector<std::vector<std::string>>
+      materialLibraries;  // File names of each mtllib line
+
+  // Offsets of the chunk's data among all the chunks
+  size_t positionOffset = 0;
+  size_t normalOffset = 0;
+  size_t uvOffset = 0;
+  std::vector<size_t> materialVertexOffsets;  // Per material
+
+  bool hasInvalidIndex = false;
+};
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static const char* skipSpaces(const char* p, const char* end) {
+  while (p < end && isSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char* skipToken(const char* p, const char* end) {
+  while (p < end && !isSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+/**
+ * Checks if the 8 characters starting at p are all digits.
+ */
+static bool isEightDigits(const char* p) {
+#if defined(__SSE2__)
+  // Subtracting '0' maps digits to 0-9 and wraps other characters above
+  const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+  const __m128i values = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+  const __m128i areDigits =
+      _mm_cmpeq_epi8(_mm_min_epu8(values, _mm_set1_epi8(9)), values);
+  return (_mm_movemask_epi8(areDigits) & 0xFF) == 0xFF;
+#else
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return ((value & 0xF0F0F0F0F0F0F0F0) |
+          (((value + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+#endif
+}
+
+/**
+ * Parses the 8 digits starting at p, combining them pairwise in parallel.
+ */
+static uint32_t parseEightDigits(const char* p) {
+#if defined(__SSE2__)
+  // Digits as 16 bits values, then combined into pairs and quads with
+  // multiply-adds
+  const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+  const __m128i digits = _mm_unpacklo_epi8(
+      _mm_sub_epi8(bytes, _mm_set1_epi8('0')), _mm_setzero_si128());
+  const __m128i pairs = _mm_madd_epi16(
+      digits, _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1));
+  const __m128i quads =
+      _mm_madd_epi16(_mm_packs_epi32(pairs, pairs),
+                     _mm_setr_epi16(100, 1, 100, 1, 0, 0, 0, 0));
+  return static_cast<uint32_t>(_mm_cvtsi128_si32(quads)) * 10000 +
+         static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(quads, 4)));
+#else
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  value = (value & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+  value = (value & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+  return static_cast<uint32_t>((value & 0x0000FFFF0000FFFF) *
+                                   42949672960001 >>
+                               32);
+#endif
+}
+
+/**
+ * Accumulates digits into a mantissa, counting the significant ones (digits
+ * past the capacity of the mantissa are counted but not accumulated).
+ */
+static const char* parseDigits(const char* p,
+                               const char* end,
+                               uint64_t& mantissa,
+                               int& significantDigitCount) {
+  if (CAN_PARSE_EIGHT_DIGITS) {
+    while (end - p >= 8 &&
+           significantDigitCount + 8 <= MAX_MANTISSA_DIGITS &&
+           isEightDigits(p)) {
+      mantissa = mantissa * 100000000 + parseEightDigits(p);
+      if (mantissa != 0) {
+        significantDigitCount += 8;
+      }
+      p += 8;
+    }
+  }
+
+  while (p < end && isDigit(*p)) {
+    const auto digit = static_cast<uint64_t>(*p - '0');
+    if (mantissa != 0 || digit != 0) {
+      if (significantDigitCount < MAX_MANTISSA_DIGITS) {
+        mantissa = mantissa * 10 + digit;
+      }
+      significantDigitCount++;
+    }
+    p++;
+  }
+
+  return p;
+}
+
+/**
+ * Parses a decimal floating point number.
+ * @return End of the number, or p if there is none (then value is unchanged)
+ */
+static const char* parseFloat(const char* p, const char* end, float& value) {
+  const char* start = p;
+  bool isNegative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    isNegative = *p == '-';
+    p++;
+  }
+
+  uint64_t mantissa = 0;
+  int significantDigitCount = 0;
+  int exponent = 0;
+  const char* integerStart = p;
+  p = parseDigits(p, end, mantissa, significantDigitCount);
+  bool hasDigits = p != integerStart;
+  if (p < end && *p == '.') {
+    p++;
+    const char* fractionStart = p;
+    p = parseDigits(p, end, mantissa, significantDigitCount);
+    exponent -= static_cast<int>(p - fractionStart);
+    hasDigits |= p != fractionStart;
+  }
+  if (!hasDigits) {
+    return start;
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    bool isExponentNegative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+      isExponentNegative = *q == '-';
+      q++;
+    }
+    if (q < end && isDigit(*q)) {
+      int writtenExponent = 0;
+      for (; q < end && isDigit(*q); q++) {
+        writtenExponent = std::min(writtenExponent * 10 + (*q - '0'), 100000);
+      }
+      exponent += isExponentNegative ? -writtenExponent : writtenExponent;
+      p = q;
+    }
+  }
+
+  // Exact when both the mantissa and the power of ten are exact doubles
+  // (nearly always the case for mesh data), otherwise left to the C library
+  double result;
+  if (mantissa == 0) {
+    result = 0.0;
+  } else if (significantDigitCount <= MAX_MANTISSA_DIGITS &&
+             mantissa <= (uint64_t(1) << 53) && exponent >= -22 &&
+             exponent <= 22) {
+    result = exponent < 0
+                 ? double(mantissa) / EXACT_POWERS_OF_TEN[-exponent]
+                 : double(mantissa) * EXACT_POWERS_OF_TEN[exponent];
+  } else {
+    const std::string number(start, p);
+    value = static_cast<float>(std::strtod(number.c_str(), nullptr));
+    return p;
+  }
+
+  value = static_cast<float>(isNegative ? -result : result);
+  return p;
+}
+
+/**
+ * Parses floating point numbers separated by spaces (missing ones are 0).
+ */
+static const char* parseFloats(const char* p,
+                               const char* end,
+                               float* values,
+                               int count) {
+  for (int i = 0; i < count; i++) {
+    values[i] = 0.0f;
+    p = parseFloat(skipSpaces(p, end), end, values[i]);
+  }
+  return p;
+}
+
+/**
+ * Parses a (possibly negative) integer.
+ * @return End of the integer, or p if there is none (then value is 0)
+ */
+static const char* parseInt(const char* p, const char* end, int32_t& value) {
+  const char* start = p;
+  bool isNegative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    isNegative = *p == '-';
+    p++;
+  }
+
+  int64_t result = 0;
+  const char* digitsStart = p;
+  for (; p < end && isDigit(*p); p++) {
+    result = std::min<int64_t>(result * 10 + (*p - '0'), INT32_MAX);
+  }
+  if (p == digitsStart) {
+    value = 0;
+    return start;
+  }
+
+  value = static_cast<int32_t>(isNegative ? -result : result);
+  return p;
+}
+
+/**
+ * Parses the index of a face corner attribute.
+ * @param attributeCount Number of attributes of that kind read so far in the
+ * chunk
+ */
+static const char* parseIndex(const char* p,
+                              const char* end,
+                              size_t attributeCount,
+                              ObjIndex& index) {
+  int32_t value;
+  p = parseInt(p, end, value);
+  if (value > 0) {
+    index = {value - 1, ObjIndex::Kind::Absolute};
+  } else if (value < 0) {
+    index = {static_cast<int32_t>(attributeCount) + value,
+             ObjIndex::Kind::Relative};
+  } else {
+    index = {};
+  }
+
+  // Skip what isn't an index (like tinyobjloader does)
+  while (p < end && *p != '/' && !isSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+/**
+ * Parses a face corner: "v", "v/vt", "v//vn" or "v/vt/vn".
+ */
+static const char* parseCorner(const char* p,
+                               const char* end,
+                               const ObjChunk& chunk,
+                               ObjCorner& corner) {
+  corner = {};
+  p = parseIndex(p, end, chunk.positions.size(), corner.position);
+  if (p >= end || *p != '/') {
+    return p;
+  }
+  p++;
+
+  if (p < end && *p != '/') {
+    p = parseIndex(p, end, chunk.uvs.size(), corner.uv);
+    if (p >= end || *p != '/') {
+      return p;
+    }
+  }
+  p++;
+
+  return parseIndex(p, end, chunk.normals.size(), corner.normal);
+}
+
+static bool startsWithKeyword(const char* p,
+                              const char* end,
+                              const char* keyword) {
+  const auto length = strlen(keyword);
+  return size_t(end - p) > length && memcmp(p, keyword, length) == 0 &&
+         isSpace(p[length]);
+}
+
+/**
+ * Reads the attributes, triangles and material changes of a chunk.
+ */
+static void parseChunk(ObjChunk& chunk) {
+  std::vector<ObjCorner> polygon;
+
+  const char* p = chunk.begin;
+  while (p < chunk.end) {
+    auto lineEnd =
+        static_cast<const char*>(memchr(p, '\n', size_t(chunk.end - p)));
+    if (lineEnd == nullptr) {
+      lineEnd = chunk.end;
+    }
+    p = skipSpaces(p, lineEnd);
+
+    if (startsWithKeyword(p, lineEnd, "v")) {
+      float position[3];
+      parseFloats(p + 2, lineEnd, position, 3);
+      chunk.positions.emplace_back(position[0], position[1], position[2]);
+    } else if (startsWithKeyword(p, lineEnd, "vn")) {
+      float normal[3];
+      parseFloats(p + 3, lineEnd, normal, 3);
+      chunk.normals.emplace_back(normal[0], normal[1], normal[2]);
+    } else if (startsWithKeyword(p, lineEnd, "vt")) {
+      float uv[2];
+      parseFloats(p + 3, lineEnd, uv, 2);
+      chunk.uvs.emplace_back(uv[0], uv[1]);
+    } else if (startsWithKeyword(p, lineEnd, "f")) {
+      polygon.clear();
+      const char* q = skipSpaces(p + 2, lineEnd);
+      while (q < lineEnd) {
+        ObjCorner corner;
+        const char* next = parseCorner(q, lineEnd, chunk, corner);
+        if (next == q) {
+          break;
+        }
+        polygon.push_back(corner);
+        q = skipSpaces(next, lineEnd);
+      }
+
+      // Triangulate as a fan
+      for (size_t k = 2; k < polygon.size(); k++) {
+        chunk.corners.push_back(polygon[0]);
+        chunk.corners.push_back(polygon[k - 1]);
+        chunk.corners.push_back(polygon[k]);
+      }
+    } else if (startsWithKeyword(p, lineEnd, "usemtl")) {
+      const char* name = skipSpaces(p + 6, lineEnd);
+      chunk.materialNames.emplace_back(
+          chunk.corners.size() / 3,
+          std::string(name, skipToken(name, lineEnd)));
+    } else if (startsWithKeyword(p, lineEnd, "mtllib")) {
+      const char* name = skipSpaces(p + 6, lineEnd);
+      chunk.materialLibraries.emplace_back();
+      while (name < lineEnd) {
+        const char* nameEnd = skipToken(name, lineEnd);
+        chunk.materialLibraries.back().emplace_back(name, nameEnd);
+        name = skipSpaces(nameEnd, lineEnd);
+      }
+    }
+
+    p = lineEnd + 1;
+  }
+}
+
+/**
+ * Resolves the index of a face corner attribute.
+ * @return The index among all the attributes, or -1 if missing or invalid
+ */
+static int64_t resolveIndex(const ObjIndex& index,
+                            size_t chunkOffset,
+                            size_t attributeCount) {
+  int64_t resolved = -1;
+  if (index.kind == ObjIndex::Kind::Absolute) {
+    resolved = index.value;
+  } else if (index.kind == ObjIndex::Kind::Relative) {
+    resolved = int64_t(chunkOffset) + index.value;
+  }
+  return resolved < int64_t(attributeCount) ? resolved : -1;
+}
+
+bool ObjParser::parse(const std::string& filePath) {
+  materials.clear();
+  materialVertices.clear();
+
+  MappedFile file;
+  if (!file.open(filePath)) {
+    std::cerr << "Unable to open OBJ file: " << filePath << "\n";
+    return false;
+  }
+  const auto data = reinterpret_cast<const char*>(file.getData());
+  const auto size = file.getSize();
+
+  // Split the file in chunks of whole lines, a few per thread so that
+  // uneven chunks balance out
+  auto& threadPool = ThreadPool::getInstance();
+  const size_t chunkCount = std::max<size_t>(
+      1, std::min(size / MIN_CHUNK_SIZE, threadPool.getThreadCount() * 4));
+  std::vector<ObjChunk> chunks;
+  const char* chunkBegin = data;
+  for (size_t i = 1; i <= chunkCount && chunkBegin < data + size; i++) {
+    const char* chunkEnd = data + size * i / chunkCount;
+    if (chunkEnd < chunkBegin) {
+      chunkEnd = chunkBegin;
+    }
+    const auto lineEnd = static_cast<const char*>(
+        memchr(chunkEnd, '\n', size_t(data + size - chunkEnd)));
+    chunkEnd = lineEnd != nullptr ? lineEnd + 1 : data + size;
+
+    ObjChunk chunk;
+    chunk.begin = chunkBegin;
+    chunk.end = chunkEnd;
+    chunks.push_back(std::move(chunk));
+    chunkBegin = chunkEnd;
+  }
+
+  // First pass: attributes and triangles of each chunk
+  threadPool.parallelFor(chunks.size(),
+                         [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+  // Load the materials, then follow the material changes through the chunks
+  // (each mtllib line once, whichever chunk it is in, the first of its
+  // libraries that can be read being used, and each library read once)
+  const auto baseDirectory =
+      filePath.substr(0, filePath.find_last_of("/\\") + 1);
+  std::set<std::vector<std::string>> libraryLines;
+  std::set<std::string> loadedLibraries, unreadableLibraries;
+  for (const auto& chunk : chunks) {
+    for (const auto& libraries : chunk.materialLibraries) {
+      if (!libraryLines.insert(libraries).second) {
+        continue;
+      }
+      for (const auto& library : libraries) {
+        if (loadedLibraries.count(library) > 0) {
+          break;
+        }
+        if (unreadableLibraries.count(library) > 0) {
+          continue;
+        }
+        if (parseMaterials(baseDirectory + library)) {
+          loadedLibraries.insert(library);
+          break;
+        }
+        unreadableLibraries.insert(library);
+      }
+    }
+  }
+  std::map<std::string, int> materialIds;
+  for (size_t m = 0; m < materials.size(); m++) {
+    materialIds.insert({materials[m].name, static_cast<int>(m)});
+  }
+
+  int materialId = -1;
+  for (auto& chunk : chunks) {
+    chunk.initialMaterialId = materialId;
+    for (const auto& materialName : chunk.materialNames) {
+      const auto id = materialIds.find(materialName.second);
+      materialId = id != materialIds.end() ? id->second : -1;
+      chunk.materialIds.push_back(materialId);
+    }
+  }
+
+  // Offsets of each chunk's attributes, and of its vertices in each
+  // material's array (faces without material go to an extra one)
+  const size_t materialSlotCount = materials.size() + 1;
+  std::vector<size_t> materialVertexCounts(materialSlotCount, 0);
+  size_t positionCount = 0, normalCount = 0, uvCount = 0;
+  for (auto& chunk : chunks) {
+    chunk.positionOffset = positionCount;
+    chunk.normalOffset = normalCount;
+    chunk.uvOffset = uvCount;
+    positionCount += chunk.positions.size();
+    normalCount += chunk.normals.size();
+    uvCount += chunk.uvs.size();
+
+    chunk.materialVertexOffsets = materialVertexCounts;
+    const size_t triangleCount = chunk.corners.size() / 3;
+    int rangeMaterialId = chunk.initialMaterialId;
+    size_t rangeBegin = 0;
+    for (size_t r = 0; r <= chunk.materialNames.size(); r++) {
+      const size_t rangeEnd = r < chunk.materialNames.size()
+                                  ? chunk.materialNames[r].first
+                                  : triangleCount;
+      const size_t slot =
+          rangeMaterialId >= 0 ? size_t(rangeMaterialId) : materials.size();
+      materialVertexCounts[slot] += (rangeEnd - rangeBegin) * 3;
+      if (r < chunk.materialIds.size()) {
+        rangeMaterialId = chunk.materialIds[r];
+      }
+      rangeBegin = rangeEnd;
+    }
+  }
+
+  if (materialVertexCounts.back() > 0) {
+    Material defaultMaterial;
+    defaultMaterial.ambient = glm::vec3(0.2f);
+    defaultMaterial.diffuse = glm::vec3(0.8f);
+    materials.push_back(defaultMaterial);
+  } else {
+    materialVertexCounts.pop_back();
+  }
+  materialVertices.resize(materials.size());
+  for (size_t m = 0; m < materials.size(); m++) {
+    materialVertices[m].resize(materialVertexCounts[m],
+                               Vertex(glm::vec3(0), glm::vec3(0), glm::vec2(0)));
+  }
+
+  // Gather the attributes of all the chunks
+  std::vector<glm::vec3> positions(positionCount);
+  std::vector<glm::vec3> normals(normalCount);
+  std::vector<glm::vec2> uvs(uvCount);
+  threadPool.parallelFor(chunks.size(), [&](size_t i) {
+    const auto& chunk = chunks[i];
+    std::copy(chunk.positions.begin(), chunk.positions.end(),
+              positions.begin() + chunk.positionOffset);
+    std::copy(chunk.normals.begin(), chunk.normals.end(),
+              normals.begin() + chunk.normalOffset);
+    std::copy(chunk.uvs.begin(), chunk.uvs.end(),
+              uvs.begin() + chunk.uvOffset);
+  });
+
+  // Second pass: vertices of each chunk, written at their final place
+  threadPool.parallelFor(chunks.size(), [&](size_t i) {
+    auto& chunk = chunks[i];
+    auto vertexOffsets = chunk.materialVertexOffsets;
+    int rangeMaterialId = chunk.initialMaterialId;
+    size_t nextMaterialName = 0;
+    for (size_t c = 0; c < chunk.corners.size(); c++) {
+      while (nextMaterialName < chunk.materialNames.size() &&
+             chunk.materialNames[nextMaterialName].first * 3 <= c) {
+        rangeMaterialId = chunk.materialIds[nextMaterialName++];
+      }
+      const size_t slot =
+          rangeMaterialId >= 0 ? size_t(rangeMaterialId) : materials.size() - 1;
+
+      const auto& corner = chunk.corners[c];
+      const auto position =
+          resolveIndex(corner.position, chunk.positionOffset, positionCount);
+      const auto normal =
+          resolveIndex(corner.normal, chunk.normalOffset, normalCount);
+      const auto uv = resolveIndex(corner.uv, chunk.uvOffset, uvCount);
+      if (position < 0) {
+        chunk.hasInvalidIndex = true;
+      }
+
+      materialVertices[slot][vertexOffsets[slot]++] =
+          Vertex(position >= 0 ? positions[position] : glm::vec3(0),
+                 normal >= 0 ? normals[normal] : glm::vec3(0),
+                 uv >= 0 ? uvs[uv] : glm::vec2(-1));
+    }
+  });
+
+  for (const auto& chunk : chunks) {
+    if (chunk.hasInvalidIndex) {
+      std::cerr << "Invalid vertex index in OBJ file: " << filePath << "\n";
+      materials.clear();
+      materialVertices.clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ObjParser::parseMaterials(const std::string& filePath) {
+  MappedFile file;
+  if (!file.open(filePath)) {
+    std::cerr << "Unable to open MTL file: " << filePath << "\n";
+    return false;
+  }
+  const auto data = reinterpret_cast<const char*>(file.getData());
+  const auto end = data + file.getSize();
+
+  // Like tinyobjloader, the material being read is added at the end even
+  // without name (so that a file without newmtl gives a default material)
+  Material material;
+  const char* p = data;
+  while (p < end) {
+    auto lineEnd = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+    if (lineEnd == nullptr) {
+      lineEnd = end;
+    }
+    p = skipSpaces(p, lineEnd);
+
+    // Trim the end of the line
+    auto contentEnd = lineEnd;
+    while (contentEnd > p && isSpace(contentEnd[-1])) {
+      contentEnd--;
+    }
+
+    if (startsWithKeyword(p, lineEnd, "newmtl")) {
+      if (!material.name.empty()) {
+        materials.push_back(material);
+      }
+      material = Material();
+      const char* name = skipSpaces(p + 6, contentEnd);
+      material.name = std::string(name, skipToken(name, contentEnd));
+    } else if (startsWithKeyword(p, lineEnd, "Ka")) {
+      parseFloats(p + 3, contentEnd, &material.ambient.x, 3);
+    } else if (startsWithKeyword(p, lineEnd, "Kd")) {
+      parseFloats(p + 3, contentEnd, &material.diffuse.x, 3);
+    } else if (startsWithKeyword(p, lineEnd, "Ks")) {
+      parseFloats(p + 3, contentEnd, &material.specular.x, 3);
+    } else if (startsWithKeyword(p, lineEnd, "Ns")) {
+      parseFloats(p + 3, contentEnd, &material.shininess, 1);
+    } else if (startsWithKeyword(p, lineEnd, "map_Kd")) {
+      // The file name comes after the texture options
+      auto nameBegin = contentEnd;
+      while (nameBegin > p && !isSpace(nameBegin[-1])) {
+        nameBegin--;
+      }
+      material.diffuseTextureFilename = std::string(nameBegin, contentEnd);
+    }
+
+    p = lineEnd + 1;
+  }
+  materials.push_back(material);
+
+  return true;
+}
+
+bool ObjParser::findMaterialLibraries(const std::string& filePath,
+                                      std::vector<std::string>& libraryPaths) {
+  libraryPaths.clear();
+  MappedFile file;
+  if (!file.open(filePath)) {
+    return false;
+  }
+  const auto data = reinterpret_cast<const char*>(file.getData());
+  const auto end = data + file.getSize();
+
+  const auto baseDirectory =
+      filePath.substr(0, filePath.find_last_of("/\\") + 1);
+  const char* p = data;
+  while (p < end) {
+    auto lineEnd = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+    if (lineEnd == nullptr) {
+      lineEnd = end;
+    }
+    p = skipSpaces(p, lineEnd);
+
+    if (startsWithKeyword(p, lineEnd, "mtllib")) {
+      const char* name = skipSpaces(p + 6, lineEnd);
+      while (name < lineEnd) {
+        const char* nameEnd = skipToken(name, lineEnd);
+        const auto libraryPath = baseDirectory + std::string(name, nameEnd);
+        if (std::find(libraryPaths.begin(), libraryPaths.end(),
+                      libraryPath) == libraryPaths.end()) {
+          libraryPaths.push_back(libraryPath);
+        }
+        name = skipSpaces(nameEnd, lineEnd);
+      }
+    }
+
+    p = lineEnd + 1;
+  }
+
+  return true;
+}
+
+size_t ObjParser::getTriangleCount() const {
+  size_t triangleCount = 0;
+  for (const auto& vertices : materialVertices) {
+    triangleCount += vertices.size() / 3;
+  }
+  return triangleCount;
+}
@@ -0,0 +1,78 @@
+#ifndef OBJ_PARSER_HPP
+#define OBJ_PARSER_HPP
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "vertex.hpp"
+
+/**
+ * Wavefront OBJ (and MTL) reader, producing the triangle vertices of each
+ * material.
+ *
+ * The OBJ file is memory-mapped and split into chunks of lines parsed in
+ * parallel: a first pass reads the attributes and faces of each chunk, then
+ * once the attribute offsets and per-material triangle counts of all the
+ * chunks are known, a second pass writes the vertices of each chunk straight
+ * into their place in the preallocated per-material arrays.
+ *
+ * The output matches tinyobjloader's (polygons are triangulated as fans,
+ * missing normals are zero and missing uvs are -1), except that faces without
+ * material get a default one instead of an invalid material id.
+ */
+class ObjParser {
+ public:
+  /**
+   * Material read from an MTL file.
+   */
+  struct Material {
+    std::string name;
+    glm::vec3 ambient = glm::vec3(0);
+    glm::vec3 diffuse = glm::vec3(0);
+    glm::vec3 specular = glm::vec3(0);
+    float shininess = 1.0f;
+    std::string diffuseTextureFilename;  // Empty if none
+  };
+
+  std::vector<Material> materials;  // Materials, in the order of the MTL files
+  std::vector<std::vector<Vertex>>
+      materialVertices;  // Triangle vertices of each material, in file order
+
+  /**
+   * Parses an OBJ file and the MTL files it references (relative to its
+   * directory).
+   * @param filePath Path to the OBJ file
+   * @return True if the file has been parsed, false otherwise
+   */
+  bool parse(const std::string& filePath);
+
+  /**
+   * Parses an MTL file, appending its materials.
+   * @param filePath Path to the MTL file
+   * @return True if the file has been parsed, false if it couldn't be opened
+   */
+  bool parseMaterials(const std::string& filePath);
+
+  /**
+   * Finds the MTL files an OBJ file references, without parsing it.
+   * @param filePath       Path to the OBJ file
+   * @param libraryPaths   Set to the paths of the MTL files (relative to the
+   * OBJ file's directory, all the alternatives of each mtllib line included),
+   * in file order and without duplicates
+   * @return True if the OBJ file has been read, false otherwise
+   */
+  static bool findMaterialLibraries(const std::string& filePath,
+                                    std::vector<std::string>& libraryPaths);
+
+  /**
+   * Gets the number of triangles parsed (all materials).
+   */
+  size_t getTriangleCount() const;
+
+  // Minimal size of the chunks parsed in parallel (in bytes)
+  static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "packed_geometry.hpp"
+
+static const uint16_t QUANTIZED_MAX = 0xFFFF;
+
+/**
+ * Packs a normal into signed normalized 10 bits components
+ * (GL_INT_2_10_10_10_REV). Missing normals (zero) stay zero.
+ */
+static uint32_t packNormal(const glm::vec3& normal) {
+  const auto length = glm::length(normal);
+  const auto unitNormal = length > 0 ? normal / length : glm::vec3(0);
+
+  uint32_t packed = 0;
+  for (int i = 0; i < 3; i++) {
+    const auto component =
+        static_cast<int32_t>(std::lround(unitNormal[i] * 511.0f));
+    packed |= (uint32_t(component) & 0x3FF) << (10 * i);
+  }
+  return packed;
+}
+
+static void packUV(const glm::vec2& uv, uint16_t packed[2]) {
+  packed[0] = glm::packHalf1x16(uv.x);
+  packed[1] = glm::packHalf1x16(uv.y);
+}
+
+PackedGeometry PackedGeometry::pack(const Vertex* vertices,
+                                    size_t vertexCount) {
+  PackedGeometry geometry;
+  if (vertexCount == 0) {
+    return geometry;
+  }
+
+  // Half floats must keep the UVs accurate (e.g. no large tiling factors)
+  for (size_t i = 0; i < vertexCount; i++) {
+    const auto& uv = vertices[i].uv;
+    const auto packedUV = glm::vec2(glm::unpackHalf1x16(glm::packHalf1x16(uv.x)),
+                                    glm::unpackHalf1x16(glm::packHalf1x16(uv.y)));
+    if (glm::any(glm::greaterThan(glm::abs(packedUV - uv),
+                                  glm::vec2(MAX_UV_ERROR)))) {
+      return geometry;
+    }
+  }
+
+  // Bounding box, to quantize the positions when it's small enough
+  glm::vec3 aabbMin = vertices[0].position;
+  glm::vec3 aabbMax = vertices[0].position;
+  for (size_t i = 1; i < vertexCount; i++) {
+    aabbMin = glm::min(aabbMin, vertices[i].position);
+    aabbMax = glm::max(aabbMax, vertices[i].position);
+  }
+  const auto extent = aabbMax - aabbMin;
+  const auto maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+
+  if (maxExtent / QUANTIZED_MAX <= MAX_POSITION_STEP) {
+    geometry.format = Format::Quantized;
+
+    // Flat axes still need a non-null scale
+    const auto scale = glm::max(extent, glm::vec3(1e-6f));
+    geometry.positionTransform =
+        glm::scale(glm::translate(glm::mat4(1), aabbMin), scale);
+
+    std::vector<QuantizedVertex> packedVertices(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+      const auto normalized = (vertices[i].position - aabbMin) / scale;
+      for (int c = 0; c < 3; c++) {
+        packedVertices[i].position[c] = static_cast<uint16_t>(std::lround(
+            glm::clamp(normalized[c], 0.0f, 1.0f) * QUANTIZED_MAX));
+      }
+      packedVertices[i].position[3] = 0;
+      packedVertices[i].normal = packNormal(vertices[i].normal);
+      packUV(vertices[i].uv, packedVertices[i].uv);
+    }
+
+    geometry.vertexData.resize(vertexCount * sizeof(QuantizedVertex));
+    memcpy(geometry.vertexData.data(), packedVertices.data(),
+           geometry.vertexData.size());
+  } else {
+    geometry.format = Format::Packed;
+
+    std::vector<PackedVertex> packedVertices(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+      memcpy(packedVertices[i].position, &vertices[i].position,
+             sizeof(packedVertices[i].position));
+      packedVertices[i].normal = packNormal(vertices[i].normal);
+      packUV(vertices[i].uv, packedVertices[i].uv);
+    }
+
+    geometry.vertexData.resize(vertexCount * sizeof(PackedVertex));
+    memcpy(geometry.vertexData.data(), packedVertices.data(),
+           geometry.vertexData.size());
+  }
+
+  return geometry;
+}
+
+const VertexLayout& PackedGeometry::getLayout() const {
+  return getLayout(format);
+}
+
+const VertexLayout& PackedGeometry::getLayout(Format format) {
+  static const VertexLayout floatLayout{
+      sizeof(Vertex),
+      {{VertexLayout::ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE,
+        offsetof(Vertex, position)},
+       {VertexLayout::ATTRIBUTE_NORMAL, 3, GL_FLOAT, GL_FALSE,
+        offsetof(Vertex, normal)},
+       {VertexLayout::ATTRIBUTE_UV, 2, GL_FLOAT, GL_FALSE,
+        offsetof(Vertex, uv)}}};
+  static const VertexLayout packedLayout{
+      sizeof(PackedVertex),
+      {{VertexLayout::ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE,
+        offsetof(PackedVertex, position)},
+       {VertexLayout::ATTRIBUTE_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE,
+        offsetof(PackedVertex, normal)},
+       {VertexLayout::ATTRIBUTE_UV, 2, GL_HALF_FLOAT, GL_FALSE,
+        offsetof(PackedVertex, uv)}}};
+  static const VertexLayout quantizedLayout{
+      sizeof(QuantizedVertex),
+      {{VertexLayout::ATTRIBUTE_POSITION, 3, GL_UNSIGNED_SHORT, GL_TRUE,
+        offsetof(QuantizedVertex, position)},
+       {VertexLayout::ATTRIBUTE_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE,
+        offsetof(QuantizedVertex, normal)},
+       {VertexLayout::ATTRIBUTE_UV, 2, GL_HALF_FLOAT, GL_FALSE,
+        offsetof(QuantizedVertex, uv)}}};
+
+  switch (format) {
+    case Format::Packed:
+      return packedLayout;
+    case Format::Quantized:
+      return quantizedLayout;
+    default:
+      return floatLayout;
+  }
+}
+
+size_t PackedGeometry::getVertexSize() const {
+  return static_cast<size_t>(getLayout().stride);
+}
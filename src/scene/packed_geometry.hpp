@@ -0,0 +1,81 @@
+#ifndef PACKED_GEOMETRY_HPP
+#define PACKED_GEOMETRY_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "vertex.hpp"
+#include "vertex_layout.hpp"
+
+/**
+ * Vertices of a mesh, in the most compact format that keeps them accurate:
+ * - Float: Vertex as is (32 bytes)
+ * - Packed: float positions, normals as GL_INT_2_10_10_10_REV and UVs as half
+ *   floats (20 bytes)
+ * - Quantized: Packed, with positions quantized to 16 bits inside the mesh's
+ *   bounding box (16 bytes), dequantized by the position transform
+ *
+ * The format is selected per mesh, from the error each step would introduce.
+ */
+class PackedGeometry {
+ public:
+  enum class Format { Float, Packed, Quantized };
+
+  /**
+   * Vertex of the Packed format.
+   */
+  struct PackedVertex {
+    float position[3];
+    uint32_t normal;  // GL_INT_2_10_10_10_REV (w unused)
+    uint16_t uv[2];   // Half floats
+  };
+
+  /**
+   * Vertex of the Quantized format.
+   */
+  struct QuantizedVertex {
+    uint16_t position[4];  // Normalized inside the bounding box (w unused,
+                           // keeps the vertex aligned)
+    uint32_t normal;       // GL_INT_2_10_10_10_REV (w unused)
+    uint16_t uv[2];        // Half floats
+  };
+
+  Format format = Format::Float;  // Selected format
+  std::vector<uint8_t>
+      vertexData;  // Packed vertices (empty for Float, use the source vertices)
+  glm::mat4 positionTransform =
+      glm::mat4(1);  // Maps the vertex positions to model space (dequantizes
+                     // Quantized positions, identity otherwise)
+
+  /**
+   * Packs vertices into the most compact accurate format.
+   * @param vertices     Pointer to the first vertex
+   * @param vertexCount  Number of vertices
+   * @return The packed geometry
+   */
+  static PackedGeometry pack(const Vertex* vertices, size_t vertexCount);
+
+  /**
+   * Gets the layout of the vertices of the selected format.
+   */
+  const VertexLayout& getLayout() const;
+
+  /**
+   * Gets the layout of the vertices of the given format.
+   */
+  static const VertexLayout& getLayout(Format format);
+
+  /**
+   * Gets size of a vertex of the selected format, in bytes.
+   */
+  size_t getVertexSize() const;
+
+  // Maximal error allowed on UVs stored as half floats
+  static constexpr float MAX_UV_ERROR = 1.0f / 4096.0f;
+  // Maximal quantization step allowed on positions (in model units)
+  static constexpr float MAX_POSITION_STEP = 0.01f;
+};
+
+#endif
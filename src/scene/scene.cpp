@@ -13,6 +13,8 @@
 #include "../utils/math_utils.h"
 #include "../utils/string_utils.hpp"
 
+#include "model_manager.hpp"
+
 #include "scene.hpp"
 
 Scene::Scene(const bool isDefault)
@@ -25,7 +27,27 @@ Scene::Scene(const bool isDefault)
 
 void Scene::_initDefaultScene()
 {
-  // Objects
+  // Start loading all models in parallel (parsing and texture decoding),
+  // each distinct model only once
+  const std::string modelNames[] = {
+      "cart",
+      "coaster",
+      "tree_1",
+      "building_1",
+      "building_2",
+      "lamp_post",
+      "lantern",
+      "rock",
+      "tree_2",
+      "tree_3",
+      "tree_4",
+      "tree_5",
+  };
+  for (const auto& modelName : modelNames) {
+    ModelManager::getInstance().loadModelAsync(modelName);
+  }
+
+  // Objects (sharing their models, uploaded to the GPU once they're ready)
   auto cart = new SceneObject("cart");
   auto coaster = new SceneObject("coaster");
   auto tree = new SceneObject("tree_1");
@@ -74,6 +96,7 @@ void Scene::_initDefaultScene()
   rock_2->setRotation(glm::vec3(3.14, 0.0, 0.0));
 
   objects.emplace_back(cart);
+  _cart.objectIndex = objects.size() - 1;
   objects.emplace_back(coaster);
   objects.emplace_back(tree);
   objects.emplace_back(building1);
@@ -89,6 +112,11 @@ void Scene::_initDefaultScene()
   objects.emplace_back(tree4_2);
   objects.emplace_back(tree4_3);
   objects.emplace_back(tree5);
+  _movingObjects = {_cart.objectIndex};
+
+  // Large objects hiding the others
+  building1->setOccluder(true);
+  building2->setOccluder(true);
 
   // Ambient lights
   shader_structs::AmbientLight ambientLight(glm::vec3(1.0, 1.0, 1.0), 0.1f);
@@ -106,9 +134,124 @@ void Scene::_initDefaultScene()
                                          glm::vec3(22.0, 9.0, 20.0), 1e-4f);
   pointLights.emplace_back(pointLight1);
   pointLights.emplace_back(pointLight2);
+
+  // Hierarchies queried by the first frame (update() runs after it)
+  _updateBvh();
 }
 
 void Scene::update(const std::function<float(float)> &speedCorrectionFunc)
+{
+  if (_cart.objectIndex < objects.size())
+    _updateCart(speedCorrectionFunc);
+  _updateBvh();
+}
+
+void Scene::queryObjectsInFrustum(const Frustum &frustum,
+                                  std::vector<size_t> &objectIndices) const
+{
+  _staticObjectsBvh.queryFrustum(frustum, objectIndices);
+  _movingObjectsBvh.queryFrustum(frustum, objectIndices);
+}
+
+void Scene::queryObjectsInBox(const BoundingBox &box,
+                              std::vector<size_t> &objectIndices) const
+{
+  _staticObjectsBvh.queryBox(box, objectIndices);
+  _movingObjectsBvh.queryBox(box, objectIndices);
+}
+
+void Scene::queryObjectsInSphere(const glm::vec3 &center,
+                                 float radius,
+                                 std::vector<size_t> &objectIndices) const
+{
+  _staticObjectsBvh.querySphere(center, radius, objectIndices);
+  _movingObjectsBvh.querySphere(center, radius, objectIndices);
+}
+
+void Scene::queryObjectsOnRay(const glm::vec3 &origin,
+                              const glm::vec3 &direction,
+                              float maxDistance,
+                              std::vector<size_t> &objectIndices) const
+{
+  _staticObjectsBvh.queryRay(origin, direction, maxDistance, objectIndices);
+  _movingObjectsBvh.queryRay(origin, direction, maxDistance, objectIndices);
+}
+
+const std::vector<size_t> &Scene::getMovingObjects() const
+{
+  return _movingObjects;
+}
+
+size_t Scene::getStaticBvhRevision() const
+{
+  return _staticBvhRevision;
+}
+
+void Scene::_updateBvh()
+{
+  // Build both hierarchies when objects were added or removed
+  if (_objectBoundsRevisions.size() != objects.size())
+  {
+    std::vector<BoundingBox> boxes(objects.size());
+    std::vector<size_t> staticObjects;
+    _objectBoundsRevisions.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+      boxes[i] = {objects[i]->getWorldAabbMin(),
+                  objects[i]->getWorldAabbMax()};
+      _objectBoundsRevisions[i] = objects[i]->getBoundsRevision();
+      if (std::find(_movingObjects.begin(), _movingObjects.end(), i) ==
+          _movingObjects.end())
+        staticObjects.push_back(i);
+    }
+    _staticObjectsBvh.build(staticObjects, boxes);
+    _staticBvhRevision++;
+    _buildMovingObjectsBvh();
+    return;
+  }
+
+  // Refit the objects whose bounds changed (moved, or their model reloaded)
+  for (size_t i = 0; i < objects.size(); i++)
+  {
+    const auto boundsRevision = objects[i]->getBoundsRevision();
+    if (boundsRevision == _objectBoundsRevisions[i])
+      continue;
+    _objectBoundsRevisions[i] = boundsRevision;
+
+    const BoundingBox box = {objects[i]->getWorldAabbMin(),
+                             objects[i]->getWorldAabbMax()};
+    const bool isMoving = std::find(_movingObjects.begin(),
+                                    _movingObjects.end(),
+                                    i) != _movingObjects.end();
+    if (isMoving)
+      _movingObjectsBvh.refit(i, box);
+    else
+    {
+      _staticObjectsBvh.refit(i, box);
+      _staticBvhRevision++;
+    }
+  }
+
+  // Rebuild the moving objects' hierarchy once refits degraded it too much
+  if (_movingObjectsBvh.getCost() >
+      _movingObjectsBvhCost * MAX_BVH_COST_GROWTH)
+    _buildMovingObjectsBvh();
+}
+
+void Scene::_buildMovingObjectsBvh()
+{
+  std::vector<BoundingBox> boxes(objects.size());
+  for (const auto objectIndex : _movingObjects)
+  {
+    boxes[objectIndex] = {objects[objectIndex]->getWorldAabbMin(),
+                          objects[objectIndex]->getWorldAabbMax()};
+  }
+  _movingObjectsBvh.build(_movingObjects, boxes);
+  _movingObjectsBvhCost = _movingObjectsBvh.getCost();
+}
+
+void Scene::_updateCart(
+    const std::function<float(float)> &speedCorrectionFunc)
 {
   // If first update, initialize the cart
   if (_cart.needsInit && !spline::cart.empty())
@@ -147,7 +290,7 @@ void Scene::update(const std::function<float(float)> &speedCorrectionFunc)
                  glm::angle(normalizedMovement, yAxis);
 
   // Set the cart's position and rotation
-  auto &cart = objects.front();
+  auto &cart = objects[_cart.objectIndex];
   cart->setPosition(position + positionOffset);
   cart->setRotation(glm::vec3(0, yAngle, zAngle));
 
@@ -1,6 +1,7 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -12,6 +13,7 @@
 #include "../shader_structs/fog_parameters.hpp"
 #include "../shader_structs/material.hpp"
 #include "../shader_structs/point_light.hpp"
+#include "bounding_volume_hierarchy.hpp"
 #include "scene_object.hpp"
 
 class Scene {
@@ -39,6 +41,58 @@ class Scene {
 
   void update(const std::function<float(float)>& speedCorrectionFunc);
 
+  /**
+   * Appends the indices of the objects whose bounding box intersects a
+   * frustum (as of the last update).
+   */
+  void queryObjectsInFrustum(const Frustum& frustum,
+                             std::vector<size_t>& objectIndices) const;
+
+  /**
+   * Appends the indices of the objects whose bounding box intersects a box
+   * (as of the last update).
+   */
+  void queryObjectsInBox(const BoundingBox& box,
+                         std::vector<size_t>& objectIndices) const;
+
+  /**
+   * Appends the indices of the objects whose bounding box intersects a sphere
+   * (as of the last update).
+   */
+  void queryObjectsInSphere(const glm::vec3& center,
+                            float radius,
+                            std::vector<size_t>& objectIndices) const;
+
+  /**
+   * Appends the indices of the objects whose bounding box a ray crosses (as of
+   * the last update).
+   * @param origin         Origin of the ray
+   * @param direction      Direction of the ray
+   * @param maxDistance    Length of the ray, in lengths of direction
+   * @param objectIndices  Indices to append to
+   */
+  void queryObjectsOnRay(const glm::vec3& origin,
+                         const glm::vec3& direction,
+                         float maxDistance,
+                         std::vector<size_t>& objectIndices) const;
+
+  /**
+   * Gets the indices of the objects update() moves (the others only change
+   * when edited, e.g. when their model is reloaded).
+   */
+  const std::vector<size_t>& getMovingObjects() const;
+
+  /**
+   * Gets the revision of the static objects' hierarchy, which changes each
+   * time it's built or refitted (so that results of its queries can be
+   * cached).
+   */
+  size_t getStaticBvhRevision() const;
+
+  // Cost growth of the moving objects' hierarchy, through refits, after which
+  // it's rebuilt
+  static constexpr float MAX_BVH_COST_GROWTH = 2.0f;
+
  private:
   struct Cart {
     glm::vec3 lastPosition;
@@ -50,10 +104,33 @@ class Scene {
     float weight = 250.0f;
     float realIndex = 0.0f;
     bool needsInit = true;
+    size_t objectIndex = SIZE_MAX;  // Of its object (SIZE_MAX if none)
   };
 
   Cart _cart;
+
+  // Objects are split between a hierarchy built once, and a small one refitted
+  // as update() moves its objects
+  BoundingVolumeHierarchy _staticObjectsBvh;
+  BoundingVolumeHierarchy _movingObjectsBvh;
+  std::vector<size_t> _movingObjects;  // Indices of the objects update() moves
+  std::vector<size_t> _objectBoundsRevisions;  // As in the hierarchies
+  float _movingObjectsBvhCost = 0.0f;          // Cost when last built
+  size_t _staticBvhRevision = 0;  // See getStaticBvhRevision()
+
   void _initDefaultScene();
+  void _updateCart(const std::function<float(float)>& speedCorrectionFunc);
+
+  /**
+   * Builds the hierarchies when objects were added or removed, or refits the
+   * objects whose bounds changed.
+   */
+  void _updateBvh();
+
+  /**
+   * Builds the hierarchy of the moving objects.
+   */
+  void _buildMovingObjectsBvh();
 };
 
 #endif
\ No newline at end of file
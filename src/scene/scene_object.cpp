@@ -1,16 +1,13 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <utility>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-
 #include <glm/ext/matrix_transform.hpp>
 
-#include "../gl_wrappers/shader_program_manager.hpp"
-
-#include "vertex.hpp"
+#include "model_manager.hpp"
 
 #include "scene_object.hpp"
 
@@ -18,169 +15,91 @@ SceneObject::SceneObject(const std::string& modelName,
                          const glm::vec3& position,
                          const glm::vec3& rotation,
                          const glm::vec3& scale)
-    : _position(position), _rotation(rotation), _scale(scale) {
-  _loadModel(modelName);
-  _bufferData();
-  _getModelMatrix();  // Calculate model matrix for first time
-  _hasChanged = false;
+    : SceneObject(ModelManager::getInstance().getModel(modelName),
+                  position,
+                  rotation,
+                  scale) {}
+
+SceneObject::SceneObject(std::shared_ptr<Model> model,
+                         const glm::vec3& position,
+                         const glm::vec3& rotation,
+                         const glm::vec3& scale)
+    : _model(std::move(model)),
+      _position(position),
+      _rotation(rotation),
+      _scale(scale) {
+  _getModelMatrix();  // Calculate model matrix and bounds for first time
 }
 
 SceneObject::~SceneObject() {
-  // Cleanup
-  _objectMaterials.clear();
+  // Cleanup (the model is freed with its last object)
+  _model.reset();
 }
 
-void SceneObject::_loadModel(const std::string& modelName) {
-  std::cout << "Loading model: " << modelName << "\n";
+void SceneObject::submit(RenderQueue& renderQueue,
+                         RenderPass renderPass,
+                         ShaderProgram& shaderProgram,
+                         const glm::vec3& viewerPosition) {
+  const auto modelMatrix = _getModelMatrix();
 
-  // Vars that will contain loaded model
-  tinyobj::attrib_t attrib;
-  std::vector<tinyobj::shape_t> shapes;
-  std::vector<tinyobj::material_t> materials;
-  std::string err;
+  // Depth of the object's center
+  const float depth = glm::distance(viewerPosition, _worldSphereCenter);
 
-  // Load the model
-  bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err,
-                              ("models/" + modelName + "/model.obj").c_str(),
-                              ("models/" + modelName + "/").c_str());
+  // Level selected for the main camera (shadow maps may be kept across
+  // frames, whatever the camera does)
+  const auto lodLevel = renderPass == RenderPass::Depth ? 0 : _lodLevel;
 
-  if (!err.empty()) {
-    std::cerr << err << "\n";
-  }
-
-  if (!ret) {
-    exit(EXIT_FAILURE);
-  }
-  std::cout << "(";
-  std::cout << attrib.vertices.size() << " vertices, ";
-  std::cout << attrib.normals.size() << " normals, ";
-  std::cout << attrib.texcoords.size() << " texcoords";
-  std::cout << ")\n";
-
-  // Load object materials
-  for (tinyobj::material_t& material : materials) {
-    // Load material elements
-    glm::vec3 ambient(material.ambient[0], material.ambient[1],
-                      material.ambient[2]);
-    glm::vec3 diffuse(material.diffuse[0], material.diffuse[1],
-                      material.diffuse[2]);
-    glm::vec3 specular(material.specular[0], material.specular[1],
-                       material.specular[2]);
-    float shininess = material.shininess;
-    shader_structs::Material modelMaterial(ambient, diffuse, specular,
-                                           shininess);
-    auto objectMaterial = new SceneObjectMaterial(modelMaterial);
-
-    // Load texture
-    std::string textureFilename = material.diffuse_texname;
-    if (textureFilename.empty())  // When no texture given
-    {
-      objectMaterial->texture = nullptr;
-    } else {
-      std::shared_ptr<Texture> texture = std::make_shared<Texture>();
-      bool isTextureLoaded = texture->loadTexture2D(
-          "models/" + modelName + "/textures/" + textureFilename);
-      if (isTextureLoaded)  // When existent texture given
-      {
-        objectMaterial->texture = texture;
-      } else  // When inexistent texture given
-      {
-        objectMaterial->texture = Texture::getMissingTexture();
-      }
-    }
-
-    _objectMaterials.emplace_back(objectMaterial);
-  }
-
-  // Loop over shapes
-  for (size_t s = 0; s < shapes.size(); s++) {
-    // Loop over faces(polygon)
-    size_t index_offset = 0;
-    for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-      // per-face material
-      int idx_material = shapes[s].mesh.material_ids[f];
-
-      size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
-
-      // Loop over vertices in the face.
-      for (size_t v = 0; v < fv; v++) {
-        // access to vertex
-        tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-        tinyobj::real_t vx = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
-        tinyobj::real_t vy = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
-        tinyobj::real_t vz = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
-
-        glm::vec3 position(vx, vy, vz);
-
-        // Check if `normal_index` is zero or positive. negative = no normal
-        // data
-        glm::vec3 normal;
-        if (idx.normal_index >= 0 && attrib.normals.size() > 0) {
-          tinyobj::real_t nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
-          tinyobj::real_t ny = attrib.normals[3 * size_t(idx.normal_index) + 1];
-          tinyobj::real_t nz = attrib.normals[3 * size_t(idx.normal_index) + 2];
-          normal = glm::vec3(nx, ny, nz);
-        } else {
-          normal = glm::vec3(0);
-        }
-
-        // Check if `texcoord_index` is zero or positive. negative = no texcoord
-        // data
-        glm::vec2 uv;
-        if (idx.texcoord_index >= 0 && attrib.texcoords.size() > 0) {
-          tinyobj::real_t tx =
-              attrib.texcoords[2 * size_t(idx.texcoord_index) + 0];
-          tinyobj::real_t ty =
-              attrib.texcoords[2 * size_t(idx.texcoord_index) + 1];
-          uv = glm::vec2(tx, ty);
-        } else {
-          uv = glm::vec2(-1);
-        }
-
-        // Optional: vertex colors
-        // tinyobj::real_t red   = attrib.colors[3*size_t(idx.vertex_index)+0];
-        // tinyobj::real_t green = attrib.colors[3*size_t(idx.vertex_index)+1];
-        // tinyobj::real_t blue  = attrib.colors[3*size_t(idx.vertex_index)+2];
-
-        Vertex vertex(position, normal, uv);
-        _objectMaterials[idx_material]->vertices.push_back(vertex);
-      }
-      index_offset += fv;
-    }
+  // Submit all materials of the shared model
+  const auto objectIndex = renderQueue.addObject(modelMatrix);
+  for (const auto& objectMaterial : _model->getMaterials()) {
+    renderQueue.submit(renderPass, shaderProgram, *objectMaterial, objectIndex,
+                       lodLevel, depth);
   }
 }
 
-void SceneObject::draw(RenderPass renderPass) {
-  if (renderPass == RenderPass::Depth) {
-    auto& depthProgram = ShaderProgramManager::getInstance().getShaderProgram(
-        ShaderProgramKeys::depth());
-
-    // Set the model and normal matrix for this object
-    depthProgram[ShaderConstants::modelMatrix()] = _getModelMatrix();
+void SceneObject::selectLod(const glm::vec3& cameraPosition,
+                            float pixelsPerUnit,
+                            float fogDensity) {
+  _getModelMatrix();
+  const auto lodCount = _model->getLodCount();
+  if (lodCount <= 1) {
+    _lodLevel = 0;
+    return;
   }
 
-  else if (renderPass == RenderPass::Main) {
-    auto& mainProgram = ShaderProgramManager::getInstance().getShaderProgram(
-        ShaderProgramKeys::main());
-
-    // Set the model and normal matrix for this object
-    mainProgram.setModelAndNormalMatrix(_getModelMatrix());
+  // Distance from the camera to the bounding sphere (errors are in model
+  // units, scaled like the object)
+  const float maxScale =
+      std::max(std::fabs(_scale.x), std::max(std::fabs(_scale.y),
+                                             std::fabs(_scale.z)));
+  const float distance = glm::distance(cameraPosition, _worldSphereCenter);
+  const float sphereDistance =
+      std::max(distance - _worldSphereRadius, 0.001f);
+
+  // Fog attenuates the error like it does the object (same formula as the
+  // main fragment shader)
+  const float fogDistance = fogDensity * sphereDistance;
+  const float visibility = std::exp(-fogDistance * fogDistance);
+  const float errorToPixels =
+      maxScale / sphereDistance * pixelsPerUnit * visibility;
+
+  // Refine while the error is visible, coarsen while the next level's error
+  // stays well under a pixel
+  auto lodLevel = std::min(_lodLevel, lodCount - 1);
+  while (lodLevel > 0 &&
+         _model->getLodError(lodLevel) * errorToPixels > MAX_PIXEL_ERROR) {
+    lodLevel--;
   }
-
-  // Draw all materials
-  for (auto& objectMaterial : _objectMaterials) {
-    objectMaterial->draw(renderPass);
+  while (lodLevel + 1 < lodCount &&
+         _model->getLodError(lodLevel + 1) * errorToPixels <
+             MAX_PIXEL_ERROR * LOD_HYSTERESIS) {
+    lodLevel++;
   }
-
-  // Set hasChanged flag
-  _hasChanged = false;
+  _lodLevel = lodLevel;
 }
 
-void SceneObject::_bufferData() {
-  for (auto& objectMaterial : _objectMaterials) {
-    objectMaterial->bufferData();
-  }
+size_t SceneObject::getLodLevel() const {
+  return _lodLevel;
 }
 
 void SceneObject::setScale(const glm::vec3& factors) {
@@ -205,6 +124,38 @@ void SceneObject::setPosition(const glm::vec3& distances) {
   _hasChanged = true;
 }
 
+void SceneObject::setOccluder(bool isOccluder) {
+  _isOccluder = isOccluder;
+}
+
+bool SceneObject::isOccluder() const {
+  return _isOccluder;
+}
+
+const glm::mat4& SceneObject::getModelMatrix() {
+  _getModelMatrix();
+  return _modelMatrix;
+}
+
+const glm::vec3& SceneObject::getWorldAabbMin() {
+  _getModelMatrix();
+  return _worldAabbMin;
+}
+
+const glm::vec3& SceneObject::getWorldAabbMax() {
+  _getModelMatrix();
+  return _worldAabbMax;
+}
+
+size_t SceneObject::getBoundsRevision() {
+  _getModelMatrix();
+  return _boundsRevision;
+}
+
+const std::shared_ptr<Model>& SceneObject::getModel() const {
+  return _model;
+}
+
 const glm::vec3 SceneObject::getPosition() const {
   return _position;
 }
@@ -218,8 +169,8 @@ const glm::vec3 SceneObject::getScale() const {
 }
 
 glm::mat4 SceneObject::_getModelMatrix() {
-  // If the object hasn't changed, return cached model matrix
-  if (!_hasChanged) {
+  // If neither the object nor its model changed, return cached model matrix
+  if (!_hasChanged && _modelRevision == _model->getRevision()) {
     return _modelMatrix;
   }
 
@@ -245,5 +196,35 @@ glm::mat4 SceneObject::_getModelMatrix() {
   // Cache the new model matrix
   _modelMatrix = translate * rotate_xyz * scale;
 
+  _updateWorldBounds();
+  _modelRevision = _model->getRevision();
+  _hasChanged = false;
+
   return _modelMatrix;
 }
+
+void SceneObject::_updateWorldBounds() {
+  // Box around the transformed model box: its center is transformed, and its
+  // extents are projected on each axis by the absolute linear part
+  const auto& aabbMin = _model->getAabbMin();
+  const auto& aabbMax = _model->getAabbMax();
+  const glm::vec3 center =
+      _modelMatrix * glm::vec4((aabbMin + aabbMax) * 0.5f, 1.0f);
+  const glm::vec3 extents = (aabbMax - aabbMin) * 0.5f;
+  glm::mat3 absoluteMatrix(_modelMatrix);
+  for (int i = 0; i < 3; i++) {
+    absoluteMatrix[i] = glm::abs(absoluteMatrix[i]);
+  }
+  const glm::vec3 worldExtents = absoluteMatrix * extents;
+  _worldAabbMin = center - worldExtents;
+  _worldAabbMax = center + worldExtents;
+
+  // Sphere scaled by the largest factor
+  const float maxScale =
+      std::max(std::fabs(_scale.x), std::max(std::fabs(_scale.y),
+                                             std::fabs(_scale.z)));
+  _worldSphereCenter =
+      _modelMatrix * glm::vec4(_model->getBoundingSphereCenter(), 1.0f);
+  _worldSphereRadius = _model->getBoundingSphereRadius() * maxScale;
+  _boundsRevision++;
+}
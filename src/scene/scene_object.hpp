@@ -1,6 +1,8 @@
 #ifndef SCENE_OBJECT_HPP
 #define SCENE_OBJECT_HPP
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <glad/glad.h>
@@ -10,7 +12,8 @@
 #include "../gl_wrappers/texture.hpp"
 #include "../gl_wrappers/vertex_buffer_object.hpp"
 #include "../render_pass.hpp"
-#include "scene_object_material.hpp"
+#include "../render_queue.hpp"
+#include "model.hpp"
 #include "vertex.hpp"
 
 /**
@@ -20,13 +23,23 @@ class SceneObject {
  public:
   /**
    * Construct a new SceneObject.
-   * @param modelName Name of the model to load
+   * @param modelName Name of the model to place (shared with other objects
+   * through the ModelManager)
    */
   SceneObject(const std::string& modelName,
               const glm::vec3& position = glm::vec3(0),
               const glm::vec3& rotation = glm::vec3(0),
               const glm::vec3& scale = glm::vec3(1));
 
+  /**
+   * Construct a new SceneObject placing an already loaded model.
+   * @param model The shared model to place
+   */
+  SceneObject(std::shared_ptr<Model> model,
+              const glm::vec3& position = glm::vec3(0),
+              const glm::vec3& rotation = glm::vec3(0),
+              const glm::vec3& scale = glm::vec3(1));
+
   /**
    * Disabled copy constructor.
    */
@@ -43,20 +56,37 @@ class SceneObject {
   ~SceneObject();
 
   /**
-   * Draw the object.
+   * Submits the draws of the object's materials, at its selected level of
+   * detail (the full one for depth passes, so that shadow maps don't depend on
+   * the camera), to a render queue.
+   * @param renderQueue     Queue to submit the draws to
+   * @param renderPass      Render pass the draws belong to
+   * @param shaderProgram   Program to draw with
+   * @param viewerPosition  Position of the viewer (in world coordinates), to
+   * sort the draws by depth
    */
-  void draw(RenderPass renderPass);
+  void submit(RenderQueue& renderQueue,
+              RenderPass renderPass,
+              ShaderProgram& shaderProgram,
+              const glm::vec3& viewerPosition);
 
   /**
-   * Load the given model
-   * @param modelName Name of the model to load
+   * Selects the level of detail to draw, the coarsest one whose error stays
+   * under a pixel on screen (with hysteresis, so that objects at the limit
+   * don't switch every frame). Fog hides the error of far objects.
+   * @param cameraPosition  Position of the camera (in world coordinates)
+   * @param pixelsPerUnit   Screen pixels covered by one world unit at distance
+   * one from the camera
+   * @param fogDensity      Density of the fog (0 if disabled)
    */
-  void _loadModel(const std::string& modelName);
+  void selectLod(const glm::vec3& cameraPosition,
+                 float pixelsPerUnit,
+                 float fogDensity);
 
   /**
-   * Buffer all the data loaded in this object
+   * Gets the selected level of detail (0 being the full detail).
    */
-  void _bufferData();
+  size_t getLodLevel() const;
 
   /**
    * Set the object's scale (in model coordinates)
@@ -88,28 +118,82 @@ class SceneObject {
    */
   void setPosition(const glm::vec3& distances);
 
+  /**
+   * Sets whether the object hides what's behind it well enough to be drawn in
+   * the occlusion culling depth buffer (e.g. buildings).
+   */
+  void setOccluder(bool isOccluder);
+
+  /**
+   * Gets whether the object is an occluder.
+   */
+  bool isOccluder() const;
+
+  /**
+   * Gets the model matrix of the object (updated if the object changed).
+   */
+  const glm::mat4& getModelMatrix();
+
+  /**
+   * Gets the minimal corner of the object's bounding box, in world
+   * coordinates (updated if the object or its model changed).
+   */
+  const glm::vec3& getWorldAabbMin();
+
+  /**
+   * Gets the maximal corner of the object's bounding box, in world
+   * coordinates (updated if the object or its model changed).
+   */
+  const glm::vec3& getWorldAabbMax();
+
+  /**
+   * Gets the number of times the world bounds have been computed, for spatial
+   * structures to know when to update them.
+   */
+  size_t getBoundsRevision();
+
+  const std::shared_ptr<Model>& getModel() const;
   const glm::vec3 getPosition() const;
   const glm::vec3 getRotation() const;
   const glm::vec3 getScale() const;
 
+  // Maximal error of the drawn level of detail, in pixels
+  static constexpr float MAX_PIXEL_ERROR = 1.0f;
+  // Part of the maximal error a coarser level must stay under to be selected
+  static constexpr float LOD_HYSTERESIS = 0.75f;
+
  private:
-  std::vector<std::unique_ptr<SceneObjectMaterial>> _objectMaterials;
+  std::shared_ptr<Model> _model;  // Model shared with other objects
 
   glm::vec3 _position;
   glm::vec3 _rotation;
   glm::vec3 _scale;
 
-  // Flag for if the object has been changed since last draw.
-  // True at the beginning so that the object gets initialized.
+  // Flag for if the object has been changed since its model matrix and bounds
+  // were computed. True at the beginning so that the object gets initialized.
   bool _hasChanged = true;
 
-  glm::mat4 _modelMatrix;  // Cached model matrix
+  glm::mat4 _modelMatrix;      // Cached model matrix
+  size_t _modelRevision = 0;   // Revision of the model the bounds are for
+  size_t _boundsRevision = 0;  // Number of computations of the bounds
+  glm::vec3 _worldAabbMin;  // Cached bounding box, in world coordinates
+  glm::vec3 _worldAabbMax;
+  glm::vec3 _worldSphereCenter;     // Cached bounding sphere, in world
+  float _worldSphereRadius = 0.0f;  // coordinates
+  size_t _lodLevel = 0;             // Selected level of detail
+  bool _isOccluder = false;         // Drawn in the occlusion depth buffer
+
   /**
    * Computes the model matrix of this object
-   * based on its position, rotation, and scale.
+   * based on its position, rotation, and scale, and its world bounds.
    * @return The model matrix of this object
    */
   glm::mat4 _getModelMatrix();
+
+  /**
+   * Transforms the bounds of the model by the model matrix.
+   */
+  void _updateWorldBounds();
 };
 
 #endif
\ No newline at end of file
@@ -1,74 +1,72 @@
+#include <algorithm>
+
 #include "scene_object_material.hpp"
-#include "../gl_wrappers/shader_program_manager.hpp"
+#include "packed_geometry.hpp"
+
+// Identifier of the next material
+static uint32_t nextID = 0;
 
 SceneObjectMaterial::SceneObjectMaterial(shader_structs::Material material)
-    : material{material} {}
+    : id(nextID++), material{material} {}
 
 SceneObjectMaterial::~SceneObjectMaterial() {
-  vbo.deleteVBO();
-  glDeleteVertexArrays(1, &vao);
+  GeometryArena::getInstance().free(geometry);
 }
 
 void SceneObjectMaterial::bufferData() {
-  // VAO
-  glGenVertexArrays(1, &vao);
-  glBindVertexArray(vao);
-
-  // VBO
-  vbo.createVBO();
-  vbo.bindVBO();
-  vbo.addRawData(vertices.data(), vertices.size() * sizeof(Vertex));
-  vbo.uploadDataToGPU(GL_STATIC_DRAW);
-
-  // Shader input attrib
-  const GLuint VERTEX_ATTR_POSITION = 0;
-  const GLuint VERTEX_ATTR_NORMAL = 1;
-  const GLuint VERTEX_ATTR_UV = 2;
-  glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-  glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-  glEnableVertexAttribArray(VERTEX_ATTR_UV);
-  glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE,
-                        sizeof(Vertex),
-                        (const GLvoid*)offsetof(Vertex, position));
-  glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE,
-                        sizeof(Vertex),
-                        (const GLvoid*)offsetof(Vertex, normal));
-  glVertexAttribPointer(VERTEX_ATTR_UV, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (const GLvoid*)offsetof(Vertex, uv));
-
-  vbo.unbindVBO();
-  glBindVertexArray(0);
+  bufferData(vertices.data(), vertices.size(), indices.data(), indices.size());
 }
 
-void SceneObjectMaterial::draw(RenderPass renderPass) {
-  if (renderPass == RenderPass::Depth) {
-  }
+void SceneObjectMaterial::bufferData(const Vertex* vertexData,
+                                     size_t vertexCount,
+                                     const GLuint* indexData,
+                                     size_t indexCount) {
+  bufferData(vertexData, vertexCount,
+             PackedGeometry::getLayout(PackedGeometry::Format::Float),
+             indexData, indexCount);
+}
 
-  if (renderPass == RenderPass::Main) {
-    // Send Material to shader
-    auto& mainProgram = ShaderProgramManager::getInstance().getShaderProgram(
-        ShaderProgramKeys::main());
-    material.setUniform(mainProgram, ShaderConstants::material());
+void SceneObjectMaterial::bufferData(const void* vertexData,
+                                     size_t vertexCount,
+                                     const VertexLayout& layout,
+                                     const GLuint* indexData,
+                                     size_t indexCount) {
+  // Replaces the geometry uploaded before, if any
+  auto& arena = GeometryArena::getInstance();
+  arena.free(geometry);
+  geometry = arena.allocate(vertexData, vertexCount, layout, indexData,
+                            indexCount);
+  this->indexCount = static_cast<GLsizei>(indexCount);
+  indexType = geometry.pool->getIndexType();
+}
 
-    bool hasTexture = texture != nullptr;
-    mainProgram[ShaderConstants::missingTexture()] = !hasTexture;
+void SceneObjectMaterial::drawElements(size_t lodLevel,
+                                       GLsizei instanceCount) const {
+  const auto lod = _getLod(lodLevel);
+  const auto indexOffset = geometry.firstIndex + lod.indexOffset;
+  glDrawElementsInstancedBaseVertex(
+      GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), indexType,
+      reinterpret_cast<const void*>(indexOffset *
+                                    geometry.pool->getIndexSize()),
+      instanceCount, static_cast<GLint>(geometry.baseVertex));
+}
 
-    if (hasTexture) {
-      // Bind our texture
-      texture->bind();
-      // Set our albedo sampler to use Texture Unit 0
-      mainProgram[ShaderConstants::albedoSampler()] = 0;
+DrawElementsIndirectCommand SceneObjectMaterial::getDrawCommand(
+    size_t lodLevel,
+    GLuint instanceCount,
+    GLuint baseInstance) const {
+  const auto lod = _getLod(lodLevel);
+  return {static_cast<GLuint>(lod.indexCount), instanceCount,
+          static_cast<GLuint>(geometry.firstIndex + lod.indexOffset),
+          static_cast<GLint>(geometry.baseVertex), baseInstance};
+}
 
-      // Bind our texture to texture unit
-      GLint albedoTexUnit = 0;
-      texture->bind(albedoTexUnit);
-      // Set our albedo sampler to use Texture Unit
-      mainProgram[ShaderConstants::albedoSampler()] = albedoTexUnit;
-    }
+MeshLod SceneObjectMaterial::_getLod(size_t lodLevel) const {
+  // A single level spans all the indices when there are no levels of detail
+  if (lods.empty()) {
+    MeshLod lod;
+    lod.indexCount = static_cast<size_t>(indexCount);
+    return lod;
   }
-
-  // Draw
-  glBindVertexArray(vao);
-  glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
-  glBindVertexArray(0);
-}
\ No newline at end of file
+  return lods[std::min(lodLevel, lods.size() - 1)];
+}
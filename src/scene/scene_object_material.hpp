@@ -5,20 +5,30 @@
 #include <vector>
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 #include "../gl_wrappers/texture.hpp"
-#include "../gl_wrappers/vertex_buffer_object.hpp"
-#include "../render_pass.hpp"
 #include "../shader_structs/material.hpp"
+#include "geometry_arena.hpp"
+#include "mesh_lod.hpp"
 #include "vertex.hpp"
+#include "vertex_layout.hpp"
 
 class SceneObjectMaterial {
  public:
-  VertexBufferObject vbo;
-  GLuint vao;
+  uint32_t id;            // Identifier, unique until it wraps (sorts draws)
+  GeometryRange geometry;  // Range of the uploaded geometry in the arena
   std::vector<Vertex> vertices;
+  std::vector<GLuint> indices;
+  GLsizei indexCount = 0;             // Number of indices uploaded
+  GLenum indexType = GL_UNSIGNED_INT;  // Type of indices uploaded
   std::shared_ptr<Texture> texture;
   shader_structs::Material material;
+  std::vector<MeshLod> lods;  // Levels of detail in the IBO (a single one
+                              // spanning all the indices if empty)
+  glm::mat4 positionTransform =
+      glm::mat4(1);  // Maps uploaded positions to model space (e.g. to
+                     // dequantize them)
 
   SceneObjectMaterial(shader_structs::Material material);
   ~SceneObjectMaterial();
@@ -27,7 +37,66 @@ class SceneObjectMaterial {
   SceneObjectMaterial(const SceneObjectMaterial&) = delete;
   SceneObjectMaterial& operator=(const SceneObjectMaterial&) = delete;
 
+  /**
+   * Uploads the vertices and indices held in this material to the GPU (in the
+   * geometry arena).
+   */
   void bufferData();
-  void draw(RenderPass renderPass);
+
+  /**
+   * Uploads the given indexed geometry to the GPU (e.g. straight from a mesh
+   * cache).
+   * @param vertexData   Pointer to the first vertex
+   * @param vertexCount  Number of vertices
+   * @param indexData    Pointer to the first index
+   * @param indexCount   Number of indices
+   */
+  void bufferData(const Vertex* vertexData,
+                  size_t vertexCount,
+                  const GLuint* indexData,
+                  size_t indexCount);
+
+  /**
+   * Uploads the given indexed geometry to the GPU, with vertices in any layout
+   * (e.g. packed).
+   * @param vertexData   Pointer to the first vertex
+   * @param vertexCount  Number of vertices
+   * @param layout       Layout of the vertices (must outlive the geometry
+   * arena, e.g. PackedGeometry::getLayout())
+   * @param indexData    Pointer to the first index
+   * @param indexCount   Number of indices
+   */
+  void bufferData(const void* vertexData,
+                  size_t vertexCount,
+                  const VertexLayout& layout,
+                  const GLuint* indexData,
+                  size_t indexCount);
+
+  /**
+   * Draws instances of the indices of a level of detail. The VAO of the
+   * geometry's pool, program, uniforms and per instance attributes must
+   * already be set up (see RenderQueue).
+   * @param lodLevel       Level of detail to draw (clamped to the coarsest one)
+   * @param instanceCount  Number of instances to draw
+   */
+  void drawElements(size_t lodLevel = 0, GLsizei instanceCount = 1) const;
+
+  /**
+   * Gets the indirect draw command drawing instances of a level of detail.
+   * @param lodLevel       Level of detail to draw (clamped to the coarsest one)
+   * @param instanceCount  Number of instances to draw
+   * @param baseInstance   First element of the per instance attributes
+   */
+  DrawElementsIndirectCommand getDrawCommand(size_t lodLevel,
+                                             GLuint instanceCount,
+                                             GLuint baseInstance) const;
+
+ private:
+  /**
+   * Gets the range of indices of a level of detail, relative to the geometry.
+   * @param lodLevel  Level of detail (clamped to the coarsest one)
+   * @return The index offset and count
+   */
+  MeshLod _getLod(size_t lodLevel) const;
 };
 #endif
\ No newline at end of file
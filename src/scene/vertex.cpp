@@ -1,4 +1,16 @@
+#include <cstring>
+
+#include "../utils/hash_utils.hpp"
+
 #include "vertex.hpp"
 
 Vertex::Vertex(glm::vec3 position, glm::vec3 normal, glm::vec2 uv)
     : position(position), normal(normal), uv(uv) {}
+
+bool Vertex::operator==(const Vertex& other) const {
+  return memcmp(this, &other, sizeof(Vertex)) == 0;
+}
+
+size_t Vertex::Hash::operator()(const Vertex& vertex) const {
+  return static_cast<size_t>(hash_utils::fnv1a64(&vertex, sizeof(Vertex)));
+}
@@ -1,6 +1,8 @@
 #ifndef VERTEX_HPP
 #define VERTEX_HPP
 
+#include <cstddef>
+
 #include <glm/glm.hpp>
 
 class Vertex {
@@ -9,6 +11,18 @@ class Vertex {
   glm::vec3 normal;
   glm::vec2 uv;
   Vertex(glm::vec3 position, glm::vec3 normal, glm::vec2 uv);
+
+  /**
+   * Checks if both vertices have exactly the same attributes (bitwise).
+   */
+  bool operator==(const Vertex& other) const;
+
+  /**
+   * Hash functor, so that vertices can be used as keys of unordered maps.
+   */
+  struct Hash {
+    size_t operator()(const Vertex& vertex) const;
+  };
 };
 
-#endif
\ No newline at end of file
+#endif
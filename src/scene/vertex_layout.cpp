@@ -0,0 +1,11 @@
+#include "vertex_layout.hpp"
+
+void VertexLayout::apply(size_t baseOffset, GLuint divisor) const {
+  for (const auto& attribute : attributes) {
+    glEnableVertexAttribArray(attribute.location);
+    glVertexAttribPointer(attribute.location, attribute.componentCount,
+                          attribute.type, attribute.isNormalized, stride,
+                          (const GLvoid*)(baseOffset + attribute.offset));
+    glVertexAttribDivisor(attribute.location, divisor);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef VERTEX_LAYOUT_HPP
+#define VERTEX_LAYOUT_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+ * Vertex attribute, as given to glVertexAttribPointer.
+ */
+struct VertexAttribute {
+  GLuint location;       // Location of the attribute in the shaders
+  GLint componentCount;  // Number of components
+  GLenum type;           // Type of the components (e.g. GL_FLOAT)
+  GLboolean isNormalized;  // Whether integer components are normalized
+  size_t offset;           // Offset of the attribute in the vertex
+};
+
+/**
+ * Describes how vertices are laid out in a VBO, so that packed vertex formats
+ * can be bound the same way as the float one.
+ */
+class VertexLayout {
+ public:
+  GLsizei stride = 0;                      // Size of a vertex in bytes
+  std::vector<VertexAttribute> attributes;  // Attributes of a vertex
+
+  /**
+   * Enables and sets up the attributes of this layout, for the VBO bound to
+   * GL_ARRAY_BUFFER (and the currently bound VAO).
+   * @param baseOffset  Offset of the first vertex in the VBO (in bytes)
+   * @param divisor     Number of instances each element is used for (0 for
+   * per vertex attributes, 1 for per instance ones)
+   */
+  void apply(size_t baseOffset = 0, GLuint divisor = 0) const;
+
+  // Locations of the vertex attributes in the shaders
+  static constexpr GLuint ATTRIBUTE_POSITION = 0;
+  static constexpr GLuint ATTRIBUTE_NORMAL = 1;
+  static constexpr GLuint ATTRIBUTE_UV = 2;
+
+  // Locations of the per instance attributes (matrices take one location per
+  // column)
+  static constexpr GLuint ATTRIBUTE_INSTANCE_MODEL_MATRIX = 3;
+  static constexpr GLuint ATTRIBUTE_INSTANCE_NORMAL_MATRIX = 7;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#include "vertex_welder.hpp"
+
+void VertexWelder::addVertex(const Vertex& vertex) {
+  const auto nextIndex = static_cast<GLuint>(vertices.size());
+  const auto result = _vertexIndices.emplace(vertex, nextIndex);
+
+  // New unique vertex
+  if (result.second) {
+    vertices.push_back(vertex);
+  }
+
+  indices.push_back(result.first->second);
+}
+
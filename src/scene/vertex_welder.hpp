@@ -0,0 +1,31 @@
+#ifndef VERTEX_WELDER_HPP
+#define VERTEX_WELDER_HPP
+
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "vertex.hpp"
+
+/**
+ * Builds indexed geometry out of a stream of triangle vertices, by merging
+ * vertices that have the same position, normal and uv.
+ */
+class VertexWelder {
+ public:
+  std::vector<Vertex> vertices;  // Unique vertices
+  std::vector<GLuint> indices;   // Indices into the unique vertices
+
+  /**
+   * Adds a vertex to the geometry, reusing an identical one if it exists.
+   * @param vertex The vertex to add
+   */
+  void addVertex(const Vertex& vertex);
+
+ private:
+  // Index of each unique vertex
+  std::unordered_map<Vertex, GLuint, Vertex::Hash> _vertexIndices;
+};
+
+#endif
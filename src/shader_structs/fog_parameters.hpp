@@ -2,6 +2,7 @@
 #define FOG_PARAMETERS_HPP
 
 #include "shader_struct.hpp"
+#include "shader_uniforms.hpp"
 
 namespace shader_structs {
 
@@ -27,6 +28,24 @@ struct FogParameters : ShaderStruct {
   void setUniform(ShaderProgram& shaderProgram,
                   const std::string& uniformName) const override;
 
+  /**
+   * Sets fog parameters in a shader program, through typed handles.
+   *
+   * @param shaderProgram  Shader program to set fog parameters in (in use)
+   * @param handles        Handles of the fog parameters uniform's fields
+   */
+  template <typename Table>
+  void setUniform(
+      const ShaderProgram& shaderProgram,
+      const shader_uniforms::FogParametersHandles<Table>& handles) const {
+    shaderProgram.set(handles.isEnabled, isEnabled);
+    if (!isEnabled) {
+      return;  // Skip settings other parameters if fog is not enabled
+    }
+    shaderProgram.set(handles.color, color);
+    shaderProgram.set(handles.density, density);
+  }
+
   glm::vec3 color;  // Color of the fog
   float density;    // Density of the fog
   bool isEnabled;   // Whether the fog is enabled
@@ -2,6 +2,7 @@
 #define MATERIAL_HPP
 
 #include "shader_struct.hpp"
+#include "shader_uniforms.hpp"
 
 namespace shader_structs {
 
@@ -28,6 +29,22 @@ struct Material : ShaderStruct {
   void setUniform(ShaderProgram& shaderProgram,
                   const std::string& uniformName) const override;
 
+  /**
+   * Sets material structure in a shader program, through typed handles.
+   *
+   * @param shaderProgram  Shader program to set material in (in use)
+   * @param handles        Handles of the material uniform's fields
+   */
+  template <typename Table>
+  void setUniform(
+      const ShaderProgram& shaderProgram,
+      const shader_uniforms::MaterialHandles<Table>& handles) const {
+    shaderProgram.set(handles.ambient, ambient);
+    shaderProgram.set(handles.diffuse, diffuse);
+    shaderProgram.set(handles.specular, specular);
+    shaderProgram.set(handles.shininess, shininess);
+  }
+
   /**
    * Gets data size of the structure (in bytes) according to std140 layout
    * rules.
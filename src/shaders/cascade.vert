@@ -0,0 +1,18 @@
+#version 330 core
+
+// Inputs
+layout(location = 0) in vec3 aModelPos;
+
+// Per instance inputs (one location per column)
+layout(location = 3) in mat4 aModelMatrix;
+
+// Matrices uniforms (of the cascade being drawn)
+uniform struct {
+	mat4 projection;
+	mat4 view;
+} matrices;
+
+void main() {
+	// Shadow map space position
+	gl_Position = matrices.projection * matrices.view * aModelMatrix * vec4(aModelPos, 1.0);
+}
@@ -1,20 +1,17 @@
 #version 330 core
 
-in vec3 gWorldPos;
+in vec3 vWorldPos;
 
 uniform vec3 lightWorldPos;
 uniform float farPlane;
 
 void main() {
     // Distance between fragment and light source
-    float lightDistance = length(gWorldPos - lightWorldPos);
+    float lightDistance = length(vWorldPos - lightWorldPos);
 
     // Map to [0;1] range by dividing by farPlane
     lightDistance = lightDistance / farPlane;
 
     // Write this as modified depth
     gl_FragDepth = lightDistance;
-    if(gWorldPos == vec3(0)) {
-        gl_FragDepth = 5;
-    }
-}
\ No newline at end of file
+}
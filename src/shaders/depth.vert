@@ -3,13 +3,21 @@
 // Inputs
 layout(location = 0) in vec3 aModelPos;
 
-// Matrices uniforms
+// Per instance inputs (one location per column)
+layout(location = 3) in mat4 aModelMatrix;
+
+// Outputs
+out vec3 vWorldPos;
+
+// Matrices uniforms (of the cube face being drawn)
 uniform struct {
     mat4 projection;
-    mat4 model;
+    mat4 view;
 } matrices;
 
 void main() {
-	// Transform vertex into world space
-    gl_Position = matrices.model * vec4(aModelPos, 1.0);
+    // Transform vertex into world space, then onto the cube face
+    vec4 worldPos = aModelMatrix * vec4(aModelPos, 1.0);
+    vWorldPos = worldPos.xyz;
+    gl_Position = matrices.projection * matrices.view * worldPos;
 }
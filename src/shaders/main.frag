@@ -110,22 +110,94 @@ vec3 getPointLightColor(PointLight pointLight, Material material, vec3 normal, v
 	return clamp(finalColor, 0.0, 1.0);
 }
 
-// float calculateShadow(vec3 fragPos, vec3 lightPos) {
+// Atlas of the point lights' shadow maps (holding the distance to the light
+// over farPlane), its second layer being the one to sample
+uniform sampler2DArrayShadow pointShadowSampler;
+uniform float farPlane;
+const float POINT_SHADOW_LAYER = 1.0;
+
+// Tiles of the 6 cube faces of each point light in the atlas (offset, then
+// size, in texture coordinates; size 0 if the light has no shadow)
+layout(std140) uniform PointShadowsBlock {
+	vec4 tiles[MAX_POINT_LIGHTS * 6];
+} pointShadows;
+
+// Axes of the cube faces' views, as rendered by the depth pass (in the order
+// +x, -x, +y, -y, +z, -z, the forward axis being the face's)
+const vec3 CUBE_FACE_RIGHTS[6] = vec3[6](
+	vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0), vec3(1.0, 0.0, 0.0),
+	vec3(1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0));
+const vec3 CUBE_FACE_UPS[6] = vec3[6](
+	vec3(0.0, -1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0),
+	vec3(0.0, 0.0, -1.0), vec3(0.0, -1.0, 0.0), vec3(0.0, -1.0, 0.0));
+
+// Depth bias of the shadow test, in texels of the shadow map
+const float SHADOW_BIAS_TEXELS = 1.5;
+
+float getPointLightShadow(int lightIndex, vec3 fragPos, vec3 lightPos) {
+	// Face of the cube the fragment is seen through from the light
+	vec3 lightToFrag = fragPos - lightPos;
+	vec3 absLightToFrag = abs(lightToFrag);
+	int face;
+	float forward;
+	if(absLightToFrag.x >= absLightToFrag.y && absLightToFrag.x >= absLightToFrag.z) {
+		face = lightToFrag.x > 0.0 ? 0 : 1;
+		forward = absLightToFrag.x;
+	} else if(absLightToFrag.y >= absLightToFrag.z) {
+		face = lightToFrag.y > 0.0 ? 2 : 3;
+		forward = absLightToFrag.y;
+	} else {
+		face = lightToFrag.z > 0.0 ? 4 : 5;
+		forward = absLightToFrag.z;
+	}
 
-//     // Vector between fragment position and light position and its length
-// 	vec3 lightToFrag = lightPos - fragPos;
-// 	float currentDepth = length(lightToFrag);
+	vec4 tile = pointShadows.tiles[lightIndex * 6 + face];
+	if(tile.z == 0.0) {
+		return 1.0;
+	}
 
-//     // Sample from the depth map and transform its value (in [0;1]) back to a distance
-// 	float closestDepth = texture(depthSampler, -lightToFrag).r;
-// 	closestDepth *= farPlane;
+	// Position on the face (its projection having a 90 degrees field of view),
+	// kept half a texel inside its tile so that filtering stays in it
+	float tileTexels = tile.z * float(textureSize(pointShadowSampler, 0).x);
+	vec2 uv = vec2(dot(CUBE_FACE_RIGHTS[face], lightToFrag),
+		dot(CUBE_FACE_UPS[face], lightToFrag)) / forward * 0.5 + 0.5;
+	uv = clamp(uv, 0.5 / tileTexels, 1.0 - 0.5 / tileTexels);
+
+	// Compare with the depth of the closest caster, biased by the size of a
+	// texel at the fragment's distance (returns 1 if lit, 0 if in shadow)
+	float lightToFragDistance = length(lightToFrag);
+	float texelSize = 2.0 * forward / tileTexels;
+	float depth = (lightToFragDistance - SHADOW_BIAS_TEXELS * texelSize) / farPlane;
+	return texture(pointShadowSampler, vec4(tile.xy + uv * tile.z, POINT_SHADOW_LAYER, depth));
+}
 
-//     // Test for shadows
-// 	float bias = 0.05;
-// 	float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
+// Cascaded shadow maps of the directional lights (the cascades of each light
+// in consecutive layers)
+const int MAX_CASCADES = 8;
+uniform sampler2DArrayShadow directionalShadowSampler;
+
+layout(std140) uniform CascadedShadowsBlock {
+	int cascadeCount;
+	float splitDistances[MAX_CASCADES]; // View depth each cascade ends at
+	mat4 matrices[MAX_DIRECTIONAL_LIGHTS * MAX_CASCADES]; // World to shadow map
+} cascadedShadows;
+
+float getDirectionalLightShadow(int lightIndex, vec3 fragPos, float viewDepth) {
+	// Nearest cascade covering the fragment (no shadow beyond the last one)
+	int cascade = 0;
+	while(cascade < cascadedShadows.cascadeCount && viewDepth > cascadedShadows.splitDistances[cascade]) {
+		cascade++;
+	}
+	if(cascade == cascadedShadows.cascadeCount) {
+		return 1.0;
+	}
 
-// 	return shadow;
-// }
+	// Compare with the depth of the closest caster (returns 1 if lit, 0 if in
+	// shadow, the depth bias being applied when drawing the casters)
+	vec4 shadowPos = cascadedShadows.matrices[lightIndex * MAX_CASCADES + cascade] * vec4(fragPos, 1.0);
+	float layer = float(lightIndex * cascadedShadows.cascadeCount + cascade);
+	return texture(directionalShadowSampler, vec4(shadowPos.xy, layer, shadowPos.z));
+}
 
 float getFogFactor(FogParameters fogParams, vec3 fragPos, vec3 cameraPos) {
 	// Distance between fragment and camera
@@ -139,10 +211,10 @@ float getFogFactor(FogParameters fogParams, vec3 fragPos, vec3 cameraPos) {
 }
 
 // Inputs
-in vec3 gNormal;
-in vec2 gUV;
-in vec3 gWorldPos;
-in vec3 gCameraSpacePos;
+in vec3 vNormal;
+in vec2 vUV;
+in vec3 vWorldPos;
+in vec3 vCameraSpacePos;
 
 // Outputs
 out vec3 fColor;
@@ -151,10 +223,6 @@ out vec3 fColor;
 uniform bool missingTexture;
 uniform sampler2D albedoSampler;
 
-// Depth maps for shadows
-uniform samplerCube depthSampler;
-uniform float farPlane;
-
 // Other uniforms
 uniform vec3 cameraWorldPos;
 uniform Material material;
@@ -178,7 +246,7 @@ layout(std140) uniform PointLightsBlock {
 
 void main() {
 	// Normal
-	vec3 normal = normalize(gNormal);
+	vec3 normal = normalize(vNormal);
 
 	// Ambient lights
 	for(int i = 0; i < ambientLights.count; i++) {
@@ -189,19 +257,20 @@ void main() {
 	// Directional lights
 	for(int i = 0; i < directionalLights.count; i++) {
 		DirectionalLight directionalLight = directionalLights.data[i];
-		fColor += getDirectionalLightColor(directionalLight, material, normal, cameraWorldPos, gWorldPos);
+		float shadow = getDirectionalLightShadow(i, vWorldPos, -vCameraSpacePos.z);
+		fColor += shadow * getDirectionalLightColor(directionalLight, material, normal, cameraWorldPos, vWorldPos);
 	}
 
 	// Point lights
 	for(int i = 0; i < pointLights.count; i++) {
 		PointLight pointLight = pointLights.data[i];
-		// float shadow = calculateShadow(gWorldPos, pointLight.position);
-		fColor += getPointLightColor(pointLight, material, normal, cameraWorldPos, gWorldPos);
+		float shadow = getPointLightShadow(i, vWorldPos, pointLight.position);
+		fColor += shadow * getPointLightColor(pointLight, material, normal, cameraWorldPos, vWorldPos);
 	}
 
 	// Texture color
 	if(!missingTexture) {
-		vec4 albedoColor = texture(albedoSampler, gUV);
+		vec4 albedoColor = texture(albedoSampler, vUV);
 		if(albedoColor.a < 0.5) {
 			discard;
 		}
@@ -209,7 +278,7 @@ void main() {
 	}
 
 	if(fogParams.isEnabled) {
-		float fogFactor = getFogFactor(fogParams, gWorldPos, cameraWorldPos);
+		float fogFactor = getFogFactor(fogParams, vWorldPos, cameraWorldPos);
 		fColor = mix(fColor, fogParams.color, fogFactor);
 	}
 }
\ No newline at end of file
@@ -5,6 +5,10 @@ layout(location = 0) in vec3 aModelPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUV;
 
+// Per instance inputs (matrices take one location per column)
+layout(location = 3) in mat4 aModelMatrix;
+layout(location = 7) in mat3 aNormalMatrix;
+
 // Outputs
 out vec3 vNormal;
 out vec2 vUV;
@@ -15,21 +19,20 @@ out vec3 vCameraSpacePos;
 uniform struct {
 	mat4 projection;
 	mat4 view;
-	mat4 model;
-	mat3 normal;
 } matrices;
 
 void main() {
 	// Compute matrices
-	mat4 mvMatrix = matrices.view * matrices.model;
+	mat4 mvMatrix = matrices.view * aModelMatrix;
 	mat4 mvpMatrix = matrices.projection * mvMatrix;
 
 	// Clip space position
 	gl_Position = mvpMatrix * vec4(aModelPos, 1.0);
 
-	// Output all out variables
-	vNormal = matrices.normal * aNormal;
+	// Output all out variables (normals missing from models are generated at
+	// import)
+	vNormal = aNormalMatrix * aNormal;
 	vUV = aUV;
-	vWorldPos = (matrices.model * vec4(aModelPos, 1.0)).xyz;
+	vWorldPos = (aModelMatrix * vec4(aModelPos, 1.0)).xyz;
 	vCameraSpacePos = (mvMatrix * vec4(aModelPos, 1.0)).xyz;
 }
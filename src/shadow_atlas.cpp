@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "shadow_atlas.hpp"
+
+/**
+ * Checks whether a number is a (positive) power of two.
+ */
+static bool isPowerOfTwo(int value) {
+  return value > 0 && (value & (value - 1)) == 0;
+}
+
+/**
+ * Keeps the even bits of a Z-order index (one coordinate), packed.
+ */
+static uint32_t compactBits(uint32_t index) {
+  index &= 0x55555555;
+  index = (index | (index >> 1)) & 0x33333333;
+  index = (index | (index >> 2)) & 0x0f0f0f0f;
+  index = (index | (index >> 4)) & 0x00ff00ff;
+  index = (index | (index >> 8)) & 0x0000ffff;
+  return index;
+}
+
+bool ShadowAtlas::Tile::operator==(const Tile& tile) const {
+  return offset == tile.offset && size == tile.size;
+}
+
+bool ShadowAtlas::Tile::operator!=(const Tile& tile) const {
+  return !(*this == tile);
+}
+
+ShadowAtlas::ShadowAtlas(int size, int minTileSize, int maxTileSize)
+    : _size(size), _minTileSize(minTileSize), _maxTileSize(maxTileSize) {
+  if (!isPowerOfTwo(size) || !isPowerOfTwo(minTileSize) ||
+      !isPowerOfTwo(maxTileSize) || minTileSize > maxTileSize ||
+      maxTileSize > size) {
+    throw std::runtime_error("Invalid shadow atlas sizes");
+  }
+}
+
+int ShadowAtlas::getTileSize(float coverage, int previousSize) const {
+  const float neededSize =
+      std::clamp(coverage, 0.0f, 1.0f) * static_cast<float>(_maxTileSize);
+
+  // Smallest power of two covering the needed size
+  int size = _minTileSize;
+  while (size < _maxTileSize && static_cast<float>(size) < neededSize) {
+    size *= 2;
+  }
+
+  if (previousSize > size &&
+      neededSize > SHRINK_HYSTERESIS * static_cast<float>(previousSize)) {
+    return previousSize;
+  }
+  return size;
+}
+
+void ShadowAtlas::pack(const std::vector<int>& sizes,
+                       std::vector<Tile>& tiles) {
+  tiles.assign(sizes.size(), Tile());
+  _order.clear();
+  int64_t area = 0;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] > 0) {
+      tiles[i].size = std::clamp(sizes[i], _minTileSize, _maxTileSize);
+      area += static_cast<int64_t>(tiles[i].size) * tiles[i].size;
+      _order.push_back(i);
+    }
+  }
+
+  // Halve the largest tiles until they all fit (tiles all being the smallest
+  // ones left over are dropped)
+  const int64_t atlasArea = static_cast<int64_t>(_size) * _size;
+  while (area > atlasArea) {
+    int largestSize = 0;
+    for (const auto i : _order) {
+      largestSize = std::max(largestSize, tiles[i].size);
+    }
+    if (largestSize <= _minTileSize) {
+      break;
+    }
+    for (const auto i : _order) {
+      if (tiles[i].size == largestSize) {
+        tiles[i].size /= 2;
+        area -= 3 * static_cast<int64_t>(tiles[i].size) * tiles[i].size;
+      }
+    }
+  }
+
+  // Place them largest first (then in order), each one at the next Z-order
+  // position aligned on its size
+  std::stable_sort(_order.begin(), _order.end(), [&tiles](size_t a, size_t b) {
+    return tiles[a].size > tiles[b].size;
+  });
+  const int64_t unitArea = static_cast<int64_t>(_minTileSize) * _minTileSize;
+  int64_t placedArea = 0;
+  for (const auto i : _order) {
+    auto& tile = tiles[i];
+    const int64_t tileArea = static_cast<int64_t>(tile.size) * tile.size;
+    if (placedArea + tileArea > atlasArea) {
+      tile = Tile();
+      continue;
+    }
+    const auto index = static_cast<uint32_t>(placedArea / unitArea);
+    tile.offset = glm::ivec2(compactBits(index), compactBits(index >> 1)) *
+                  _minTileSize;
+    placedArea += tileArea;
+  }
+}
+
+int ShadowAtlas::getSize() const {
+  return _size;
+}
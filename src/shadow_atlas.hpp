@@ -0,0 +1,82 @@
+#ifndef SHADOW_ATLAS_HPP
+#define SHADOW_ATLAS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * Sub-allocates a square texture into square tiles (e.g. the faces of point
+ * lights' shadow cubes), whose sizes are powers of two.
+ *
+ * Tiles are placed largest first along a Z-order curve, which keeps every tile
+ * aligned on its size, so they never overlap and fill the atlas without gaps.
+ * When they don't all fit, the largest ones are halved until they do. Tiles of
+ * the same sizes are always placed the same way, so contents drawn in a tile
+ * stay valid as long as the sizes don't change.
+ */
+class ShadowAtlas {
+ public:
+  /**
+   * Area of the atlas (in texels, the origin being a corner).
+   */
+  struct Tile {
+    glm::ivec2 offset = glm::ivec2(0);
+    int size = 0;  // 0 if no tile
+
+    bool operator==(const Tile& tile) const;
+    bool operator!=(const Tile& tile) const;
+  };
+
+  /**
+   * Creates an atlas.
+   * Throws std::runtime_error if the sizes aren't powers of two, or the
+   * minimal tile size exceeds the others.
+   * @param size         Width and height of the atlas, in texels
+   * @param minTileSize  Size of the smallest tiles
+   * @param maxTileSize  Size of the largest tiles
+   */
+  explicit ShadowAtlas(int size = DEFAULT_SIZE,
+                       int minTileSize = DEFAULT_MIN_TILE_SIZE,
+                       int maxTileSize = DEFAULT_MAX_TILE_SIZE);
+
+  /**
+   * Gets the tile size to request for some coverage, with hysteresis: the
+   * previous size is kept unless the coverage needs a larger one, or clearly
+   * a smaller one.
+   * @param coverage      Part of the largest tile size needed (e.g. the part of
+   * the screen the tile's contents cover)
+   * @param previousSize  Size requested in the previous frame (0 if none)
+   */
+  int getTileSize(float coverage, int previousSize) const;
+
+  /**
+   * Places tiles in the atlas, shrinking the largest ones until they all fit.
+   * @param sizes  Sizes of the tiles (0 for no tile), powers of two between the
+   * minimal and maximal tile sizes
+   * @param tiles  Set to the placed tiles, in the order of the sizes
+   */
+  void pack(const std::vector<int>& sizes, std::vector<Tile>& tiles);
+
+  /**
+   * Gets the width and height of the atlas, in texels.
+   */
+  int getSize() const;
+
+  // Default size of the atlas, and of its smallest and largest tiles
+  static constexpr int DEFAULT_SIZE = 4096;
+  static constexpr int DEFAULT_MIN_TILE_SIZE = 64;
+  static constexpr int DEFAULT_MAX_TILE_SIZE = 1024;
+  // Part of a tile size under which the needed size must go for the tile to
+  // be halved
+  static constexpr float SHRINK_HYSTERESIS = 0.375f;
+
+ private:
+  int _size;                   // Of the atlas
+  int _minTileSize;            // Of the smallest tiles
+  int _maxTileSize;            // Of the largest tiles
+  std::vector<size_t> _order;  // Indices of the tiles to place, largest first
+};
+
+#endif
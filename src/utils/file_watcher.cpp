@@ -0,0 +1,146 @@
+#include <filesystem>
+#include <iostream>
+#include <set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "file_watcher.hpp"
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher() {
+  _fileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_fileDescriptor < 0) {
+    std::cerr << "Unable to initialize inotify: " << strerror(errno) << "\n";
+  }
+}
+
+FileWatcher::~FileWatcher() {
+  if (_fileDescriptor >= 0) {
+    close(_fileDescriptor);  // Removes all the watches
+  }
+}
+
+bool FileWatcher::watchDirectory(const std::string& directoryPath) {
+  if (!_addWatch(directoryPath)) {
+    return false;
+  }
+
+  // Inotify watches aren't recursive
+  std::error_code error;
+  for (fs::recursive_directory_iterator it(directoryPath, error), end;
+       !error && it != end; it.increment(error)) {
+    if (it->is_directory(error)) {
+      _addWatch(it->path().generic_string());
+    }
+  }
+
+  return true;
+}
+
+std::vector<std::string> FileWatcher::pollChangedFiles() {
+  std::vector<std::string> changedFiles;
+  if (_fileDescriptor < 0) {
+    return changedFiles;
+  }
+
+  std::set<std::string> reportedFiles;
+  const auto reportFile = [&changedFiles,
+                           &reportedFiles](const std::string& filePath) {
+    if (reportedFiles.insert(filePath).second) {
+      changedFiles.push_back(filePath);
+    }
+  };
+
+  // Read all the queued events (the descriptor doesn't block)
+  alignas(inotify_event) char buffer[4096];
+  ssize_t readSize;
+  while ((readSize = read(_fileDescriptor, buffer, sizeof(buffer))) > 0) {
+    for (ssize_t offset = 0; offset < readSize;) {
+      const auto& event = *reinterpret_cast<inotify_event*>(buffer + offset);
+      offset += sizeof(inotify_event) + event.len;
+
+      if (event.mask & IN_Q_OVERFLOW) {
+        std::cerr << "File watcher queue overflowed, changes were lost\n";
+        continue;
+      }
+
+      const auto directory = _watchedDirectories.find(event.wd);
+      if (directory == _watchedDirectories.end()) {
+        continue;
+      }
+      if (event.mask & IN_IGNORED) {  // Directory deleted
+        _watchedDirectories.erase(directory);
+        continue;
+      }
+      if (event.len == 0) {
+        continue;
+      }
+
+      const auto path = directory->second + "/" + event.name;
+      if (event.mask & IN_ISDIR) {
+        // New directory: watch it, and report the files it already contains
+        if (watchDirectory(path)) {
+          std::error_code error;
+          for (fs::recursive_directory_iterator it(path, error), end;
+               !error && it != end; it.increment(error)) {
+            if (it->is_regular_file(error)) {
+              reportFile(it->path().generic_string());
+            }
+          }
+        }
+      } else if (event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        reportFile(path);  // Not when just created, as it's still empty
+      }
+    }
+  }
+
+  return changedFiles;
+}
+
+bool FileWatcher::_addWatch(const std::string& directoryPath) {
+  if (_fileDescriptor < 0) {
+    return false;
+  }
+
+  const auto watchDescriptor =
+      inotify_add_watch(_fileDescriptor, directoryPath.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+  if (watchDescriptor < 0) {
+    std::cerr << "Unable to watch directory '" << directoryPath
+              << "': " << strerror(errno) << "\n";
+    return false;
+  }
+
+  _watchedDirectories[watchDescriptor] = directoryPath;
+  return true;
+}
+
+#else
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {}
+
+bool FileWatcher::watchDirectory(const std::string& directoryPath) {
+  return _addWatch(directoryPath);
+}
+
+std::vector<std::string> FileWatcher::pollChangedFiles() {
+  return {};
+}
+
+bool FileWatcher::_addWatch(const std::string& directoryPath) {
+  std::cerr << "Unable to watch directory '" << directoryPath
+            << "': file watching is only supported on Linux\n";
+  return false;
+}
+
+#endif
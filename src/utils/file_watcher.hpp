@@ -0,0 +1,58 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Watches directory trees for modified files, without blocking: changes are
+ * collected by the kernel (inotify) and polled once per frame.
+ *
+ * A file is reported once it's closed after being written, or moved into a
+ * watched directory (editors often save through a temporary file), so
+ * half-written files aren't reported. Only supported on Linux: elsewhere, no
+ * directory can be watched.
+ */
+class FileWatcher {
+ public:
+  FileWatcher();
+
+  /**
+   * Stops watching all the directories.
+   */
+  ~FileWatcher();
+
+  // Disable copy constructor
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  /**
+   * Starts watching a directory and all its subdirectories (including those
+   * created later).
+   * @param directoryPath Path to the directory to watch
+   * @return True if the directory is watched, false otherwise
+   */
+  bool watchDirectory(const std::string& directoryPath);
+
+  /**
+   * Gets the files modified since the last call, each one once, in the order
+   * of their first change.
+   * @return Paths to the modified files, starting with the path of their
+   * watched directory
+   */
+  std::vector<std::string> pollChangedFiles();
+
+ private:
+  /**
+   * Adds a watch on a single directory.
+   * @return True if the directory is watched, false otherwise
+   */
+  bool _addWatch(const std::string& directoryPath);
+
+  int _fileDescriptor = -1;  // Inotify instance (-1 if unavailable)
+  std::map<int, std::string>
+      _watchedDirectories;  // Path of the directory of each watch descriptor
+};
+
+#endif
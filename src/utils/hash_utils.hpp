@@ -0,0 +1,35 @@
+#ifndef HASH_UTILS_HPP
+#define HASH_UTILS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hash_utils {
+
+// FNV-1a 64 bits constants
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+/**
+ * Hashes a block of bytes with FNV-1a (64 bits).
+ *
+ * @param data  Pointer to the bytes to hash
+ * @param size  Number of bytes to hash
+ * @param hash  Previous hash value, to chain several blocks together
+ *
+ * @return The updated hash value.
+ */
+inline uint64_t fnv1a64(const void* data,
+                        size_t size,
+                        uint64_t hash = FNV_OFFSET_BASIS) {
+  const auto bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+}  // namespace hash_utils
+
+#endif
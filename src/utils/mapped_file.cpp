@@ -0,0 +1,142 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.hpp"
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filePath) {
+  close();
+
+  HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    CloseHandle(file);
+    return false;
+  }
+
+  _fileHandle = file;
+  _size = static_cast<size_t>(fileSize.QuadPart);
+  _isOpen = true;
+
+  // Empty files can't be mapped, but are still valid
+  if (_size == 0) {
+    return true;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    close();
+    return false;
+  }
+  _mappingHandle = mapping;
+
+  _data = static_cast<const unsigned char*>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (_data == nullptr) {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data != nullptr) {
+    UnmapViewOfFile(_data);
+  }
+  if (_mappingHandle != nullptr) {
+    CloseHandle(_mappingHandle);
+  }
+  if (_fileHandle != nullptr) {
+    CloseHandle(_fileHandle);
+  }
+
+  _data = nullptr;
+  _mappingHandle = nullptr;
+  _fileHandle = nullptr;
+  _size = 0;
+  _isOpen = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filePath) {
+  close();
+
+  int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+  if (fileDescriptor == -1) {
+    return false;
+  }
+
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) == -1) {
+    ::close(fileDescriptor);
+    return false;
+  }
+
+  _fileDescriptor = fileDescriptor;
+  _size = static_cast<size_t>(fileStat.st_size);
+  _isOpen = true;
+
+  // Empty files can't be mapped, but are still valid
+  if (_size == 0) {
+    return true;
+  }
+
+  void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  if (data == MAP_FAILED) {
+    close();
+    return false;
+  }
+  _data = static_cast<const unsigned char*>(data);
+
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data != nullptr) {
+    munmap(const_cast<unsigned char*>(_data), _size);
+  }
+  if (_fileDescriptor != -1) {
+    ::close(_fileDescriptor);
+  }
+
+  _data = nullptr;
+  _fileDescriptor = -1;
+  _size = 0;
+  _isOpen = false;
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+  return _isOpen;
+}
+
+const unsigned char* MappedFile::getData() const {
+  return _data;
+}
+
+size_t MappedFile::getSize() const {
+  return _size;
+}
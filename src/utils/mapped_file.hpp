@@ -0,0 +1,60 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  // Disable copy constructor
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Maps the given file into memory (read-only).
+   * @param filePath Path to the file to map
+   * @return True if the file has been mapped, false otherwise
+   */
+  bool open(const std::string& filePath);
+
+  /**
+   * Unmaps the file. Does nothing if no file is mapped.
+   */
+  void close();
+
+  /**
+   * Checks if a file is currently mapped.
+   */
+  bool isOpen() const;
+
+  /**
+   * Gets pointer to the first byte of the mapped file
+   * (nullptr if nothing is mapped or the file is empty).
+   */
+  const unsigned char* getData() const;
+
+  /**
+   * Gets size of the mapped file (in bytes).
+   */
+  size_t getSize() const;
+
+ private:
+  const unsigned char* _data = nullptr;  // Start of the mapped view
+  size_t _size = 0;                      // Size of the mapped view in bytes
+  bool _isOpen = false;                  // Whether a file is mapped
+
+#ifdef _WIN32
+  void* _fileHandle = nullptr;     // Win32 file handle
+  void* _mappingHandle = nullptr;  // Win32 file mapping handle
+#else
+  int _fileDescriptor = -1;  // POSIX file descriptor
+#endif
+};
+
+#endif
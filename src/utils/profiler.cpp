@@ -0,0 +1,195 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#include "profiler.hpp"
+
+/**
+ * Writes a string as a JSON string literal.
+ */
+static void writeJsonString(std::ostream& stream, const std::string& value) {
+  stream << '"';
+  for (const auto c : value) {
+    if (c == '"' || c == '\\') {
+      stream << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+             << static_cast<int>(c) << std::dec << std::setfill(' ');
+    } else {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+
+Profiler::ScopedPhase::ScopedPhase(std::string asset, std::string name)
+    : _asset(std::move(asset)),
+      _name(std::move(name)),
+      _startTime(Clock::now()) {}
+
+Profiler::ScopedPhase::~ScopedPhase() {
+  Profiler::getInstance().addPhase(_asset, _name, _startTime, Clock::now());
+}
+
+Profiler::GpuTimer::GpuTimer(std::string asset, std::string name)
+    : _asset(std::move(asset)), _name(std::move(name)) {
+  glGenQueries(QUERY_COUNT, _queries);
+}
+
+Profiler::GpuTimer::~GpuTimer() {
+  glDeleteQueries(QUERY_COUNT, _queries);
+}
+
+void Profiler::GpuTimer::begin() {
+  // Skip this timing rather than wait for the oldest result
+  _isTiming = _pendingCount < QUERY_COUNT;
+  if (_isTiming) {
+    glBeginQuery(GL_TIME_ELAPSED, _queries[_nextQuery]);
+  }
+}
+
+void Profiler::GpuTimer::end() {
+  if (_isTiming) {
+    glEndQuery(GL_TIME_ELAPSED);
+    _nextQuery = (_nextQuery + 1) % QUERY_COUNT;
+    _pendingCount++;
+    _isTiming = false;
+  }
+
+  // Results come in order, so stop at the first one not available yet
+  auto& profiler = Profiler::getInstance();
+  while (_pendingCount > 0) {
+    const auto query =
+        _queries[(_nextQuery + QUERY_COUNT - _pendingCount) % QUERY_COUNT];
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable == GL_FALSE) {
+      break;
+    }
+    GLuint64 elapsedTime = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedTime);
+    _pendingCount--;
+
+    _lastMs = elapsedTime / 1e6;
+    profiler.addCount(_asset, _name + "Ns", elapsedTime);
+    profiler.addCount(_asset, _name + "Count", 1);
+  }
+}
+
+double Profiler::GpuTimer::getLastMs() const {
+  return _lastMs;
+}
+
+Profiler::Profiler() : _startTime(Clock::now()) {
+  // The thread creating the profiler comes first
+  _threadIndices[std::this_thread::get_id()] = 0;
+}
+
+Profiler& Profiler::getInstance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::addPhase(const std::string& asset,
+                        const std::string& name,
+                        Clock::time_point startTime,
+                        Clock::time_point endTime) {
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto threadIndex =
+      _threadIndices.insert({std::this_thread::get_id(), _threadIndices.size()})
+          .first->second;
+  _phases.push_back({asset, name, Milliseconds(startTime - _startTime).count(),
+                     Milliseconds(endTime - startTime).count(), threadIndex});
+}
+
+void Profiler::addCount(const std::string& asset,
+                        const std::string& counter,
+                        uint64_t value) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _counters[asset][counter] += value;
+}
+
+bool Profiler::writeReport(const std::string& filePath) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // Total time of each phase of each asset (a phase may run several times)
+  std::map<std::string, std::map<std::string, double>> assetPhases;
+  for (const auto& phase : _phases) {
+    assetPhases[phase.asset][phase.name] += phase.durationMs;
+  }
+  for (const auto& counters : _counters) {
+    assetPhases[counters.first];  // Assets with counters only
+  }
+
+  std::ofstream file(filePath, std::ios::trunc);
+  if (!file.good()) {
+    std::cerr << "Unable to write profiling report: " << filePath << "\n";
+    return false;
+  }
+  file << std::fixed << std::setprecision(3);
+
+  file << "{\n  \"totalMs\": " << getElapsedMs() << ",\n";
+  file << "  \"assets\": [";
+  bool isFirstAsset = true;
+  for (const auto& asset : assetPhases) {
+    file << (isFirstAsset ? "\n" : ",\n") << "    {\"name\": ";
+    writeJsonString(file, asset.first);
+    file << ", \"phasesMs\": {";
+    bool isFirstPhase = true;
+    for (const auto& phase : asset.second) {
+      file << (isFirstPhase ? "" : ", ");
+      writeJsonString(file, phase.first);
+      file << ": " << phase.second;
+      isFirstPhase = false;
+    }
+    file << "}, \"counters\": {";
+    const auto counters = _counters.find(asset.first);
+    if (counters != _counters.end()) {
+      bool isFirstCounter = true;
+      for (const auto& counter : counters->second) {
+        file << (isFirstCounter ? "" : ", ");
+        writeJsonString(file, counter.first);
+        file << ": " << counter.second;
+        isFirstCounter = false;
+      }
+    }
+    file << "}}";
+    isFirstAsset = false;
+  }
+  file << "\n  ],\n";
+
+  file << "  \"timeline\": [";
+  for (size_t i = 0; i < _phases.size(); i++) {
+    const auto& phase = _phases[i];
+    file << (i == 0 ? "\n" : ",\n") << "    {\"asset\": ";
+    writeJsonString(file, phase.asset);
+    file << ", \"phase\": ";
+    writeJsonString(file, phase.name);
+    file << ", \"thread\": " << phase.threadIndex
+         << ", \"startMs\": " << phase.startMs
+         << ", \"durationMs\": " << phase.durationMs << "}";
+  }
+  file << "\n  ]\n}\n";
+  file.close();
+
+  if (!file.good()) {
+    std::cerr << "Unable to write profiling report: " << filePath << "\n";
+    return false;
+  }
+
+  std::cout << "Written profiling report: " << filePath << "\n";
+  return true;
+}
+
+std::string Profiler::getAssetName(const std::string& kind,
+                                   const std::string& name) {
+  return kind + ":" + name;
+}
+
+double Profiler::getElapsedMs() const {
+  return std::chrono::duration<double, std::milli>(Clock::now() - _startTime)
+      .count();
+}
@@ -0,0 +1,184 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+ * Singleton class collecting the time spent in each phase of the startup and
+ * of the loading of each asset (e.g. parse, decode, upload), along with
+ * counters (bytes, vertices, triangles...), from any thread. The collected
+ * data is written as a JSON report.
+ *
+ * Assets are named by kind and name, like "model:cart" or
+ * "texture:models/cart/textures/wood.png". GPU work (e.g. frames) can be timed
+ * too, with a GpuTimer.
+ */
+class Profiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Timed phase of an asset.
+   */
+  struct Phase {
+    std::string asset;   // Asset the phase belongs to
+    std::string name;    // Name of the phase
+    double startMs;      // Start time, since the profiler was created
+    double durationMs;   // Duration of the phase
+    size_t threadIndex;  // Index of the thread it ran on (0 for the first
+                         // thread seen, usually the main one)
+  };
+
+  /**
+   * Times a phase from its construction to its destruction.
+   */
+  class ScopedPhase {
+   public:
+    /**
+     * Starts timing a phase.
+     * @param asset  Asset the phase belongs to
+     * @param name   Name of the phase
+     */
+    ScopedPhase(std::string asset, std::string name);
+
+    /**
+     * Records the phase.
+     */
+    ~ScopedPhase();
+
+    // Disable copy constructor
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+   private:
+    std::string _asset;
+    std::string _name;
+    Clock::time_point _startTime;
+  };
+
+  /**
+   * Times GPU work with GL_TIME_ELAPSED queries, from the OpenGL context's
+   * thread. Results are read once available, a few frames later, so that
+   * timing never waits for the GPU. Each one is added to the counters
+   * "<name>Ns" (in nanoseconds) and "<name>Count" of the asset.
+   */
+  class GpuTimer {
+   public:
+    /**
+     * Creates the queries of the timer.
+     * @param asset  Asset the timed work belongs to
+     * @param name   Name of the timed work
+     */
+    GpuTimer(std::string asset, std::string name);
+
+    /**
+     * Deletes the queries of the timer.
+     */
+    ~GpuTimer();
+
+    // Disable copy constructor
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    /**
+     * Starts timing the commands that follow, unless all the queries are still
+     * waiting for their results. Only one timer can run at a time.
+     */
+    void begin();
+
+    /**
+     * Stops timing, then reads the results that are available.
+     */
+    void end();
+
+    /**
+     * Gets the GPU time of the last timed work whose result has been read (in
+     * milliseconds, 0 if none has been).
+     */
+    double getLastMs() const;
+
+    // Number of queries, i.e. of timings waiting for their results at most
+    static constexpr size_t QUERY_COUNT = 4;
+
+   private:
+    std::string _asset;
+    std::string _name;
+    GLuint _queries[QUERY_COUNT];  // Used in turn
+    size_t _nextQuery = 0;         // Query the next timing begins
+    size_t _pendingCount = 0;      // Queries waiting for their results
+    bool _isTiming = false;        // Whether a query has begun
+    double _lastMs = 0.0;          // Last result read
+  };
+
+  /**
+   * Gets the one and only instance of the profiler (created at the first
+   * call, which is the origin of the reported times).
+   */
+  static Profiler& getInstance();
+
+  /**
+   * Records a phase of an asset.
+   * @param asset      Asset the phase belongs to
+   * @param name       Name of the phase
+   * @param startTime  When the phase started
+   * @param endTime    When the phase ended
+   */
+  void addPhase(const std::string& asset,
+                const std::string& name,
+                Clock::time_point startTime,
+                Clock::time_point endTime);
+
+  /**
+   * Adds to a counter of an asset (counters start at 0).
+   * @param asset    Asset the counter belongs to
+   * @param counter  Name of the counter
+   * @param value    Value to add
+   */
+  void addCount(const std::string& asset,
+                const std::string& counter,
+                uint64_t value);
+
+  /**
+   * Writes the report: for each asset, the total time of each of its phases
+   * and its counters, then the timeline of all the phases.
+   * @param filePath Path to the JSON file to write
+   * @return True if the report has been written, false otherwise
+   */
+  bool writeReport(const std::string& filePath) const;
+
+  /**
+   * Gets the name of an asset in the report.
+   * @param kind  Kind of asset (e.g. "model")
+   * @param name  Name of the asset (e.g. "cart")
+   */
+  static std::string getAssetName(const std::string& kind,
+                                  const std::string& name);
+
+  /**
+   * Gets the time elapsed since the profiler was created (in milliseconds).
+   */
+  double getElapsedMs() const;
+
+ private:
+  Profiler();  // Private constructor to make class singleton
+  Profiler(const Profiler&) = delete;        // No copy constructor allowed
+  void operator=(const Profiler&) = delete;  // No copy assignment allowed
+
+  Clock::time_point _startTime;  // Origin of the reported times
+  std::vector<Phase> _phases;    // Recorded phases, in the order they ended
+  std::map<std::string, std::map<std::string, uint64_t>>
+      _counters;  // Counters of each asset
+  std::map<std::thread::id, size_t>
+      _threadIndices;      // Index of each thread, in order of appearance
+  mutable std::mutex _mutex;  // Phases may be recorded from any thread
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include <iterator>
+
+#include "range_allocator.hpp"
+
+RangeAllocator::RangeAllocator(size_t capacity) {
+  grow(capacity);
+}
+
+bool RangeAllocator::allocate(size_t count, size_t& offset) {
+  if (count == 0) {
+    offset = 0;
+    return true;
+  }
+
+  for (auto freeRange = _freeRanges.begin(); freeRange != _freeRanges.end();
+       ++freeRange) {
+    if (freeRange->second < count) {
+      continue;
+    }
+
+    // Take the beginning of the free range
+    offset = freeRange->first;
+    const auto remainingCount = freeRange->second - count;
+    _freeRanges.erase(freeRange);
+    if (remainingCount > 0) {
+      _freeRanges[offset + count] = remainingCount;
+    }
+    _usedCount += count;
+    return true;
+  }
+
+  return false;
+}
+
+void RangeAllocator::free(size_t offset, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  _usedCount -= count;
+
+  // Merge with the next free range
+  auto next = _freeRanges.find(offset + count);
+  if (next != _freeRanges.end()) {
+    count += next->second;
+    _freeRanges.erase(next);
+  }
+
+  // Merge with the previous free range
+  auto freeRange = _freeRanges.emplace(offset, count).first;
+  if (freeRange != _freeRanges.begin()) {
+    auto previous = std::prev(freeRange);
+    if (previous->first + previous->second == offset) {
+      previous->second += count;
+      _freeRanges.erase(freeRange);
+    }
+  }
+}
+
+void RangeAllocator::grow(size_t capacity) {
+  if (capacity <= _capacity) {
+    return;
+  }
+
+  const auto oldCapacity = _capacity;
+  _capacity = capacity;
+  _usedCount += capacity - oldCapacity;  // Freed right away
+  free(oldCapacity, capacity - oldCapacity);
+}
+
+size_t RangeAllocator::getCapacity() const {
+  return _capacity;
+}
+
+size_t RangeAllocator::getUsedCount() const {
+  return _usedCount;
+}
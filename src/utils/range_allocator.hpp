@@ -0,0 +1,58 @@
+#ifndef RANGE_ALLOCATOR_HPP
+#define RANGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <map>
+
+/**
+ * Hands out ranges of elements of a buffer (e.g. vertices of a VBO), first
+ * fit. Freed ranges are merged with their free neighbours, so that the space
+ * of unloaded meshes can be reused by larger ones.
+ */
+class RangeAllocator {
+ public:
+  /**
+   * Creates an allocator of an empty buffer.
+   * @param capacity Number of elements of the buffer
+   */
+  explicit RangeAllocator(size_t capacity = 0);
+
+  /**
+   * Allocates a range of elements.
+   * @param count   Number of elements
+   * @param offset  Set to the first element of the range
+   * @return True if the range has been allocated, or false if no free range
+   * is large enough (the buffer must grow).
+   */
+  bool allocate(size_t count, size_t& offset);
+
+  /**
+   * Frees a range of elements, previously allocated.
+   * @param offset  First element of the range
+   * @param count   Number of elements
+   */
+  void free(size_t offset, size_t count);
+
+  /**
+   * Adds elements at the end of the buffer.
+   * @param capacity New number of elements of the buffer (not lower)
+   */
+  void grow(size_t capacity);
+
+  /**
+   * Gets the number of elements of the buffer.
+   */
+  size_t getCapacity() const;
+
+  /**
+   * Gets the number of allocated elements.
+   */
+  size_t getUsedCount() const;
+
+ private:
+  std::map<size_t, size_t> _freeRanges;  // Element counts, by first element
+  size_t _capacity = 0;                  // Number of elements
+  size_t _usedCount = 0;                 // Number of allocated elements
+};
+
+#endif
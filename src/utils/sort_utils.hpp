@@ -0,0 +1,69 @@
+#ifndef SORT_UTILS_HPP
+#define SORT_UTILS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace sort_utils {
+
+/**
+ * Sorts items by a 64 bits key with a stable LSD radix sort (8 passes of 8
+ * bits at most). The histograms of all the passes are built at once, and
+ * passes where all the keys share the same byte are skipped, so that keys
+ * only using a few bits sort in fewer passes.
+ *
+ * @param items    Items to sort
+ * @param scratch  Buffer the items are moved back and forth with (kept
+ * between calls to avoid allocations)
+ * @param getKey   Function returning the key (uint64_t) of an item
+ */
+template <typename T, typename KeyFunction>
+void radixSort(std::vector<T>& items,
+               std::vector<T>& scratch,
+               KeyFunction getKey) {
+  constexpr size_t PASS_COUNT = sizeof(uint64_t);
+  constexpr size_t BUCKET_COUNT = 256;
+
+  const auto itemCount = items.size();
+  if (itemCount < 2) {
+    return;
+  }
+
+  std::array<std::array<size_t, BUCKET_COUNT>, PASS_COUNT> histograms{};
+  for (const auto& item : items) {
+    const uint64_t key = getKey(item);
+    for (size_t pass = 0; pass < PASS_COUNT; pass++) {
+      histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+  }
+
+  scratch.resize(itemCount);
+  for (size_t pass = 0; pass < PASS_COUNT; pass++) {
+    auto& histogram = histograms[pass];
+    const auto firstByte = (getKey(items.front()) >> (pass * 8)) & 0xFF;
+    if (histogram[firstByte] == itemCount) {
+      continue;  // Nothing to reorder
+    }
+
+    // Bucket offsets
+    size_t offset = 0;
+    for (auto& count : histogram) {
+      const auto bucketCount = count;
+      count = offset;
+      offset += bucketCount;
+    }
+
+    for (auto& item : items) {
+      const auto byte = (getKey(item) >> (pass * 8)) & 0xFF;
+      scratch[histogram[byte]++] = std::move(item);
+    }
+    items.swap(scratch);
+  }
+}
+
+}  // namespace sort_utils
+
+#endif
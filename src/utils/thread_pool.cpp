@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (size_t i = 0; i < threadCount; i++) {
+    _workers.emplace_back(&ThreadPool::_workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isStopping = true;
+  }
+  _condition.notify_all();
+
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+ThreadPool& ThreadPool::getInstance() {
+  static ThreadPool tp;
+  return tp;
+}
+
+void ThreadPool::parallelFor(size_t count,
+                             const std::function<void(size_t)>& body) {
+  if (count == 0) {
+    return;
+  }
+
+  // Shared with the helper tasks, which may only run once this call returned
+  struct State {
+    std::function<void(size_t)> body;
+    size_t count;
+    std::atomic<size_t> nextIndex{0};
+    size_t finishedCount = 0;  // Protected by mutex
+    std::exception_ptr exception;  // Protected by mutex
+    std::mutex mutex;
+    std::condition_variable condition;
+  };
+  auto state = std::make_shared<State>();
+  state->body = body;
+  state->count = count;
+
+  const auto work = [state]() {
+    while (true) {
+      const auto index = state->nextIndex++;
+      if (index >= state->count) {
+        return;
+      }
+
+      std::exception_ptr exception;
+      try {
+        state->body(index);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (exception && !state->exception) {
+        state->exception = exception;
+      }
+      if (++state->finishedCount == state->count) {
+        state->condition.notify_all();
+      }
+    }
+  };
+
+  const auto helperCount = std::min(count, _workers.size()) - 1;
+  for (size_t i = 0; i < helperCount; i++) {
+    submit(work);
+  }
+  work();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->condition.wait(
+      lock, [&state]() { return state->finishedCount == state->count; });
+  if (state->exception) {
+    std::rethrow_exception(state->exception);
+  }
+}
+
+size_t ThreadPool::getThreadCount() const {
+  return _workers.size();
+}
+
+void ThreadPool::_workerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this]() { return _isStopping || !_tasks.empty(); });
+
+      // Only stop once every queued task has been executed
+      if (_tasks.empty()) {
+        return;
+      }
+
+      task = std::move(_tasks.front());
+      _tasks.pop();
+    }
+
+    task();
+  }
+}
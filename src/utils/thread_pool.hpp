@@ -0,0 +1,91 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Fixed-size pool of worker threads executing submitted tasks in FIFO order.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Creates the pool and starts its worker threads.
+   * @param threadCount Number of worker threads (0 means one per hardware
+   * thread)
+   */
+  explicit ThreadPool(size_t threadCount = 0);
+
+  /**
+   * Finishes all the queued tasks, then stops the worker threads.
+   */
+  ~ThreadPool();
+
+  // Disable copy constructor
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Gets the pool shared by the whole application (used to load assets).
+   */
+  static ThreadPool& getInstance();
+
+  /**
+   * Submits a task to be executed by a worker thread.
+   * @param task Callable taking no argument
+   * @return Future holding the task's result (or the exception it threw)
+   */
+  template <typename F>
+  std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& task) {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+
+    // std::function must be copyable, so the packaged task is shared
+    auto packagedTask =
+        std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    auto future = packagedTask->get_future();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _tasks.emplace([packagedTask]() { (*packagedTask)(); });
+    }
+    _condition.notify_one();
+
+    return future;
+  }
+
+  /**
+   * Runs a function for every index of a range, spread over the worker
+   * threads and the calling thread, and waits for all of them to finish.
+   * The calling thread works through the range too, so it can be a worker of
+   * this pool (waiting never depends on a queued task being executed).
+   * @param count  Number of indices (0 to count - 1)
+   * @param body   Function called with each index (rethrows the first
+   * exception it threw)
+   */
+  void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+  /**
+   * Gets the number of worker threads.
+   */
+  size_t getThreadCount() const;
+
+ private:
+  std::vector<std::thread> _workers;         // Worker threads
+  std::queue<std::function<void()>> _tasks;  // Tasks waiting to be executed
+  std::mutex _mutex;                         // Protects the tasks queue
+  std::condition_variable _condition;        // Signals new tasks or stopping
+  bool _isStopping = false;                  // Tells workers to stop
+
+  /**
+   * Loop executed by each worker thread.
+   */
+  void _workerLoop();
+};
+
+#endif
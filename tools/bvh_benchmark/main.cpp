@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../../src/scene/bounding_volume_hierarchy.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Numbers of objects measured
+static const size_t OBJECT_COUNTS[] = {100, 1000, 10000, 100000};
+// Queries of each kind per object count (the average time is reported)
+static const int QUERY_COUNT = 1000;
+// Part of the objects moved (and refitted) per frame
+static const float MOVING_RATIO = 0.01f;
+
+/**
+ * Gets the time elapsed since start, in microseconds.
+ */
+static double getMicroseconds(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+      .count();
+}
+
+/**
+ * Random scene: boxes of a few units, spread so that their density stays the
+ * same whatever their number (like a larger world rather than a denser one).
+ */
+static std::vector<BoundingBox> createBoxes(size_t count, std::mt19937& rng) {
+  const float worldSize = 50.0f * std::cbrt(static_cast<float>(count));
+  std::uniform_real_distribution<float> position(-worldSize, worldSize);
+  std::uniform_real_distribution<float> size(0.5f, 5.0f);
+  std::vector<BoundingBox> boxes(count);
+  for (auto& box : boxes) {
+    const glm::vec3 center(position(rng), position(rng), position(rng));
+    const glm::vec3 extents(size(rng), size(rng), size(rng));
+    box = {center - extents, center + extents};
+  }
+  return boxes;
+}
+
+int main() {
+  std::mt19937 rng(42);
+
+  // Build and refit times in milliseconds, then average query times in
+  // microseconds, through the hierarchy and over all the objects
+  std::cout << std::right << std::setw(9) << "objects" << std::setw(11)
+            << "build" << std::setw(9) << "refit" << std::setw(11)
+            << "frustum" << std::setw(9) << "linear" << std::setw(9)
+            << "sphere" << std::setw(9) << "linear" << std::setw(9) << "ray"
+            << std::setw(9) << "linear" << "\n";
+  std::cout << std::fixed << std::setprecision(2);
+
+  for (const auto objectCount : OBJECT_COUNTS) {
+    auto boxes = createBoxes(objectCount, rng);
+    std::vector<size_t> items(objectCount);
+    for (size_t i = 0; i < objectCount; i++) {
+      items[i] = i;
+    }
+    const float worldSize = 50.0f * std::cbrt(static_cast<float>(objectCount));
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    auto start = Clock::now();
+    BoundingVolumeHierarchy bvh;
+    bvh.build(items, boxes);
+    const double buildTime = getMicroseconds(start) / 1000.0;
+
+    // Move some objects by a few units
+    const auto movingCount =
+        std::max<size_t>(1, static_cast<size_t>(objectCount * MOVING_RATIO));
+    start = Clock::now();
+    for (size_t i = 0; i < movingCount; i++) {
+      auto& box = boxes[i * (objectCount / movingCount)];
+      const glm::vec3 offset(unit(rng), unit(rng), unit(rng));
+      box = {box.min + offset, box.max + offset};
+      bvh.refit(i * (objectCount / movingCount), box);
+    }
+    const double refitTime = getMicroseconds(start) / 1000.0;
+
+    // Random queries of each kind (the same ones for both methods), checking
+    // that both find as many objects
+    std::vector<Frustum> frustums(QUERY_COUNT);
+    std::vector<glm::vec4> spheres(QUERY_COUNT);
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays(QUERY_COUNT);
+    const auto projectionMatrix =
+        glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    for (int i = 0; i < QUERY_COUNT; i++) {
+      const glm::vec3 eye(position(rng), position(rng), position(rng));
+      const glm::vec3 direction(unit(rng), unit(rng), unit(rng));
+      frustums[i] = Frustum::fromMatrix(
+          projectionMatrix *
+          glm::lookAt(eye, eye + direction, glm::vec3(0, 1, 0)));
+      spheres[i] = glm::vec4(position(rng), position(rng), position(rng),
+                             50.0f);
+      rays[i] = {eye, direction * 1000.0f};
+    }
+
+    std::vector<size_t> results;
+    size_t bvhResultCount = 0, linearResultCount = 0;
+
+    start = Clock::now();
+    for (const auto& frustum : frustums) {
+      results.clear();
+      bvh.queryFrustum(frustum, results);
+      bvhResultCount += results.size();
+    }
+    const double frustumTime = getMicroseconds(start) / QUERY_COUNT;
+    start = Clock::now();
+    for (const auto& frustum : frustums) {
+      results.clear();
+      for (size_t i = 0; i < objectCount; i++) {
+        const auto center = (boxes[i].min + boxes[i].max) * 0.5f;
+        const auto extents = (boxes[i].max - boxes[i].min) * 0.5f;
+        bool isInside = true;
+        for (const auto& plane : frustum.planes) {
+          isInside = isInside &&
+                     glm::dot(glm::vec3(plane), center) + plane.w +
+                             glm::dot(glm::abs(glm::vec3(plane)), extents) >=
+                         0.0f;
+        }
+        if (isInside) {
+          results.push_back(i);
+        }
+      }
+      linearResultCount += results.size();
+    }
+    const double frustumLinearTime = getMicroseconds(start) / QUERY_COUNT;
+
+    start = Clock::now();
+    for (const auto& sphere : spheres) {
+      results.clear();
+      bvh.querySphere(glm::vec3(sphere), sphere.w, results);
+      bvhResultCount += results.size();
+    }
+    const double sphereTime = getMicroseconds(start) / QUERY_COUNT;
+    start = Clock::now();
+    for (const auto& sphere : spheres) {
+      results.clear();
+      for (size_t i = 0; i < objectCount; i++) {
+        const glm::vec3 center(sphere);
+        const auto offset =
+            center - glm::clamp(center, boxes[i].min, boxes[i].max);
+        if (glm::dot(offset, offset) <= sphere.w * sphere.w) {
+          results.push_back(i);
+        }
+      }
+      linearResultCount += results.size();
+    }
+    const double sphereLinearTime = getMicroseconds(start) / QUERY_COUNT;
+
+    start = Clock::now();
+    for (const auto& ray : rays) {
+      results.clear();
+      bvh.queryRay(ray.first, ray.second, 1.0f, results);
+      bvhResultCount += results.size();
+    }
+    const double rayTime = getMicroseconds(start) / QUERY_COUNT;
+    start = Clock::now();
+    for (const auto& ray : rays) {
+      results.clear();
+      const auto inverseDirection = 1.0f / ray.second;
+      for (size_t i = 0; i < objectCount; i++) {
+        const auto t0 = (boxes[i].min - ray.first) * inverseDirection;
+        const auto t1 = (boxes[i].max - ray.first) * inverseDirection;
+        const auto tMin = glm::min(t0, t1);
+        const auto tMax = glm::max(t0, t1);
+        const float enter =
+            std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+        const float exit =
+            std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, 1.0f));
+        if (enter <= exit) {
+          results.push_back(i);
+        }
+      }
+      linearResultCount += results.size();
+    }
+    const double rayLinearTime = getMicroseconds(start) / QUERY_COUNT;
+
+    std::cout << std::setw(9) << objectCount << std::setw(11) << buildTime
+              << std::setw(9) << refitTime << std::setw(11) << frustumTime
+              << std::setw(9) << frustumLinearTime << std::setw(9)
+              << sphereTime << std::setw(9) << sphereLinearTime
+              << std::setw(9) << rayTime << std::setw(9) << rayLinearTime;
+    if (bvhResultCount != linearResultCount) {
+      std::cout << "  mismatch";
+    }
+    std::cout << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../src/scene/mesh_optimizer.hpp"
+#include "../../src/scene/normal_generator.hpp"
+#include "../../src/scene/obj_parser.hpp"
+#include "../../src/scene/vertex_welder.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * Loads the welded geometry of every material of an OBJ file, the same way
+ * the application does (parsed, missing normals generated, then welded).
+ */
+static bool loadGeometry(const fs::path& modelDir,
+                         std::vector<VertexWelder>& geometry) {
+  ObjParser parser;
+  if (!parser.parse((modelDir / "model.obj").string())) {
+    return false;
+  }
+
+  geometry.resize(parser.materialVertices.size());
+  for (size_t m = 0; m < parser.materialVertices.size(); m++) {
+    NormalGenerator::generate(parser.materialVertices[m]);
+    for (const auto& vertex : parser.materialVertices[m]) {
+      geometry[m].addVertex(vertex);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Gets the vertex cache efficiency of meshes (weighted by triangles).
+ */
+static MeshOptimizer::CacheStatistics analyze(
+    const std::vector<VertexWelder>& geometry) {
+  MeshOptimizer::CacheStatistics total;
+  size_t triangleCount = 0;
+  for (const auto& mesh : geometry) {
+    const auto statistics =
+        MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    const auto meshTriangleCount = mesh.indices.size() / 3;
+    total.acmr += statistics.acmr * meshTriangleCount;
+    total.atvr += statistics.atvr * meshTriangleCount;
+    triangleCount += meshTriangleCount;
+  }
+
+  if (triangleCount > 0) {
+    total.acmr /= triangleCount;
+    total.atvr /= triangleCount;
+  }
+  return total;
+}
+
+int main(int argc, char* argv[]) {
+  const fs::path modelsDir = argc > 1 ? argv[1] : "models";
+  if (!fs::is_directory(modelsDir)) {
+    std::cerr << "Usage: " << argv[0] << " [models dir]\n";
+    return 1;
+  }
+
+  // ACMR as loaded, after the vertex cache and overdraw steps, then ATVR as
+  // loaded and after all steps
+  std::cout << std::left << std::setw(14) << "model" << std::right
+            << std::setw(11) << "triangles" << std::setw(9) << "ACMR"
+            << std::setw(9) << "+cache" << std::setw(11) << "+overdraw"
+            << std::setw(9) << "ATVR" << std::setw(9) << "+all"
+            << std::setw(11) << "time (ms)" << "\n";
+  std::cout << std::fixed << std::setprecision(3);
+
+  for (const auto& entry : fs::directory_iterator(modelsDir)) {
+    std::vector<VertexWelder> geometry;
+    if (!entry.is_directory() || !loadGeometry(entry.path(), geometry)) {
+      continue;
+    }
+
+    size_t triangleCount = 0;
+    for (const auto& mesh : geometry) {
+      triangleCount += mesh.indices.size() / 3;
+    }
+    if (triangleCount == 0) {
+      continue;
+    }
+
+    // Measure each step, as the loader runs them
+    const auto original = analyze(geometry);
+    const auto start = std::chrono::steady_clock::now();
+    for (auto& mesh : geometry) {
+      MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    }
+    const auto cacheOptimized = analyze(geometry);
+    for (auto& mesh : geometry) {
+      MeshOptimizer::optimizeOverdraw(mesh.indices, mesh.vertices);
+    }
+    const auto overdrawOptimized = analyze(geometry);
+    for (auto& mesh : geometry) {
+      MeshOptimizer::optimizeVertexFetch(mesh.vertices, mesh.indices);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    std::cout << std::left << std::setw(14)
+              << entry.path().filename().string() << std::right
+              << std::setw(11) << triangleCount << std::setw(9)
+              << original.acmr << std::setw(9) << cacheOptimized.acmr
+              << std::setw(11) << overdrawOptimized.acmr << std::setw(9)
+              << original.atvr << std::setw(9) << overdrawOptimized.atvr
+              << std::setw(11)
+              << std::chrono::duration<double, std::milli>(end - start).count()
+              << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#include "../../src/scene/obj_parser.hpp"
+
+namespace fs = std::filesystem;
+
+// Runs of each parser, the fastest one being reported
+static const int RUN_COUNT = 5;
+
+/**
+ * Loads the triangle vertices of every material of an OBJ file with
+ * tinyobjloader, the way the application used to.
+ */
+static bool loadWithTinyObj(const fs::path& modelDir,
+                            std::vector<std::vector<Vertex>>& vertices) {
+  tinyobj::attrib_t attrib;
+  std::vector<tinyobj::shape_t> shapes;
+  std::vector<tinyobj::material_t> materials;
+  std::string err;
+  const auto objPath = (modelDir / "model.obj").string();
+  const auto mtlDir = modelDir.string() + "/";
+  if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, objPath.c_str(),
+                        mtlDir.c_str())) {
+    return false;
+  }
+
+  // Faces without material go to an extra material
+  vertices.assign(materials.size() + 1, {});
+  for (const auto& shape : shapes) {
+    size_t indexOffset = 0;
+    for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++) {
+      const int materialId = shape.mesh.material_ids[f];
+      auto& materialVertices =
+          materialId >= 0 ? vertices[materialId] : vertices.back();
+
+      const size_t faceVertexCount = shape.mesh.num_face_vertices[f];
+      for (size_t v = 0; v < faceVertexCount; v++) {
+        const auto idx = shape.mesh.indices[indexOffset + v];
+        glm::vec3 position(attrib.vertices[3 * size_t(idx.vertex_index) + 0],
+                           attrib.vertices[3 * size_t(idx.vertex_index) + 1],
+                           attrib.vertices[3 * size_t(idx.vertex_index) + 2]);
+        glm::vec3 normal(0);
+        if (idx.normal_index >= 0) {
+          normal = glm::vec3(attrib.normals[3 * size_t(idx.normal_index) + 0],
+                             attrib.normals[3 * size_t(idx.normal_index) + 1],
+                             attrib.normals[3 * size_t(idx.normal_index) + 2]);
+        }
+        glm::vec2 uv(-1);
+        if (idx.texcoord_index >= 0) {
+          uv = glm::vec2(attrib.texcoords[2 * size_t(idx.texcoord_index) + 0],
+                         attrib.texcoords[2 * size_t(idx.texcoord_index) + 1]);
+        }
+        materialVertices.emplace_back(position, normal, uv);
+      }
+      indexOffset += faceVertexCount;
+    }
+  }
+
+  if (vertices.back().empty()) {
+    vertices.pop_back();
+  }
+  return true;
+}
+
+/**
+ * Gets the largest difference between the attributes of two sets of
+ * vertices, or -1 if they don't have the same number of vertices.
+ */
+static float compare(const std::vector<std::vector<Vertex>>& a,
+                     const std::vector<std::vector<Vertex>>& b) {
+  if (a.size() != b.size()) {
+    return -1.0f;
+  }
+
+  float maxDifference = 0.0f;
+  for (size_t m = 0; m < a.size(); m++) {
+    if (a[m].size() != b[m].size()) {
+      return -1.0f;
+    }
+    for (size_t v = 0; v < a[m].size(); v++) {
+      const auto position = glm::abs(a[m][v].position - b[m][v].position);
+      const auto normal = glm::abs(a[m][v].normal - b[m][v].normal);
+      const auto uv = glm::abs(a[m][v].uv - b[m][v].uv);
+      maxDifference = std::max({maxDifference, position.x, position.y,
+                                position.z, normal.x, normal.y, normal.z,
+                                uv.x, uv.y});
+    }
+  }
+  return maxDifference;
+}
+
+/**
+ * Runs a parser several times, returning its fastest time (in seconds).
+ */
+template <typename F>
+static double measure(F parse) {
+  double bestTime = 0.0;
+  for (int run = 0; run < RUN_COUNT; run++) {
+    const auto start = std::chrono::steady_clock::now();
+    parse();
+    const auto end = std::chrono::steady_clock::now();
+    const auto time = std::chrono::duration<double>(end - start).count();
+    bestTime = run == 0 ? time : std::min(bestTime, time);
+  }
+  return bestTime;
+}
+
+int main(int argc, char* argv[]) {
+  const fs::path modelsDir = argc > 1 ? argv[1] : "models";
+  if (!fs::is_directory(modelsDir)) {
+    std::cerr << "Usage: " << argv[0] << " [models dir]\n";
+    return 1;
+  }
+
+  // Throughput of both parsers over the OBJ file, and largest difference
+  // between their outputs
+  std::cout << std::left << std::setw(14) << "model" << std::right
+            << std::setw(11) << "size (MB)" << std::setw(11) << "triangles"
+            << std::setw(15) << "tinyobj MB/s" << std::setw(15)
+            << "parser MB/s" << std::setw(9) << "speedup" << std::setw(13)
+            << "difference" << "\n";
+
+  for (const auto& entry : fs::directory_iterator(modelsDir)) {
+    const auto objPath = entry.path() / "model.obj";
+    if (!entry.is_directory() || !fs::is_regular_file(objPath)) {
+      continue;
+    }
+
+    std::vector<std::vector<Vertex>> reference;
+    ObjParser parser;
+    if (!loadWithTinyObj(entry.path(), reference) ||
+        !parser.parse(objPath.string())) {
+      continue;
+    }
+
+    const auto tinyObjTime = measure([&entry]() {
+      std::vector<std::vector<Vertex>> vertices;
+      loadWithTinyObj(entry.path(), vertices);
+    });
+    const auto parserTime = measure([&objPath]() {
+      ObjParser timedParser;
+      timedParser.parse(objPath.string());
+    });
+
+    const double megabytes = fs::file_size(objPath) / (1024.0 * 1024.0);
+    const auto difference = compare(reference, parser.materialVertices);
+    std::cout << std::left << std::setw(14)
+              << entry.path().filename().string() << std::right
+              << std::fixed << std::setprecision(2) << std::setw(11)
+              << megabytes << std::setw(11) << parser.getTriangleCount()
+              << std::setw(15) << megabytes / tinyObjTime << std::setw(15)
+              << megabytes / parserTime << std::setw(9)
+              << tinyObjTime / parserTime << std::setw(13);
+    if (difference < 0) {
+      std::cout << "mismatch\n";
+    } else {
+      std::cout << std::scientific << std::setprecision(1) << difference
+                << "\n";
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,303 @@
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../../src/occlusion_culler.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Frames measured per configuration (the average time is reported)
+static const int FRAME_COUNT = 100;
+// Numbers of buildings (occluders) measured, on a square grid
+static const size_t OCCLUDER_COUNTS[] = {16, 64, 256, 1024};
+// Objects tested against the occluders
+static const size_t OBJECT_COUNT = 10000;
+
+/**
+ * Gets the triangles of a unit box (from -1 to 1), like a building proxy.
+ */
+static std::vector<glm::vec3> createBoxTriangles() {
+  const glm::vec3 corners[8] = {{-1, -1, -1}, {1, -1, -1}, {-1, 1, -1},
+                                {1, 1, -1},   {-1, -1, 1}, {1, -1, 1},
+                                {-1, 1, 1},   {1, 1, 1}};
+  const int faces[6][4] = {{0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1},
+                           {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}};
+  std::vector<glm::vec3> triangles;
+  for (const auto& face : faces) {
+    for (const int index : {0, 1, 2, 0, 2, 3}) {
+      triangles.push_back(corners[face[index]]);
+    }
+  }
+  return triangles;
+}
+
+/**
+ * Gets the view projection matrix of the checks: looking down -Z from the
+ * origin, on the whole default depth buffer.
+ */
+static glm::mat4 getCheckMatrix() {
+  return glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 1000.0f) *
+         glm::lookAt(glm::vec3(0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+}
+
+// Time budget of the checks, in milliseconds, so that they don't depend on the
+// speed of the build
+static const double CHECK_TIME_BUDGET = 1000.0;
+
+/**
+ * Creates a culler for the checks, looking down -Z from the origin.
+ */
+static OcclusionCuller beginCheck() {
+  OcclusionCuller culler;
+  culler.setTimeBudget(CHECK_TIME_BUDGET, CHECK_TIME_BUDGET);
+  culler.begin(getCheckMatrix());
+  return culler;
+}
+
+/**
+ * Tests a box and prints it if the result isn't the expected one.
+ */
+static bool checkBox(OcclusionCuller& culler,
+                     const char* name,
+                     const glm::vec3& center,
+                     const glm::vec3& halfSize,
+                     bool isVisible) {
+  if (culler.testBox(center - halfSize, center + halfSize) == isVisible) {
+    return true;
+  }
+  std::cout << name << " check: box at (" << center.x << ", " << center.y
+            << ", " << center.z << ") should be "
+            << (isVisible ? "visible" : "hidden")
+            << (culler.getStatistics().isOverBudget ? " (over budget)" : "")
+            << "\n";
+  return false;
+}
+
+/**
+ * Checks the culler on a wall filling the view: boxes behind it must be
+ * occluded, boxes in front of it or around its edges must not.
+ */
+static bool checkWall(const std::vector<glm::vec3>& boxTriangles) {
+  auto culler = beginCheck();
+
+  // Wall 10 units away, 20 units wide and 10 high
+  const auto wallMatrix =
+      glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, 0, -11)),
+                 glm::vec3(10, 5, 1));
+  culler.addOccluder(boxTriangles, wallMatrix, 10.0f);
+  culler.rasterize();
+
+  const glm::vec3 size(0.5f);
+  bool isOk = checkBox(culler, "Wall", glm::vec3(-1, -1, -30), size, false);
+  isOk &= checkBox(culler, "Wall", glm::vec3(0, 0, -5), size, true);
+  isOk &= checkBox(culler, "Wall", glm::vec3(0, 8, -12), size, true);
+  isOk &= checkBox(culler, "Wall", glm::vec3(0, 0, -30),
+                   glm::vec3(30, 0.5f, 0.5f), true);
+  return isOk;
+}
+
+/**
+ * Checks the culler on a floor going from behind the viewer to far in front of
+ * it, so that its triangles are clipped by the near plane: boxes below it must
+ * be occluded, boxes above it or beyond its far edge must not.
+ */
+static bool checkNearPlane(const std::vector<glm::vec3>& boxTriangles) {
+  auto culler = beginCheck();
+
+  // Floor from 10 units behind to 30 units in front, 1 to 2 units below
+  const auto floorMatrix =
+      glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, -1.5f, -10)),
+                 glm::vec3(20, 0.5f, 20));
+  culler.addOccluder(boxTriangles, floorMatrix, 0.0f);
+  culler.rasterize();
+
+  const glm::vec3 size(0.5f);
+  bool isOk =
+      checkBox(culler, "Near plane", glm::vec3(0, -4, -20), size, false);
+  isOk &= checkBox(culler, "Near plane", glm::vec3(8, -6, -25), size, false);
+  isOk &= checkBox(culler, "Near plane", glm::vec3(0, 1, -10), size, true);
+  isOk &=
+      checkBox(culler, "Near plane", glm::vec3(0, -0.4f, -2), glm::vec3(0.3f),
+               true);
+  isOk &= checkBox(culler, "Near plane", glm::vec3(0, -1.5f, -60),
+                   glm::vec3(0.5f), true);
+  return isOk;
+}
+
+/**
+ * Checks the culler on boxes ending in a texel only partly covered by the edge
+ * of a wall, for several positions of the edge and of the boxes within the
+ * texel: a box must be occluded if and only if the centers of all the texels
+ * it covers are (those of partly covered texels included).
+ */
+static bool checkPartialTexels(const std::vector<glm::vec3>& boxTriangles) {
+  const auto viewProjectionMatrix = getCheckMatrix();
+  const float width = static_cast<float>(OcclusionCuller::DEFAULT_WIDTH);
+
+  // World X at a depth whose projection is at a texel column
+  const auto getWorldX = [&](float column, float depth) {
+    return ((column / width) * 2.0f - 1.0f) * depth /
+           viewProjectionMatrix[0][0];
+  };
+  // Texel column of a point
+  const auto getColumn = [&](const glm::vec3& point) {
+    const auto vertex = viewProjectionMatrix * glm::vec4(point, 1.0f);
+    return (vertex.x / vertex.w * 0.5f + 0.5f) * width;
+  };
+
+  bool isOk = true;
+  const float edgeColumn = 160.0f;
+  const float fractions[] = {0.1f, 0.3f, 0.45f, 0.55f, 0.7f, 0.9f};
+  for (const float edgeFraction : fractions) {
+    // Wall 10 units away, from the left of the view to the edge
+    auto culler = beginCheck();
+    const float edgeX = getWorldX(edgeColumn + edgeFraction, 10.0f);
+    const auto wallMatrix = glm::scale(
+        glm::translate(glm::mat4(1), glm::vec3((edgeX - 20.0f) * 0.5f, 0,
+                                               -11)),
+        glm::vec3((edgeX + 20.0f) * 0.5f, 5, 1));
+    culler.addOccluder(boxTriangles, wallMatrix, 10.0f);
+    culler.rasterize();
+
+    // Thin boxes 30 units away, about 2 texels wide
+    for (const float boxFraction : fractions) {
+      const float minX = getWorldX(edgeColumn - 2.0f + boxFraction, 30.0f);
+      const float maxX = getWorldX(edgeColumn + boxFraction, 30.0f);
+      const glm::vec3 center((minX + maxX) * 0.5f, 0.0f, -30.0f);
+      const glm::vec3 halfSize((maxX - minX) * 0.5f, 0.2f, 0.01f);
+
+      // Rightmost texel of the box (from its nearest corner)
+      const float lastColumn = std::floor(getColumn(center + halfSize *
+                                                    glm::vec3(1, 1, -1)));
+      const bool isVisible = lastColumn + 0.5f > edgeColumn + edgeFraction;
+      isOk &= checkBox(culler, "Partial texels", center, halfSize, isVisible);
+    }
+  }
+  return isOk;
+}
+
+/**
+ * Checks the culler without any time budget: the first occluder must be
+ * rasterized but not the next ones, and boxes must be reported visible
+ * untested.
+ */
+static bool checkBudget(const std::vector<glm::vec3>& boxTriangles) {
+  OcclusionCuller culler;
+  culler.setTimeBudget(0.0, 0.0);
+  culler.begin(getCheckMatrix());
+  for (const float z : {-11.0f, -14.0f}) {
+    culler.addOccluder(
+        boxTriangles,
+        glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, 0, z)),
+                   glm::vec3(10, 5, 1)),
+        -z);
+  }
+  culler.rasterize();
+
+  bool isOk = checkBox(culler, "Budget", glm::vec3(0, 0, -30),
+                       glm::vec3(0.5f), true);
+  const auto& statistics = culler.getStatistics();
+  if (statistics.occluderCount != 1 || statistics.skippedCount != 1 ||
+      !statistics.isOverBudget) {
+    std::cout << "Budget check: " << statistics.occluderCount
+              << " occluders rasterized and " << statistics.skippedCount
+              << " boxes skipped instead of 1 and 1\n";
+    isOk = false;
+  }
+  return isOk;
+}
+
+int main(int argc, char* argv[]) {
+  // Only the checks with --check, as a test
+  const bool isCheckOnly = argc > 1 && std::string(argv[1]) == "--check";
+
+  const auto boxTriangles = createBoxTriangles();
+  const bool isOk =
+      checkWall(boxTriangles) & checkNearPlane(boxTriangles) &
+      checkPartialTexels(boxTriangles) & checkBudget(boxTriangles);
+  std::cout << "Checks: " << (isOk ? "ok" : "failed") << "\n";
+  if (isCheckOnly) {
+    return isOk ? 0 : 1;
+  }
+
+  // Depth buffer size, then average times in milliseconds of rasterizing the
+  // occluders and testing the objects, the part of the objects occluded and
+  // the part left untested over budget
+  std::cout << std::right << std::setw(11) << "occluders" << std::setw(11)
+            << "triangles" << std::setw(11) << "rasterize" << std::setw(9)
+            << "test" << std::setw(11) << "occluded" << std::setw(10)
+            << "skipped" << std::setw(13) << "over budget" << "\n";
+  std::cout << std::fixed << std::setprecision(3);
+
+  std::mt19937 rng(42);
+  for (const auto occluderCount : OCCLUDER_COUNTS) {
+    // City of buildings around the viewer, with objects between them
+    const int gridSize = static_cast<int>(std::sqrt(occluderCount));
+    const float spacing = 40.0f;
+    std::vector<glm::mat4> occluderMatrices;
+    for (int x = 0; x < gridSize; x++) {
+      for (int z = 0; z < gridSize; z++) {
+        const glm::vec3 position((x - gridSize / 2 + 0.5f) * spacing, 15.0f,
+                                 (z - gridSize / 2 + 0.5f) * spacing);
+        occluderMatrices.push_back(glm::scale(
+            glm::translate(glm::mat4(1), position), glm::vec3(12, 15, 12)));
+      }
+    }
+    const float citySize = gridSize * spacing * 0.5f;
+    std::uniform_real_distribution<float> position(-citySize, citySize);
+    std::vector<std::pair<glm::vec3, glm::vec3>> objects;
+    for (size_t i = 0; i < OBJECT_COUNT; i++) {
+      const glm::vec3 center(position(rng), 1.0f, position(rng));
+      objects.emplace_back(center - glm::vec3(1), center + glm::vec3(1));
+    }
+
+    // Viewer in a street, turning around
+    OcclusionCuller culler;
+    double rasterizationTime = 0.0, testTime = 0.0;
+    size_t occludedCount = 0, skippedCount = 0, overBudgetCount = 0;
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+      const float angle = frame * 6.2832f / FRAME_COUNT;
+      const glm::vec3 eye(spacing * 0.5f, 2.0f, 0.0f);
+      const auto viewProjectionMatrix =
+          glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 1000.0f) *
+          glm::lookAt(eye, eye + glm::vec3(std::cos(angle), 0,
+                                           std::sin(angle)),
+                      glm::vec3(0, 1, 0));
+
+      culler.begin(viewProjectionMatrix);
+      for (const auto& matrix : occluderMatrices) {
+        culler.addOccluder(boxTriangles, matrix,
+                           glm::distance(eye, glm::vec3(matrix[3])));
+      }
+      culler.rasterize();
+      const auto start = Clock::now();
+      for (const auto& object : objects) {
+        culler.testBox(object.first, object.second);
+      }
+      testTime +=
+          std::chrono::duration<double, std::milli>(Clock::now() - start)
+              .count();
+      rasterizationTime += culler.getStatistics().rasterizationTime;
+      occludedCount += culler.getStatistics().occludedCount;
+      skippedCount += culler.getStatistics().skippedCount;
+      overBudgetCount += culler.getStatistics().isOverBudget;
+    }
+
+    std::cout << std::setw(11) << occluderCount << std::setw(11)
+              << occluderCount * boxTriangles.size() / 3 << std::setw(11)
+              << rasterizationTime / FRAME_COUNT << std::setw(9)
+              << testTime / FRAME_COUNT << std::setw(10)
+              << 100.0 * occludedCount / (OBJECT_COUNT * FRAME_COUNT) << "%"
+              << std::setw(9)
+              << 100.0 * skippedCount / (OBJECT_COUNT * FRAME_COUNT) << "%"
+              << std::setw(13) << overBudgetCount << "\n";
+  }
+
+  return isOk ? 0 : 1;
+}
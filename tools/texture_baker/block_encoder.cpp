@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "block_encoder.hpp"
+
+namespace block_encoder {
+
+// Pixels of a 4x4 block, 4 bytes (RGBA) each
+using Block = uint8_t[16][4];
+
+static int getBlockCount(int size) {
+  return (size + 3) / 4;
+}
+
+/**
+ * Reads a 4x4 block, repeating the last row and column for images whose size
+ * isn't a multiple of 4.
+ */
+static void fetchBlock(const RgbaImage& image,
+                       int blockX,
+                       int blockY,
+                       Block& block) {
+  for (int y = 0; y < 4; y++) {
+    const int pixelY = std::min(blockY * 4 + y, image.height - 1);
+    for (int x = 0; x < 4; x++) {
+      const int pixelX = std::min(blockX * 4 + x, image.width - 1);
+      memcpy(block[y * 4 + x],
+             &image.pixels[(size_t(pixelY) * image.width + pixelX) * 4], 4);
+    }
+  }
+}
+
+static uint16_t packRgb565(const float color[3]) {
+  const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+  const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+  const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+  return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpackRgb565(uint16_t packed, int color[3]) {
+  const int r = (packed >> 11) & 0x1F;
+  const int g = (packed >> 5) & 0x3F;
+  const int b = packed & 0x1F;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+static void writeLittleEndian(uint64_t value, size_t byteCount, uint8_t* out) {
+  for (size_t i = 0; i < byteCount; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+/**
+ * Encodes the colors of a block: endpoints are the extremes of the colors
+ * along their principal axis, slightly inset to reduce the error.
+ */
+static void encodeColorBlock(const Block& block, uint8_t* output) {
+  // Mean color
+  float mean[3] = {0, 0, 0};
+  for (const auto& pixel : block) {
+    for (int c = 0; c < 3; c++) {
+      mean[c] += pixel[c] / 16.0f;
+    }
+  }
+
+  // Covariance matrix
+  float covariance[3][3] = {};
+  for (const auto& pixel : block) {
+    const float d[3] = {pixel[0] - mean[0], pixel[1] - mean[1],
+                        pixel[2] - mean[2]};
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        covariance[i][j] += d[i] * d[j];
+      }
+    }
+  }
+
+  // Principal axis, with a few power iterations
+  float axis[3] = {1, 1, 1};
+  for (int iteration = 0; iteration < 8; iteration++) {
+    float next[3];
+    for (int i = 0; i < 3; i++) {
+      next[i] = covariance[i][0] * axis[0] + covariance[i][1] * axis[1] +
+                covariance[i][2] * axis[2];
+    }
+    const float length =
+        std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+    if (length < 1e-6f) {
+      break;  // Uniform block, any axis will do
+    }
+    for (int i = 0; i < 3; i++) {
+      axis[i] = next[i] / length;
+    }
+  }
+
+  // Extremes along the axis
+  float minProjection = 0, maxProjection = 0;
+  for (const auto& pixel : block) {
+    const float projection = (pixel[0] - mean[0]) * axis[0] +
+                             (pixel[1] - mean[1]) * axis[1] +
+                             (pixel[2] - mean[2]) * axis[2];
+    minProjection = std::min(minProjection, projection);
+    maxProjection = std::max(maxProjection, projection);
+  }
+  const float inset = (maxProjection - minProjection) / 16.0f;
+  minProjection += inset;
+  maxProjection -= inset;
+
+  float maxColor[3], minColor[3];
+  for (int c = 0; c < 3; c++) {
+    maxColor[c] =
+        std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+    minColor[c] =
+        std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+  }
+
+  // Quantize endpoints (color0 > color1 selects the 4 colors mode)
+  auto color0 = packRgb565(maxColor);
+  auto color1 = packRgb565(minColor);
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+
+  uint32_t indices = 0;
+  if (color0 != color1) {
+    // Palette: both endpoints and 2 interpolated colors
+    int palette[4][3];
+    unpackRgb565(color0, palette[0]);
+    unpackRgb565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for (int i = 0; i < 16; i++) {
+      int bestIndex = 0;
+      int bestDistance = INT32_MAX;
+      for (int p = 0; p < 4; p++) {
+        int distance = 0;
+        for (int c = 0; c < 3; c++) {
+          const int d = block[i][c] - palette[p][c];
+          distance += d * d;
+        }
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          bestIndex = p;
+        }
+      }
+      indices |= uint32_t(bestIndex) << (2 * i);
+    }
+  }
+
+  writeLittleEndian(color0, 2, output);
+  writeLittleEndian(color1, 2, output + 2);
+  writeLittleEndian(indices, 4, output + 4);
+}
+
+/**
+ * Encodes the alpha of a block: endpoints are the extreme alpha values,
+ * interpolated into 8 levels.
+ */
+static void encodeAlphaBlock(const Block& block, uint8_t* output) {
+  uint8_t alpha0 = 0, alpha1 = 255;
+  for (const auto& pixel : block) {
+    alpha0 = std::max(alpha0, pixel[3]);
+    alpha1 = std::min(alpha1, pixel[3]);
+  }
+
+  uint64_t indices = 0;
+  if (alpha0 != alpha1) {
+    // Palette: both endpoints and 6 interpolated values (alpha0 > alpha1)
+    int palette[8] = {alpha0, alpha1};
+    for (int p = 1; p < 7; p++) {
+      palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+    }
+
+    for (int i = 0; i < 16; i++) {
+      int bestIndex = 0;
+      int bestDistance = INT32_MAX;
+      for (int p = 0; p < 8; p++) {
+        const int distance = std::abs(block[i][3] - palette[p]);
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          bestIndex = p;
+        }
+      }
+      indices |= uint64_t(bestIndex) << (3 * i);
+    }
+  }
+
+  output[0] = alpha0;
+  output[1] = alpha1;
+  writeLittleEndian(indices, 6, output + 2);
+}
+
+size_t getEncodedSize(int width, int height, size_t blockSize) {
+  return size_t(getBlockCount(width)) * size_t(getBlockCount(height)) *
+         blockSize;
+}
+
+void encodeBC1(const RgbaImage& image,
+               int firstRow,
+               int rowCount,
+               uint8_t* output) {
+  const int blockCountX = getBlockCount(image.width);
+  Block block;
+  for (int blockY = firstRow; blockY < firstRow + rowCount; blockY++) {
+    for (int blockX = 0; blockX < blockCountX; blockX++) {
+      fetchBlock(image, blockX, blockY, block);
+      encodeColorBlock(block,
+                       output + (size_t(blockY) * blockCountX + blockX) * 8);
+    }
+  }
+}
+
+void encodeBC3(const RgbaImage& image,
+               int firstRow,
+               int rowCount,
+               uint8_t* output) {
+  const int blockCountX = getBlockCount(image.width);
+  Block block;
+  for (int blockY = firstRow; blockY < firstRow + rowCount; blockY++) {
+    for (int blockX = 0; blockX < blockCountX; blockX++) {
+      fetchBlock(image, blockX, blockY, block);
+      const auto blockOutput =
+          output + (size_t(blockY) * blockCountX + blockX) * 16;
+      encodeAlphaBlock(block, blockOutput);
+      encodeColorBlock(block, blockOutput + 8);
+    }
+  }
+}
+
+RgbaImage downsample(const RgbaImage& image) {
+  RgbaImage result;
+  result.width = std::max(1, image.width / 2);
+  result.height = std::max(1, image.height / 2);
+  result.pixels.resize(size_t(result.width) * result.height * 4);
+
+  for (int y = 0; y < result.height; y++) {
+    const int y0 = std::min(y * 2, image.height - 1);
+    const int y1 = std::min(y * 2 + 1, image.height - 1);
+    for (int x = 0; x < result.width; x++) {
+      const int x0 = std::min(x * 2, image.width - 1);
+      const int x1 = std::min(x * 2 + 1, image.width - 1);
+      for (int c = 0; c < 4; c++) {
+        const auto pixel = [&](int px, int py) {
+          return int(image.pixels[(size_t(py) * image.width + px) * 4 + c]);
+        };
+        const int sum =
+            pixel(x0, y0) + pixel(x1, y0) + pixel(x0, y1) + pixel(x1, y1);
+        result.pixels[(size_t(y) * result.width + x) * 4 + c] =
+            static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+
+  return result;
+}
+
+}  // namespace block_encoder
@@ -0,0 +1,61 @@
+#ifndef BLOCK_ENCODER_HPP
+#define BLOCK_ENCODER_HPP
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Encoder of RGBA8 images into S3TC blocks: BC1 (DXT1, opaque, 8 bytes per
+ * 4x4 block) and BC3 (DXT5, with alpha, 16 bytes per 4x4 block).
+ */
+namespace block_encoder {
+
+/**
+ * Image in CPU memory, 4 bytes (RGBA) per pixel.
+ */
+struct RgbaImage {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> pixels;
+};
+
+/**
+ * Gets size of an image encoded in blocks, in bytes.
+ * @param width      Width of the image in pixels
+ * @param height     Height of the image in pixels
+ * @param blockSize  Size of one encoded 4x4 block (8 for BC1, 16 for BC3)
+ */
+size_t getEncodedSize(int width, int height, size_t blockSize);
+
+/**
+ * Encodes rows of blocks of an image into BC1.
+ * @param image     The image to encode
+ * @param firstRow  First row of blocks to encode
+ * @param rowCount  Number of rows of blocks to encode
+ * @param output    Encoded image (getEncodedSize(..., 8) bytes)
+ */
+void encodeBC1(const RgbaImage& image,
+               int firstRow,
+               int rowCount,
+               uint8_t* output);
+
+/**
+ * Encodes rows of blocks of an image into BC3.
+ * @param image     The image to encode
+ * @param firstRow  First row of blocks to encode
+ * @param rowCount  Number of rows of blocks to encode
+ * @param output    Encoded image (getEncodedSize(..., 16) bytes)
+ */
+void encodeBC3(const RgbaImage& image,
+               int firstRow,
+               int rowCount,
+               uint8_t* output);
+
+/**
+ * Downsamples an image to half its size (2x2 box filter), to build mip chains.
+ */
+RgbaImage downsample(const RgbaImage& image);
+
+}  // namespace block_encoder
+
+#endif
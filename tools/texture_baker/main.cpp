@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "../../src/gl_wrappers/ktx_file.hpp"
+#include "../../src/utils/thread_pool.hpp"
+
+#include "block_encoder.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * Outcome of baking an image.
+ */
+enum class BakeResult { Baked, Skipped, Failed };
+
+/**
+ * Image to bake, with the path of its baked version.
+ */
+struct BakeJob {
+  fs::path sourcePath;
+  fs::path compressedPath;
+};
+
+static bool isImageFile(const fs::path& path) {
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+         extension == ".bmp" || extension == ".tga";
+}
+
+/**
+ * Lists the model textures whose baked version is missing or outdated.
+ */
+static std::vector<BakeJob> findBakeJobs(const fs::path& modelsDir,
+                                         const fs::path& outputDir) {
+  std::vector<BakeJob> jobs;
+  for (const auto& modelEntry : fs::directory_iterator(modelsDir)) {
+    const auto texturesDir = modelEntry.path() / "textures";
+    if (!fs::is_directory(texturesDir)) {
+      continue;
+    }
+
+    for (const auto& textureEntry : fs::directory_iterator(texturesDir)) {
+      if (!textureEntry.is_regular_file() ||
+          !isImageFile(textureEntry.path())) {
+        continue;
+      }
+
+      const auto relativePath = fs::relative(textureEntry.path(), modelsDir);
+      const fs::path compressedPath = KtxFile::getCompressedFilePath(
+          (outputDir / relativePath).generic_string());
+
+      std::error_code errorCode;
+      const auto compressedTime =
+          fs::last_write_time(compressedPath, errorCode);
+      if (!errorCode &&
+          compressedTime >= fs::last_write_time(textureEntry.path())) {
+        continue;  // Up to date
+      }
+
+      jobs.push_back({textureEntry.path(), compressedPath});
+    }
+  }
+
+  return jobs;
+}
+
+/**
+ * Decodes an image, builds its mip chain and encodes it into BC1 (opaque) or
+ * BC3 (with alpha), then writes it as a KTX file. Images that can't be decoded
+ * are skipped (the application falls back to decoding the source, which fails
+ * the same way).
+ */
+static BakeResult bake(const BakeJob& job) {
+  // Decode as RGBA, flipped like at runtime (bottom row first)
+  stbi_set_flip_vertically_on_load_thread(1);
+  int width, height, channelCount;
+  const auto data = stbi_load(job.sourcePath.string().c_str(), &width, &height,
+                              &channelCount, 4);
+  if (data == nullptr) {
+    std::cerr << "Unable to load texture image, skipping: " << job.sourcePath
+              << "\n";
+    return BakeResult::Skipped;
+  }
+
+  block_encoder::RgbaImage image;
+  image.width = width;
+  image.height = height;
+  image.pixels.assign(data, data + size_t(width) * height * 4);
+  stbi_image_free(data);
+
+  // Alpha is only kept when it's actually used
+  bool hasAlpha = false;
+  for (size_t i = 3; i < image.pixels.size(); i += 4) {
+    hasAlpha = hasAlpha || image.pixels[i] != 255;
+  }
+  const size_t blockSize = hasAlpha ? 16 : 8;
+
+  // Encode every level, down to 1x1
+  std::vector<std::vector<uint8_t>> encodedLevels;
+  std::vector<KtxFile::Level> levels;
+  while (true) {
+    const int blockRowCount = (image.height + 3) / 4;
+    encodedLevels.emplace_back(
+        block_encoder::getEncodedSize(image.width, image.height, blockSize));
+    if (hasAlpha) {
+      block_encoder::encodeBC3(image, 0, blockRowCount,
+                               encodedLevels.back().data());
+    } else {
+      block_encoder::encodeBC1(image, 0, blockRowCount,
+                               encodedLevels.back().data());
+    }
+    levels.push_back({image.width, image.height, encodedLevels.back().data(),
+                      encodedLevels.back().size()});
+
+    if (image.width == 1 && image.height == 1) {
+      break;
+    }
+    image = block_encoder::downsample(image);
+  }
+
+  fs::create_directories(job.compressedPath.parent_path());
+  const auto isWritten =
+      KtxFile::write(job.compressedPath.string(),
+                     hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                              : GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                     hasAlpha ? GL_RGBA : GL_RGB, levels);
+  return isWritten ? BakeResult::Baked : BakeResult::Failed;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <models dir> <output dir>\n";
+    return 1;
+  }
+  const fs::path modelsDir = argv[1];
+  const fs::path outputDir = argv[2];
+
+  std::vector<BakeJob> jobs;
+  try {
+    jobs = findBakeJobs(modelsDir, outputDir);
+  } catch (const std::exception& exception) {
+    std::cerr << "Unable to list textures: " << exception.what() << "\n";
+    return 1;
+  }
+
+  // Bake the textures in parallel, one per task
+  std::vector<std::future<BakeResult>> results;
+  for (const auto& job : jobs) {
+    results.push_back(
+        ThreadPool::getInstance().submit([&job]() { return bake(job); }));
+  }
+
+  size_t bakedCount = 0;
+  size_t failureCount = 0;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    auto result = BakeResult::Failed;
+    try {
+      result = results[i].get();
+    } catch (const std::exception& exception) {
+      std::cerr << exception.what() << "\n";
+    }
+
+    if (result == BakeResult::Baked) {
+      std::cout << "Baked texture: " << jobs[i].compressedPath << "\n";
+      bakedCount++;
+    } else if (result == BakeResult::Failed) {
+      std::cerr << "Unable to bake texture: " << jobs[i].sourcePath << "\n";
+      failureCount++;
+    }
+  }
+
+  std::cout << "Baked " << bakedCount << " texture(s) on "
+            << ThreadPool::getInstance().getThreadCount() << " thread(s)\n";
+  return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,655 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * Variable declared in GLSL (uniform or struct field).
+ */
+struct Declaration {
+  std::string type;      // GLSL type, or name of a struct type
+  std::string name;      // Name of the variable
+  size_t arraySize = 0;  // Number of elements (0 if not an array)
+
+  bool operator==(const Declaration& other) const {
+    return type == other.type && name == other.name &&
+           arraySize == other.arraySize;
+  }
+};
+
+/**
+ * Struct type declared in GLSL. Anonymous structs (like "uniform struct {...}
+ * matrices") are named after their variable, capitalized.
+ */
+struct StructType {
+  std::string name;
+  std::vector<Declaration> fields;
+  bool isAnonymous = false;
+};
+
+/**
+ * Uniforms of a shader program, read from all its shader files.
+ */
+struct Program {
+  std::string name;                    // Name of its shader files
+  std::vector<Declaration> uniforms;   // In order of first declaration
+  std::vector<StructType> localTypes;  // Anonymous struct types
+};
+
+// Struct types shared by all the programs, in order of declaration
+static std::vector<StructType> structTypes;
+
+// C++ types of the GLSL types that can be set
+static const std::map<std::string, std::string> CPP_TYPES = {
+    {"float", "GLfloat"},     {"int", "GLint"},         {"uint", "GLuint"},
+    {"bool", "bool"},         {"vec2", "glm::vec2"},    {"vec3", "glm::vec3"},
+    {"vec4", "glm::vec4"},    {"ivec2", "glm::ivec2"},  {"ivec3", "glm::ivec3"},
+    {"ivec4", "glm::ivec4"},  {"mat3", "glm::mat3"},    {"mat4", "glm::mat4"},
+    {"sampler2D", "GLint"},   {"samplerCube", "GLint"}, {"sampler2DArray", "GLint"},
+    {"sampler2DShadow", "GLint"}, {"samplerCubeShadow", "GLint"},
+    {"sampler2DArrayShadow", "GLint"}};
+
+static bool isPrecisionQualifier(const std::string& token) {
+  return token == "lowp" || token == "mediump" || token == "highp";
+}
+
+/**
+ * Splits GLSL source into identifiers, numbers and punctuation, without
+ * comments and preprocessor directives.
+ */
+static std::vector<std::string> tokenize(const std::string& source) {
+  std::vector<std::string> tokens;
+  bool isLineStart = true;
+  for (size_t i = 0; i < source.size();) {
+    const char c = source[i];
+    if (c == '\n') {
+      isLineStart = true;
+      i++;
+    } else if (std::isspace(static_cast<unsigned char>(c))) {
+      i++;
+    } else if (c == '#' && isLineStart) {
+      // Preprocessor directive, up to the end of the (continued) line
+      while (i < source.size() && source[i] != '\n') {
+        i += source[i] == '\\' ? 2 : 1;
+      }
+    } else if (source.compare(i, 2, "//") == 0) {
+      i = source.find('\n', i);
+      if (i == std::string::npos) {
+        break;
+      }
+    } else if (source.compare(i, 2, "/*") == 0) {
+      i = source.find("*/", i + 2);
+      if (i == std::string::npos) {
+        break;
+      }
+      i += 2;
+    } else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+      const auto start = i;
+      while (i < source.size() &&
+             (std::isalnum(static_cast<unsigned char>(source[i])) ||
+              source[i] == '_' || source[i] == '.')) {
+        i++;
+      }
+      tokens.push_back(source.substr(start, i - start));
+      isLineStart = false;
+    } else {
+      tokens.push_back(std::string(1, c));
+      isLineStart = false;
+      i++;
+    }
+  }
+
+  return tokens;
+}
+
+/**
+ * Reads tokens of a GLSL shader file.
+ */
+class Parser {
+ public:
+  Parser(std::vector<std::string> tokens, std::string fileName)
+      : _tokens(std::move(tokens)), _fileName(std::move(fileName)) {}
+
+  /**
+   * Reads the uniforms declared at the top level (not in interface blocks),
+   * and the struct types they use.
+   */
+  std::vector<Declaration> parseUniforms(std::vector<StructType>& localTypes) {
+    std::vector<Declaration> uniforms;
+    int depth = 0;  // Function bodies are skipped
+    while (_position < _tokens.size()) {
+      const auto& token = _next();
+      if (token == "{") {
+        depth++;
+      } else if (token == "}") {
+        depth--;
+      } else if (depth > 0) {
+        continue;
+      } else if (token == "const") {
+        _parseConstant();
+      } else if (token == "struct") {
+        _addStructType(_parseStruct(_next()));
+
+        // Declarators after a global struct definition aren't uniforms
+        while (_position < _tokens.size() && _next() != ";") {
+        }
+      } else if (token == "layout") {
+        _skipGroup("(", ")");
+      } else if (token == "uniform") {
+        _parseUniform(uniforms, localTypes);
+      }
+    }
+
+    return uniforms;
+  }
+
+ private:
+  const std::string& _next() {
+    static const std::string end;
+    return _position < _tokens.size() ? _tokens[_position++] : end;
+  }
+
+  const std::string& _peek() const {
+    static const std::string end;
+    return _position < _tokens.size() ? _tokens[_position] : end;
+  }
+
+  void _expect(const std::string& expected) {
+    const auto token = _next();
+    if (token != expected) {
+      _fail("expected '" + expected + "' but got '" + token + "'");
+    }
+  }
+
+  [[noreturn]] void _fail(const std::string& message) const {
+    throw std::runtime_error(_fileName + ": " + message);
+  }
+
+  /**
+   * Skips tokens up to the closing one (the opening one being read already
+   * or next).
+   */
+  void _skipGroup(const std::string& opening, const std::string& closing) {
+    int depth = 0;
+    if (_peek() == opening) {
+      _next();
+    }
+    depth++;
+    while (depth > 0 && _position < _tokens.size()) {
+      const auto& token = _next();
+      depth += token == opening ? 1 : token == closing ? -1 : 0;
+    }
+  }
+
+  void _parseConstant() {
+    // const int NAME = VALUE; (integer constants size arrays)
+    const auto type = _next();
+    const auto name = _next();
+    if (_peek() == "=" && (type == "int" || type == "uint")) {
+      _next();
+      const auto value = _next();
+      if (!value.empty() && std::isdigit(static_cast<unsigned char>(value[0]))) {
+        _constants[name] = std::stoul(value);
+      }
+    }
+    while (_position < _tokens.size() && _next() != ";") {
+    }
+  }
+
+  size_t _parseArraySize() {
+    if (_peek() != "[") {
+      return 0;
+    }
+    _next();
+    const auto size = _next();
+    _expect("]");
+
+    if (!size.empty() && std::isdigit(static_cast<unsigned char>(size[0]))) {
+      return std::stoul(size);
+    }
+    const auto constant = _constants.find(size);
+    if (constant == _constants.end()) {
+      _fail("unknown array size '" + size + "'");
+    }
+    return constant->second;
+  }
+
+  /**
+   * Reads declarations "type name[N], name2;" up to the closing brace.
+   */
+  std::vector<Declaration> _parseFields() {
+    std::vector<Declaration> fields;
+    _expect("{");
+    while (_peek() != "}") {
+      if (_position >= _tokens.size()) {
+        _fail("unterminated struct");
+      }
+      auto type = _next();
+      while (isPrecisionQualifier(type)) {
+        type = _next();
+      }
+      do {
+        Declaration field;
+        field.type = type;
+        field.name = _next();
+        field.arraySize = _parseArraySize();
+        fields.push_back(field);
+      } while (_peek() == "," && !_next().empty());
+      _expect(";");
+    }
+    _expect("}");
+
+    return fields;
+  }
+
+  StructType _parseStruct(const std::string& name) {
+    StructType structType;
+    structType.name = name;
+    structType.fields = _parseFields();
+    return structType;
+  }
+
+  void _addStructType(const StructType& structType) {
+    const auto existing =
+        std::find_if(structTypes.begin(), structTypes.end(),
+                     [&structType](const StructType& other) {
+                       return other.name == structType.name;
+                     });
+    if (existing == structTypes.end()) {
+      structTypes.push_back(structType);
+    } else if (existing->fields != structType.fields) {
+      _fail("struct '" + structType.name +
+            "' is declared differently in another shader");
+    }
+  }
+
+  void _parseUniform(std::vector<Declaration>& uniforms,
+                     std::vector<StructType>& localTypes) {
+    auto type = _next();
+    while (isPrecisionQualifier(type)) {
+      type = _next();
+    }
+
+    StructType anonymousType;
+    if (type == "struct") {
+      std::string name;
+      if (_peek() != "{") {
+        name = _next();
+      }
+      anonymousType = _parseStruct(name);
+      anonymousType.isAnonymous = name.empty();
+      if (!anonymousType.isAnonymous) {
+        _addStructType(anonymousType);
+      }
+      type = name;
+    } else if (_peek() == "{") {
+      // Interface block (uniform buffer), set through its buffer
+      _skipGroup("{", "}");
+      while (_position < _tokens.size() && _next() != ";") {
+      }
+      return;
+    }
+
+    do {
+      Declaration uniform;
+      uniform.name = _next();
+      uniform.arraySize = _parseArraySize();
+      if (anonymousType.isAnonymous) {
+        // Named after the variable
+        auto typeName = uniform.name;
+        typeName[0] = static_cast<char>(std::toupper(typeName[0]));
+        anonymousType.name = typeName;
+        localTypes.push_back(anonymousType);
+        uniform.type = typeName;
+      } else {
+        uniform.type = type;
+      }
+      uniforms.push_back(uniform);
+    } while (_peek() == "," && !_next().empty());
+    _expect(";");
+  }
+
+  std::vector<std::string> _tokens;
+  std::string _fileName;
+  size_t _position = 0;
+  std::map<std::string, size_t> _constants;  // Integer constants
+};
+
+/**
+ * Writes the C++ code of the handles of uniforms.
+ */
+class Writer {
+ public:
+  /**
+   * @param program    Program whose uniforms are written
+   * @param tableName  C++ type of the program's handle table (or the template
+   * parameter standing for it)
+   */
+  Writer(const Program& program, const std::string& tableName)
+      : _program(program), _tableName(tableName) {}
+
+  /**
+   * Gets the handle initializer of a declaration, adding its uniform names.
+   */
+  std::string getInitializer(const Declaration& declaration,
+                             const std::string& name) {
+    const auto structType = findStructType(declaration.type);
+    if (structType == nullptr) {
+      // Arrays of values are set at once from their first element
+      names.push_back(name);
+      return "{" + std::to_string(names.size() - 1) + "}";
+    }
+
+    if (declaration.arraySize == 0) {
+      return _getStructInitializer(*structType, name);
+    }
+    std::string initializer = "{{";
+    for (size_t i = 0; i < declaration.arraySize; i++) {
+      initializer += (i > 0 ? ", " : "") +
+                     _getStructInitializer(*structType, name + "[" +
+                                                             std::to_string(i) +
+                                                             "]");
+    }
+    return initializer + "}}";
+  }
+
+  /**
+   * Gets the C++ type of the handle of a declaration.
+   */
+  std::string getHandleType(const Declaration& declaration) const {
+    const auto structType = findStructType(declaration.type);
+    if (structType == nullptr) {
+      const auto cppType = CPP_TYPES.find(declaration.type);
+      if (cppType == CPP_TYPES.end()) {
+        throw std::runtime_error("unsupported uniform type '" +
+                                 declaration.type + "'");
+      }
+      return "UniformHandle<" + _tableName + ", " + cppType->second + ">";
+    }
+
+    // Shared struct types are templates on the table using them
+    auto handlesType = structType->name + "Handles";
+    if (!structType->isAnonymous) {
+      handlesType += "<" + _tableName + ">";
+    }
+    if (declaration.arraySize == 0) {
+      return handlesType;
+    }
+    return "std::array<" + handlesType + ", " +
+           std::to_string(declaration.arraySize) + ">";
+  }
+
+  const StructType* findStructType(const std::string& name) const {
+    for (const auto& localType : _program.localTypes) {
+      if (localType.name == name) {
+        return &localType;
+      }
+    }
+    for (const auto& structType : structTypes) {
+      if (structType.name == name) {
+        return &structType;
+      }
+    }
+    return nullptr;
+  }
+
+  std::vector<std::string> names;  // Names of the uniforms, by handle index
+
+ private:
+  std::string _getStructInitializer(const StructType& structType,
+                                    const std::string& name) {
+    std::string initializer = "{";
+    for (size_t i = 0; i < structType.fields.size(); i++) {
+      const auto& field = structType.fields[i];
+      initializer +=
+          (i > 0 ? ", " : "") + getInitializer(field, name + "." + field.name);
+    }
+    return initializer + "}";
+  }
+
+  const Program& _program;
+  std::string _tableName;
+};
+
+/**
+ * Writes the definition of the handles type of a struct type.
+ */
+static void writeHandlesType(std::ostream& stream,
+                             const StructType& structType,
+                             const Writer& writer,
+                             const std::string& indent) {
+  if (!structType.isAnonymous) {
+    stream << indent << "template <typename Table>\n";
+  }
+  stream << indent << "struct " << structType.name << "Handles {\n";
+  for (const auto& field : structType.fields) {
+    stream << indent << "  " << writer.getHandleType(field) << " "
+           << field.name << ";\n";
+  }
+  stream << indent << "};\n";
+}
+
+static std::string getProgramTypeName(const std::string& programName) {
+  std::string typeName;
+  bool isWordStart = true;
+  for (const char c : programName) {
+    if (!std::isalnum(static_cast<unsigned char>(c))) {
+      isWordStart = true;
+      continue;
+    }
+    typeName += isWordStart ? static_cast<char>(std::toupper(c)) : c;
+    isWordStart = false;
+  }
+  return typeName + "Uniforms";
+}
+
+/**
+ * Adds the struct types used by a declaration (fields first) to the set.
+ */
+static void collectStructTypes(const Declaration& declaration,
+                               const Writer& writer,
+                               std::vector<const StructType*>& usedTypes) {
+  const auto structType = writer.findStructType(declaration.type);
+  if (structType == nullptr ||
+      std::find(usedTypes.begin(), usedTypes.end(), structType) !=
+          usedTypes.end()) {
+    return;
+  }
+
+  for (const auto& field : structType->fields) {
+    collectStructTypes(field, writer, usedTypes);
+  }
+  usedTypes.push_back(structType);
+}
+
+static std::string generate(const std::vector<Program>& programs,
+                            const fs::path& shadersDir) {
+  std::ostringstream stream;
+  stream << "// Generated by uniform_generator from the uniforms declared in "
+         << shadersDir.filename().generic_string() << "/, do not edit.\n"
+         << "#ifndef SHADER_UNIFORMS_HPP\n"
+         << "#define SHADER_UNIFORMS_HPP\n\n"
+         << "#include <array>\n"
+         << "#include <cstddef>\n\n"
+         << "#include \"gl_wrappers/uniform_handle.hpp\"\n\n"
+         << "namespace shader_uniforms {\n";
+
+  // Handles types of the shared struct types used by uniforms
+  std::vector<const StructType*> sharedTypes;
+  for (const auto& program : programs) {
+    Writer writer(program, "Table");
+    std::vector<const StructType*> usedTypes;
+    for (const auto& uniform : program.uniforms) {
+      collectStructTypes(uniform, writer, usedTypes);
+    }
+    for (const auto structType : usedTypes) {
+      if (!structType->isAnonymous &&
+          std::find(sharedTypes.begin(), sharedTypes.end(), structType) ==
+              sharedTypes.end()) {
+        sharedTypes.push_back(structType);
+      }
+    }
+  }
+  for (const auto structType : sharedTypes) {
+    stream << "\n/**\n * Handles of the fields of a " << structType->name
+           << " uniform.\n */\n";
+    writeHandlesType(stream, *structType, Writer(programs.front(), "Table"),
+                     "");
+  }
+
+  for (const auto& program : programs) {
+    const auto typeName = getProgramTypeName(program.name);
+    Writer writer(program, typeName);
+
+    std::vector<std::string> handles;
+    for (const auto& uniform : program.uniforms) {
+      handles.push_back("  static constexpr " + writer.getHandleType(uniform) +
+                        " " + uniform.name + writer.getInitializer(uniform,
+                                                                   uniform.name) +
+                        ";\n");
+    }
+
+    stream << "\n/**\n * Uniforms of the \"" << program.name
+           << "\" shader program.\n */\n"
+           << "struct " << typeName << " {\n";
+    for (const auto& localType : program.localTypes) {
+      writeHandlesType(stream, localType, writer, "  ");
+      stream << "\n";
+    }
+    stream << "  // Names of the uniforms, by handle index\n"
+           << "  static constexpr size_t COUNT = " << writer.names.size()
+           << ";\n"
+           << "  static constexpr const char* NAMES[COUNT] = {";
+    for (size_t i = 0; i < writer.names.size(); i++) {
+      stream << (i > 0 ? "," : "") << "\n      \"" << writer.names[i] << "\"";
+    }
+    stream << "};\n\n";
+    for (const auto& handle : handles) {
+      stream << handle;
+    }
+    stream << "};\n";
+  }
+
+  stream << "\n}  // namespace shader_uniforms\n\n#endif\n";
+  return stream.str();
+}
+
+static bool isShaderFile(const fs::path& path) {
+  const auto extension = path.extension();
+  return extension == ".vert" || extension == ".frag" || extension == ".geom";
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <shaders dir> <output header>\n";
+    return 1;
+  }
+  const fs::path shadersDir = argv[1];
+  const fs::path outputPath = argv[2];
+
+  // Programs are made of the shader files sharing a name (e.g. main.vert,
+  // main.frag)
+  std::map<std::string, std::vector<fs::path>> programFiles;
+  std::error_code error;
+  for (const auto& entry : fs::directory_iterator(shadersDir, error)) {
+    if (entry.is_regular_file() && isShaderFile(entry.path())) {
+      programFiles[entry.path().stem().string()].push_back(entry.path());
+    }
+  }
+  if (error || programFiles.empty()) {
+    std::cerr << "No shaders found in " << shadersDir << "\n";
+    return 1;
+  }
+
+  std::vector<Program> programs;
+  try {
+    for (auto& programFile : programFiles) {
+      Program program;
+      program.name = programFile.first;
+      std::sort(programFile.second.begin(), programFile.second.end());
+      for (const auto& filePath : programFile.second) {
+        std::ifstream file(filePath);
+        std::stringstream source;
+        source << file.rdbuf();
+
+        // Stages declare the same uniforms the same way
+        Parser parser(tokenize(source.str()), filePath.filename().string());
+        std::vector<StructType> localTypes;
+        for (const auto& uniform : parser.parseUniforms(localTypes)) {
+          const auto existing =
+              std::find_if(program.uniforms.begin(), program.uniforms.end(),
+                           [&uniform](const Declaration& other) {
+                             return other.name == uniform.name;
+                           });
+          if (existing == program.uniforms.end()) {
+            program.uniforms.push_back(uniform);
+          } else if (!(*existing == uniform)) {
+            throw std::runtime_error(filePath.filename().string() +
+                                     ": uniform '" + uniform.name +
+                                     "' is declared differently in another "
+                                     "stage");
+          }
+        }
+        for (const auto& localType : localTypes) {
+          const auto existing = std::find_if(
+              program.localTypes.begin(), program.localTypes.end(),
+              [&localType](const StructType& other) {
+                return other.name == localType.name;
+              });
+          if (existing == program.localTypes.end()) {
+            program.localTypes.push_back(localType);
+          } else if (existing->fields != localType.fields) {
+            throw std::runtime_error(filePath.filename().string() +
+                                     ": uniform struct '" + localType.name +
+                                     "' is declared differently in another "
+                                     "stage");
+          }
+        }
+      }
+      programs.push_back(program);
+    }
+  } catch (const std::exception& exception) {
+    std::cerr << exception.what() << "\n";
+    return 1;
+  }
+
+  std::string header;
+  try {
+    header = generate(programs, shadersDir);
+  } catch (const std::exception& exception) {
+    std::cerr << exception.what() << "\n";
+    return 1;
+  }
+
+  // Only write when changed, not to rebuild everything including it
+  std::ifstream existingFile(outputPath);
+  if (existingFile.is_open()) {
+    std::stringstream existingHeader;
+    existingHeader << existingFile.rdbuf();
+    if (existingHeader.str() == header) {
+      return 0;
+    }
+    existingFile.close();
+  }
+
+  fs::create_directories(outputPath.parent_path(), error);
+  std::ofstream outputFile(outputPath, std::ios::trunc);
+  outputFile << header;
+  outputFile.close();
+  if (!outputFile.good()) {
+    std::cerr << "Unable to write " << outputPath << "\n";
+    return 1;
+  }
+
+  std::cout << "Generated " << outputPath.filename().string() << "\n";
+  return 0;
+}